@@ -0,0 +1,63 @@
+#include "benchmarks.h"
+
+// number passed as an argument, or a default when there are fewer arguments
+static int Benchmark_int(int argc, char* argv[], int i, int fallback) {
+    return argc > i ? atoi(argv[i]) : fallback;
+}
+
+static float Benchmark_float(int argc, char* argv[], int i, float fallback) {
+    return argc > i ? atof(argv[i]) : fallback;
+}
+
+static const char* Benchmark_path(int argc, char* argv[], int i, const char* fallback) {
+    return argc > i ? argv[i] : fallback;
+}
+
+// every benchmark by name, with its default arguments
+static const BenchmarkMode Benchmark_modes[] = {
+    {"integrator", [](int argc, char* argv[]) { return runIntegratorBenchmark(Benchmark_int(argc, argv, 2, 100000), 100); }},
+    {"boxbox", [](int argc, char* argv[]) { return runBoxBoxBenchmark(Benchmark_int(argc, argv, 2, 1000000)); }},
+    {"stack", [](int argc, char* argv[]) { return runStackBenchmark(Benchmark_int(argc, argv, 2, 10), 500); }},
+    {"render", [](int argc, char* argv[]) { return runRenderBenchmark(Benchmark_int(argc, argv, 2, 16), Benchmark_int(argc, argv, 3, 256)); }},
+    {"packets", [](int argc, char* argv[]) { return runPacketBenchmark(Benchmark_int(argc, argv, 2, 48), Benchmark_int(argc, argv, 3, 512)); }},
+    {"mesh", [](int argc, char* argv[]) { return runMeshBenchmark(Benchmark_path(argc, argv, 2, "Meshes/books_and_mugs.obj"), Benchmark_int(argc, argv, 3, 2000)); }},
+    {"meshcache", [](int argc, char* argv[]) { return runMeshCacheConverter(Benchmark_path(argc, argv, 2, "Meshes/books_and_mugs.obj")); }},
+    {"objparse", [](int argc, char* argv[]) { return runObjParseBenchmark(Benchmark_path(argc, argv, 2, "Meshes/books_and_mugs.obj"), Benchmark_int(argc, argv, 3, 32)); }},
+    {"gif", [](int argc, char* argv[]) { return runGifBenchmark(Benchmark_int(argc, argv, 2, 64), Benchmark_int(argc, argv, 3, 256)); }},
+    {"gifencode", [](int argc, char* argv[]) { return runGifEncodeBenchmark(Benchmark_int(argc, argv, 2, 64), Benchmark_int(argc, argv, 3, 256)); }},
+    {"record", [](int argc, char* argv[]) { return runRecordBenchmark(Benchmark_int(argc, argv, 2, 128), Benchmark_int(argc, argv, 3, 128)); }},
+    {"sinks", [](int argc, char* argv[]) { return runSinkBenchmark(Benchmark_int(argc, argv, 2, 48), Benchmark_int(argc, argv, 3, 512)); }},
+    {"timestep", [](int argc, char* argv[]) { return runTimestepBenchmark(Benchmark_float(argc, argv, 2, 4.0f), Benchmark_int(argc, argv, 3, 64)); }},
+    {"scene", [](int argc, char* argv[]) { return runSceneBenchmark(Benchmark_int(argc, argv, 2, 1000), Benchmark_int(argc, argv, 3, 10), 200); }},
+    {"tree", [](int argc, char* argv[]) { return runTreeBenchmark(Benchmark_int(argc, argv, 2, 10000)); }},
+    {"broadphase", [](int argc, char* argv[]) { return runBroadphaseBenchmark(Benchmark_int(argc, argv, 2, 10000), 100); }},
+    {"islands", [](int argc, char* argv[]) { return runIslandBenchmark(Benchmark_int(argc, argv, 2, 256), 200); }}
+};
+
+// whether an argument is a whole number (the default scene's step count rather than a mistyped benchmark name)
+static bool Benchmark_isCount(const char* arg) {
+    char* end;
+    strtol(arg, &end, 10);
+    return end != arg && *end == '\0';
+}
+
+int runBenchmark(int argc, char* argv[]) {
+    if (argc > 1) {
+        for (const BenchmarkMode& mode : Benchmark_modes) {
+            if (string(argv[1]) == mode.name) {
+                return mode.run(argc, argv);
+            }
+        }
+        if (!Benchmark_isCount(argv[1])) {
+            cerr << "Unknown benchmark " << argv[1] << ", pass a number of steps or one of:";
+            for (const BenchmarkMode& mode : Benchmark_modes) {
+                cerr << " " << mode.name;
+            }
+            cerr << "\n";
+            return 1;
+        }
+    }
+
+    BroadphaseType type = argc > 2 && string(argv[2]) == "tree" ? AABB_TREE : SWEEP_AND_PRUNE;
+    return runHeadless(Benchmark_int(argc, argv, 1, 1000), type);
+}
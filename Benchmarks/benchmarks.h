@@ -0,0 +1,25 @@
+// Headless benchmarks, picked by name from the command line
+#ifndef _BENCHMARKS_H
+#define _BENCHMARKS_H
+
+#include "physicsbenchmarks.h"
+#include "renderbenchmarks.h"
+#include "recordbenchmarks.h"
+
+struct BenchmarkMode {
+    // first argument that picks the benchmark
+    const char* name;
+    // runs the benchmark with the remaining arguments (defaults fill in any not passed) and returns its exit code
+    int (*run)(int argc, char* argv[]);
+};
+
+/**
+ * Runs the benchmark named by the first argument, or otherwise steps the default scene for the number of steps it gives
+ * (passing tree as the second argument uses the AABB tree broadphase)
+ * @return the benchmark's exit code (1 if the first argument is neither a benchmark nor a number)
+ */
+int runBenchmark(int argc, char* argv[]);
+
+#include "benchmarks.cpp"
+
+#endif
@@ -0,0 +1,524 @@
+#include "physicsbenchmarks.h"
+
+int runHeadless(int count, BroadphaseType type) {
+    World physics = World(0.01, type);
+    BBox world = BBox(
+        vec3(100, 1, 100),
+        1.0f,
+        vec3(0, -2, 0),
+        vec4(vec3(1, 0, 0), 0),
+        1.0f,
+        true,
+        vec3(1, 0, 1),
+        1,
+        1.5f
+    );
+    Sphere sphere = Sphere(
+        1.0f, 
+        1.0f, 
+        vec3(1, 5, 1),
+        vec4(vec3(1, 0, 0), 0),
+        1.0f,
+        false,
+        vec3(0, 0, 1),
+        0,
+        1.5f
+    );
+    BBox box = BBox(
+        vec3(3, 0.5, 3), 
+        1.0f, 
+        vec3(2, 0, 0),
+        vec4(vec3(1, 0, 0), 0),
+        0.95f,
+        false,
+        vec3(1, 1, 1),
+        0,
+        1.5f
+    );
+    sphere.linv() = sphere.com() * -1;
+    box.linv() = vec3(0, 10, 0);
+
+    physics.addShape(&world);
+    physics.addShape(&sphere);
+    physics.addShape(&box);
+
+    physics.run(count);
+
+    cout << "\nSteps: " << physics.getSteps() << "\tTime: " << physics.getElapsed() << "\tSteps/s: " << physics.stepsPerSecond() << "\n";
+    return 0;
+}
+
+int runIntegratorBenchmark(int count, int steps) {
+    RigidBodyStore reference;
+    srand(1);
+    for (int i = 0; i < count; i ++) {
+        vec3 com = vec3(rand() % 100, rand() % 100, rand() % 100);
+        vec4 orientation = vec4(vec3(rand() % 10 + 1, rand() % 10, rand() % 10), rand() % 360);
+        int body = reference.create(com, orientation, rand() % 10 + 1, i % 16 == 0);
+        reference.setInertia(body, vec3(rand() % 10 + 1, rand() % 10 + 1, rand() % 10 + 1));
+        reference.linearVelocity[body] = vec3(rand() % 20 - 10, rand() % 20 - 10, rand() % 20 - 10);
+        reference.angularVelocity[body] = vec3(rand() % 20 - 10, rand() % 20 - 10, rand() % 20 - 10) * 0.1;
+    }
+
+    RigidBodyStore scalar;
+    int mismatched = 0;
+    for (int p = SIMD_SCALAR; p <= Simd_detectPath(); p ++) {
+        BatchIntegrator integrator;
+        integrator.setPath((SimdPath)p);
+
+        RigidBodyStore bodies = reference;
+        Stopwatch timer;
+        for (int i = 0; i < steps; i ++) {
+            // constant forces, so every path sees the same (non-zero) accumulators
+            for (int j = 0; j < count; j ++) {
+                bodies.force[j] = vec3(1, 2, 3);
+                bodies.torque[j] = vec3(0.3, 0.2, 0.1);
+            }
+            integrator.integrate(bodies, 0.01);
+        }
+        double elapsed = timer.elapsed();
+
+        bool same = true;
+        if (p == SIMD_SCALAR) {
+            scalar = bodies;
+        } else {
+            same = memcmp(bodies.position.data(), scalar.position.data(), count * sizeof(vec3)) == 0 &&
+                   memcmp(bodies.linearVelocity.data(), scalar.linearVelocity.data(), count * sizeof(vec3)) == 0 &&
+                   memcmp(bodies.angularVelocity.data(), scalar.angularVelocity.data(), count * sizeof(vec3)) == 0 &&
+                   memcmp(bodies.orientation.data(), scalar.orientation.data(), count * sizeof(vec4)) == 0;
+            mismatched += !same;
+        }
+        cout << Simd_pathName((SimdPath)p) << "\tBodies: " << count << "\tTime: " << elapsed << "\tBodies/s: " << count * (double)steps / elapsed << (same ? "" : "\t(differs from scalar)") << "\n";
+    }
+    return mismatched;
+}
+
+int runIslandBenchmark(int piles, int count) {
+    int side = (int)ceil(sqrt((float)piles));
+    vector<vec3> results[2];
+    for (int run = 0; run < 2; run ++) {
+        World physics = World(0.01, AABB_TREE);
+        physics.setThreads(run == 0 ? 1 : max((int)std::thread::hardware_concurrency(), 2));
+
+        BBox ground = BBox(vec3(side * 10.0f, 1, side * 10.0f), 1.0f, vec3(0, -1, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 1, 1), 0, 1.5f);
+        physics.addShape(&ground);
+
+        vector<unique_ptr<Sphere>> spheres;
+        for (int i = 0; i < piles; i ++) {
+            for (int j = 0; j < 4; j ++) {
+                vec3 com = vec3((i % side) * 10.0f - side * 5.0f, 1 + j * 1.9f, (i / side) * 10.0f - side * 5.0f);
+                spheres.push_back(unique_ptr<Sphere>(new Sphere(1.0f, 1.0f, com, vec4(vec3(1, 0, 0), 0), 0.5f, false, vec3(0, 0, 1), 0, 1.5f)));
+                physics.addShape(spheres.back().get());
+            }
+        }
+
+        physics.run(count);
+        for (const unique_ptr<Sphere>& sphere : spheres) {
+            results[run].push_back(sphere->com());
+        }
+        cout << "\nThreads: " << physics.getThreads() << "\tSteps: " << physics.getSteps() << "\tTime: " << physics.getElapsed() << "\tSteps/s: " << physics.stepsPerSecond() << "\n";
+    }
+
+    bool same = memcmp(results[0].data(), results[1].data(), results[0].size() * sizeof(vec3)) == 0;
+    cout << (same ? "Threaded results match serial results\n" : "Threaded results differ from serial results\n");
+    return !same;
+}
+
+int runTreeBenchmark(int count) {
+    vector<unique_ptr<Sphere>> spheres;
+    for (int i = 0; i < count; i ++) {
+        // a row along x, the order that grows an unbalanced tree into a list
+        vec3 com = vec3(i * 1.5f, 0, (i % 7) * 0.5f);
+        spheres.push_back(unique_ptr<Sphere>(new Sphere(1.0f, 1.0f, com, vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1), 0, 1.5f)));
+    }
+
+    AABBTree tree(0.1f);
+    JobSystem jobs(max((int)std::thread::hardware_concurrency(), 2));
+    const char* stages[] = {"Sorted inserts", "Moved", "Half removed"};
+    bool correct = true;
+    srand(1);
+    for (int stage = 0; stage < 3; stage ++) {
+        Stopwatch timer;
+        if (stage == 0) {
+            for (const unique_ptr<Sphere>& sphere : spheres) {
+                tree.insert(sphere.get(), sphere->getAABB());
+            }
+        } else if (stage == 1) {
+            for (int round = 0; round < 10; round ++) {
+                for (const unique_ptr<Sphere>& sphere : spheres) {
+                    sphere->com() += vec3(rand() % 100 / 50.0f, 0, rand() % 100 / 50.0f - 1);
+                    tree.move(sphere.get(), sphere->getAABB());
+                }
+            }
+        } else {
+            for (int i = 0; i < count; i += 2) {
+                tree.remove(spheres[i].get());
+            }
+        }
+        double time = timer.elapsed();
+
+        // every sphere's neighbours, from queries run at once on every thread and from testing every pair (leaf boxes are
+        // fattened and only move once a shape leaves them, so the queries may find near misses too, but never fewer)
+        vector<AABB> boxes(count);
+        for (int i = 0; i < count; i ++) {
+            boxes[i] = spheres[i]->getAABB();
+        }
+        vector<vector<Shape*>> found(count);
+        jobs.parallelFor(count, [&](int i) {
+            tree.overlap(boxes[i], found[i]);
+        });
+        bool same = true;
+        for (int i = 0; i < count && same; i ++) {
+            vector<Shape*> expected;
+            for (int j = 0; j < count; j ++) {
+                if (AABB::overlaps(boxes[j], boxes[i]) && tree.contains(spheres[j].get())) {
+                    expected.push_back(spheres[j].get());
+                }
+            }
+            sort(found[i].begin(), found[i].end());
+            sort(expected.begin(), expected.end());
+            same = includes(found[i].begin(), found[i].end(), expected.begin(), expected.end());
+        }
+
+        // a balanced tree is at most about 1.44 log2(n) high
+        int height = tree.getHeight();
+        bool balanced = height <= 1.45f * log2((float)tree.size() + 2);
+        correct = correct && same && balanced;
+        cout << "\n" << stages[stage] << "\tShapes: " << tree.size() << "\tHeight: " << height << "\tTime: " << time
+             << (balanced ? "\t(balanced)" : "\t(unbalanced)") << (same ? "\t(queries match)" : "\t(queries differ)");
+    }
+    cout << (correct ? "\nTree stayed balanced and threaded queries found every overlap\n" : "\nTree unbalanced or queries missed overlaps\n");
+    return !correct;
+}
+
+int runBroadphaseBenchmark(int count, int steps) {
+    vector<unique_ptr<Sphere>> spheres;
+    vector<vec3> velocities;
+    srand(1);
+    int side = max((int)cbrt(count / 100.0f), 1);
+    for (int i = 0; i < count; i ++) {
+        // tight clusters of 100, the clusters spread twice as far along z as along x and y
+        int cluster = i / 100;
+        vec3 corner = vec3(cluster % side * 12.0f, cluster / side % side * 12.0f, cluster / (side * side) * 24.0f);
+        vec3 com = corner + vec3(rand() % 100 / 10.0f, rand() % 100 / 10.0f, rand() % 100 / 10.0f);
+        spheres.push_back(unique_ptr<Sphere>(new Sphere(0.5f, 1.0f, com, vec4(vec3(1, 0, 0), 0), 1.0f, i % 10 == 0, vec3(1), 0, 1.5f)));
+        // each sphere drifts a little each step, as bodies move coherently between fixed timesteps
+        velocities.push_back(vec3(rand() % 100 - 50, rand() % 100 - 50, rand() % 100 - 50) / 2500.0f);
+    }
+
+    // both broadphases are timed on a small scene and the full one, as sweep and prune should stay near linear
+    int sizes[] = {max(count / 10, 1), count};
+    bool correct = true;
+    for (int size : sizes) {
+        Broadphase sweep(SWEEP_AND_PRUNE);
+        Broadphase tree(AABB_TREE);
+        for (int i = 0; i < size; i ++) {
+            sweep.add(spheres[i].get());
+            tree.add(spheres[i].get());
+        }
+
+        double sweepTime = 0;
+        double treeTime = 0;
+        bool same = true;
+        for (int step = 0; step < steps; step ++) {
+            for (int i = 0; i < size; i ++) {
+                if (!spheres[i]->anchor) {
+                    spheres[i]->com() += velocities[i];
+                }
+            }
+            Stopwatch timer;
+            sweep.update();
+            sweepTime += timer.elapsed();
+            timer.restart();
+            tree.update();
+            treeTime += timer.elapsed();
+
+            const vector<BroadphasePair>& swept = sweep.getPairs();
+            const vector<BroadphasePair>& queried = tree.getPairs();
+            same = same && swept.size() == queried.size();
+            for (size_t k = 0; k < swept.size() && same; k ++) {
+                same = swept[k].key == queried[k].key && swept[k].age == queried[k].age && swept[k].a == queried[k].a;
+            }
+        }
+
+        // every pair of boxes that overlap, unless both shapes are anchored
+        vector<AABB> boxes(size);
+        for (int i = 0; i < size; i ++) {
+            boxes[i] = spheres[i]->getAABB();
+        }
+        size_t expected = 0;
+        for (int i = 0; i < size; i ++) {
+            for (int j = i + 1; j < size; j ++) {
+                expected += !(spheres[i]->anchor && spheres[j]->anchor) && AABB::overlaps(boxes[i], boxes[j]);
+            }
+        }
+        bool complete = sweep.getPairs().size() == expected;
+
+        // removing shapes renumbers the ends of the shapes after them, which must still pair up the same way
+        for (int i = 0; i < size; i += 3) {
+            sweep.remove(spheres[i].get());
+            tree.remove(spheres[i].get());
+        }
+        sweep.update();
+        tree.update();
+        const vector<BroadphasePair>& swept = sweep.getPairs();
+        const vector<BroadphasePair>& queried = tree.getPairs();
+        same = same && swept.size() == queried.size();
+        for (size_t k = 0; k < swept.size() && same; k ++) {
+            same = swept[k].key == queried[k].key && swept[k].age == queried[k].age && swept[k].a == queried[k].a;
+        }
+        correct = correct && same && complete;
+        cout << "\nShapes: " << size << "\tPairs: " << sweep.getPairs().size()
+             << "\tSweep and prune: " << sweepTime / steps * 1000 << " ms/update\tAABB tree: " << treeTime / steps * 1000 << " ms/update"
+             << (same ? "\t(pairs match)" : "\t(pairs differ)") << (complete ? "\t(every overlap found)" : "\t(overlaps missed)");
+    }
+    cout << (correct ? "\nSweep and prune kept the same pairs and ages as the AABB tree\n" : "\nSweep and prune pairs differ from the AABB tree\n");
+    return !correct;
+}
+
+/**
+ * Fills a world with spinning spheres falling onto a ground box
+ * @param physics World to fill (must outlive the shapes)
+ * @param shapes Owner of the shapes made
+ * @param count Number of spheres
+ */
+static void timestepScene(World& physics, vector<unique_ptr<Shape>>& shapes, int count) {
+    int side = (int)ceil(sqrt((float)count));
+    shapes.push_back(unique_ptr<Shape>(new BBox(vec3(side * 4.0f, 1, side * 4.0f), 1.0f, vec3(0, -1, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 1, 1), 0, 1.5f)));
+    physics.addShape(shapes.back().get());
+    for (int i = 0; i < count; i ++) {
+        vec3 com = vec3((i % side) * 4.0f - side * 2.0f, 2.0f + (i % 7), (i / side) * 4.0f - side * 2.0f);
+        shapes.push_back(unique_ptr<Shape>(new Sphere(1.0f, 1.0f, com, vec4(vec3(1, 0, 0), 0), 0.5f, false, vec3(0, 0, 1), 0, 1.5f)));
+        shapes.back()->linv() = vec3((i % 3) - 1.0f, 2.0f, (i % 5) - 2.0f);
+        shapes.back()->angv() = vec3(0, 3.0f + i % 4, 1.0f);
+        physics.addShape(shapes.back().get());
+    }
+}
+
+int runTimestepBenchmark(float seconds, int count) {
+    const char* names[6] = {"30 Hz", "60 Hz", "144 Hz", "Jitter", "Stalls", "60 Hz x4"};
+    bool correct = true;
+    srand(1);
+    for (int schedule = 0; schedule < 6; schedule ++) {
+        World physics = World(0.01, AABB_TREE);
+        vector<unique_ptr<Shape>> shapes;
+        timestepScene(physics, shapes, count);
+        physics.setSubsteps(schedule == 5 ? 4 : 1);
+        RigidBodyStore& bodies = physics.getBodies();
+
+        vector<vec3> raw(bodies.position);
+        vector<vec3> rendered(bodies.position);
+        // shapes parsed at their render poses only when they change, against all of them parsed every frame
+        SceneBuffer incremental;
+        SceneBuffer full;
+        bool buffered = true;
+        double rawError = 0;
+        double renderError = 0;
+        double total = 0;
+        double worst = 0;
+        int frames = 0;
+        int samples = 0;
+        while (total < seconds) {
+            double frameTime = 1.0 / 60;
+            if (schedule == 0) {
+                frameTime = 1.0 / 30;
+            } else if (schedule == 2) {
+                frameTime = 1.0 / 144;
+            } else if (schedule == 3) {
+                frameTime = (0.5 + (rand() % 100) / 100.0) / 60;
+            } else if (schedule == 4 && frames % 60 == 59) {
+                frameTime = 0.25;
+            }
+            total += frameTime;
+            frames ++;
+
+            double before = physics.getElapsed();
+            physics.advance(frameTime);
+            worst = max(worst, physics.getElapsed() - before);
+            incremental.update(physics);
+            full.invalidate();
+            full.update(physics);
+            buffered = buffered && memcmp(incremental.getData(), full.getData(), full.getSize() * WIDTH * sizeof(float)) == 0;
+
+            // speed each way of drawing shows a body moving at, against the speed the body actually has
+            for (int j = 0; j < bodies.size(); j ++) {
+                if (!bodies.dynamic[j]) {
+                    continue;
+                }
+                const vec3& velocity = bodies.linearVelocity[j];
+                rawError += vec3::mag((bodies.position[j] - raw[j]) / frameTime - velocity);
+                renderError += vec3::mag((physics.getRenderPosition(j) - rendered[j]) / frameTime - velocity);
+                raw[j] = bodies.position[j];
+                rendered[j] = physics.getRenderPosition(j);
+                samples ++;
+            }
+        }
+
+        // a fixed timestep makes the simulation independent of the frame rate
+        World reference = World(0.01, AABB_TREE);
+        vector<unique_ptr<Shape>> referenceShapes;
+        timestepScene(reference, referenceShapes, count);
+        reference.setSubsteps(physics.getSubsteps());
+        reference.run(physics.getSteps());
+        bool same = memcmp(bodies.position.data(), reference.getBodies().position.data(), bodies.size() * sizeof(vec3)) == 0;
+        // every step the time covers, not one more or less
+        int expected = (int)floor((total - physics.getDropped()) / physics.getDT());
+        bool counted = physics.getSteps() == expected;
+        correct = correct && same && counted && buffered;
+
+        cout << "\n" << names[schedule] << "\tFrames: " << frames << "\tSteps: " << physics.getSteps() << "\tSimulated seconds per second: " << physics.getSteps() * physics.getDT() / total;
+        cout << "\tDropped: " << physics.getDropped() << "s\tAverage physics per frame: " << physics.getElapsed() / frames * 1000 << "ms\tWorst: " << worst * 1000 << "ms";
+        cout << "\n\tSpeed error (body state): " << rawError / max(samples, 1) << "\tSpeed error (render poses): " << renderError / max(samples, 1);
+        cout << (same ? "\t(matches run)" : "\t(differs from run)") << (counted ? "" : "\t(unexpected step count)");
+        cout << (buffered ? "\t(incremental buffer matches)" : "\t(incremental buffer differs)");
+    }
+    cout << (correct ? "\nEvery frame rate took the steps its frame time covers\n" : "\nStep counts or results depend on the frame rate\n");
+    return !correct;
+}
+
+int runStackBenchmark(int height, int count) {
+    // speeds below this are rounding noise, so they count as resting whichever way they compare
+    const float resting = 1e-5f;
+    bool settles = true;
+    float speeds[2][5];
+    for (int warm = 0; warm < 2; warm ++) {
+        for (int iterations = 1, k = 0; iterations <= 16; iterations *= 2, k ++) {
+            World physics = World(0.01, AABB_TREE);
+            physics.getSolver().setIterations(iterations);
+            physics.getSolver().setWarmStarting(warm);
+
+            BBox ground = BBox(vec3(10, 1, 10), 1.0f, vec3(0, -1, 0), vec4(vec3(1, 0, 0), 0), 0.5f, true, vec3(1, 1, 1), 0, 1.5f);
+            physics.addShape(&ground);
+
+            vector<unique_ptr<Sphere>> spheres;
+            for (int i = 0; i < height; i ++) {
+                spheres.push_back(unique_ptr<Sphere>(new Sphere(1.0f, 1.0f, vec3(0, 1 + i * 2.0f, 0), vec4(vec3(1, 0, 0), 0), 0.5f, false, vec3(0, 0, 1), 0, 1.5f)));
+                physics.addShape(spheres.back().get());
+            }
+
+            // a resting stack has no velocity over its last steps, and its top sphere has not sunk into the ones below
+            float speed = 0;
+            for (int i = 0; i < count; i ++) {
+                physics.step();
+                if (i >= count - 100) {
+                    for (const unique_ptr<Sphere>& sphere : spheres) {
+                        speed = max(speed, vec3::mag(sphere->linv()));
+                    }
+                }
+            }
+            float sunk = 1 + (height - 1) * 2.0f - spheres.back()->com().Y();
+            speeds[warm][k] = speed;
+            bool falls = k == 0 || speed <= speeds[warm][k - 1] || speed < resting;
+            bool warmer = !warm || speed <= max(speeds[0][k], resting);
+            settles = settles && falls && warmer;
+            cout << "\nWarm starting: " << warm << "\tIterations: " << iterations << "\tMax speed: " << speed << "\tTop sunk by: " << sunk << "\tSteps/s: " << physics.stepsPerSecond();
+            cout << (falls ? "" : "\t(faster than with fewer iterations)") << (warmer ? "" : "\t(faster than without warm starting)");
+        }
+    }
+    cout << (settles ? "\nMore iterations and warm starting settle the stack\n" : "\nThe stack does not settle with more iterations or warm starting\n");
+    return !settles;
+}
+
+int runBoxBoxBenchmark(int count) {
+    // a pool of random boxes, paired up differently on every pass through the pool
+    const int pool = 1024;
+    vector<vec3> coms, dims;
+    vector<vec4> rots;
+    srand(1);
+    for (int i = 0; i < pool; i ++) {
+        coms.push_back(vec3(rand() % 400, rand() % 400, rand() % 400) / 100.0f);
+        dims.push_back(vec3(rand() % 150 + 50, rand() % 150 + 50, rand() % 150 + 50) / 100.0f);
+        rots.push_back(vec4::norm(vec4(rand() % 200 - 100, rand() % 200 - 100, rand() % 200 - 100, rand() % 200 - 100)));
+    }
+
+    BBox b1 = BBox(vec3(1), 1.0f, vec3(0), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1), 0, 1.5f);
+    BBox b2 = BBox(vec3(1), 1.0f, vec3(0), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1), 0, 1.5f);
+
+    int hits[2] = {0, 0};
+    double times[2];
+    for (int method = 0; method < 2; method ++) {
+        Stopwatch timer;
+        for (int i = 0; i < count; i ++) {
+            int i1 = i % pool;
+            int i2 = (i1 + 1 + i / pool) % pool;
+            b1.com() = coms[i1]; b1.rot() = rots[i1];
+            b2.com() = coms[i2]; b2.rot() = rots[i2];
+
+            Collision collision;
+            if (method == 0) {
+                vec3 normal = SAT_boxBox(b1, b2, dims[i1], dims[i2]);
+                if (vec3::dot(normal, normal) != 0) {
+                    SAT_boxBoxCollision(&collision, b1, b2, dims[i1], dims[i2]);
+                }
+            } else {
+                OBB_boxBoxCollision(&collision, b1, b2, dims[i1], dims[i2]);
+            }
+            hits[method] += collision.col;
+        }
+        times[method] = timer.elapsed();
+    }
+
+    cout << "\nSAT\tPairs: " << count << "\tCollisions: " << hits[0] << "\tTime: " << times[0] << "\tPairs/s: " << count / times[0];
+    cout << "\nOBB\tPairs: " << count << "\tCollisions: " << hits[1] << "\tTime: " << times[1] << "\tPairs/s: " << count / times[1];
+
+    // a box resting over the edge of another (so its face is clipped by the other's sides) keeps the same contact ids,
+    // each naming the same point of the box, from step to step
+    World physics = World(0.01, AABB_TREE);
+    BBox ground = BBox(vec3(2, 0.5f, 2), 1.0f, vec3(0), vec4(vec3(1, 0, 0), 0), 0.5f, true, vec3(1), 0, 1.5f);
+    BBox box = BBox(vec3(1.5f, 0.5f, 1.5f), 1.0f, vec3(1.2f, 1.0f, 0), vec4(vec3(1, 0, 0), 0), 0.5f, false, vec3(1), 0, 1.5f);
+    physics.addShape(&ground);
+    physics.addShape(&box);
+    physics.run(100);
+
+    const int steps = 200;
+    vector<int> settled;
+    unordered_map<int, vec3> points;
+    bool stable = true;
+    for (int step = 0; step < steps; step ++) {
+        physics.step();
+        Collision collision;
+        OBB_boxBoxCollision(&collision, box, ground, box.getDimensions(), ground.getDimensions());
+        vector<int> ids = collision.ids;
+        sort(ids.begin(), ids.end());
+        if (step == 0) {
+            settled = ids;
+        }
+        stable = stable && collision.col && ids == settled;
+        vec4 q = box.rot();
+        vec4 conj = vec4(q.X(), -q.Y(), -q.Z(), -q.W());
+        for (int i = 0; i < (int)collision.ids.size() && i < (int)collision.man.size(); i ++) {
+            vec3 local = vec3::rotate(collision.man[i] - box.com(), conj);
+            unordered_map<int, vec3>::iterator it = points.find(collision.ids[i]);
+            if (it == points.end()) {
+                points[collision.ids[i]] = local;
+            } else {
+                stable = stable && vec3::mag(it->second - local) < 0.01f;
+            }
+        }
+    }
+    cout << "\nResting box\tSteps: " << steps << "\tContacts: " << settled.size() << "\tIds seen: " << points.size();
+
+    // sliding a turned box off the other in small steps clips its face differently as it goes, and a point that stays
+    // in the manifold from one step to the next keeps its id (another point never takes it over)
+    BBox sliding = BBox(vec3(1, 0.5f, 1), 1.0f, vec3(0), vec4(vec3(0, 1, 0), 0.3f), 0.5f, false, vec3(1), 0, 1.5f);
+    int slides = 0;
+    for (int direction = 0; direction < 16; direction ++) {
+        float angle = direction * (float)M_PI / 8;
+        unordered_map<int, vec3> last;
+        for (int i = 0; i <= 600; i ++, slides ++) {
+            sliding.com() = vec3(cos(angle) * i * 0.003f, 0.995f, sin(angle) * i * 0.003f);
+            Collision collision;
+            OBB_boxBoxCollision(&collision, sliding, ground, sliding.getDimensions(), ground.getDimensions());
+            unordered_map<int, vec3> current;
+            for (int j = 0; j < (int)collision.ids.size() && j < (int)collision.man.size(); j ++) {
+                current[collision.ids[j]] = collision.man[j];
+                unordered_map<int, vec3>::iterator it = last.find(collision.ids[j]);
+                stable = stable && (it == last.end() || vec3::mag(it->second - collision.man[j]) < 0.05f);
+            }
+            last.swap(current);
+        }
+    }
+    cout << "\nSliding box\tPositions: " << slides;
+    cout << (stable ? "\nContact ids are stable\n" : "\nContact ids changed\n");
+    return !stable;
+}
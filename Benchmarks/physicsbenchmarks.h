@@ -0,0 +1,70 @@
+// Headless benchmarks of the physics engine (each returns nonzero when its checks fail)
+#ifndef _PHYSICSBENCHMARKS_H
+#define _PHYSICSBENCHMARKS_H
+
+#include "stopwatch.h"
+
+/**
+ * Steps a simple scene without any graphics and reports physics throughput
+ * @param count Number of fixed timesteps to simulate
+ * @param type Broadphase to use
+ */
+int runHeadless(int count, BroadphaseType type);
+
+/**
+ * Integrates a large store with every supported integrator path, comparing each against the scalar path
+ * @param count Number of bodies
+ * @param steps Number of fixed timesteps to integrate
+ */
+int runIntegratorBenchmark(int count, int steps);
+
+/**
+ * Steps a scene of many separate piles of spheres, serially and across threads, comparing the results
+ * @param piles Number of piles (each pile is its own island)
+ * @param count Number of fixed timesteps to simulate
+ */
+int runIslandBenchmark(int piles, int count);
+
+/**
+ * Fills an AABB tree with spheres inserted in sorted order, moves them and removes half of them, checking after each
+ * stage that the tree stays balanced and that box queries run across threads find what testing every sphere finds
+ * @param count Number of spheres
+ */
+int runTreeBenchmark(int count);
+
+/**
+ * Moves clusters of spheres and keeps the pairs of a sweep and prune broadphase and an AABB tree broadphase up to date,
+ * checking that both report the same pairs with the same ages every step and after removing shapes, and the pairs every
+ * pair test finds at the end
+ * @param count Number of spheres (a tenth of them anchored)
+ * @param steps Number of updates
+ */
+int runBroadphaseBenchmark(int count, int steps);
+
+/**
+ * Drives worlds through World::advance at different frame rates, checking that each takes the steps its frame time covers
+ * and ends up exactly where run would with as many steps, that shapes parsed at their render poses only when they change
+ * match shapes parsed every frame, and comparing how far shapes drawn at their body state and at their render poses move
+ * per frame against their velocity
+ * @param seconds Frame time to simulate per frame rate
+ * @param count Number of spheres
+ */
+int runTimestepBenchmark(float seconds, int count);
+
+/**
+ * Settles a stack of spheres with different solver settings, reporting how fast the spheres still move over the last
+ * steps and how far the top sphere has sunk, and checking that more iterations (and warm starting) settle the stack better
+ * @param height Number of spheres in the stack
+ * @param count Number of fixed timesteps to simulate
+ */
+int runStackBenchmark(int height, int count);
+
+/**
+ * Runs the SAT box-box functions and the closed form OBB routine over the same random box pairs
+ * @param count Number of pairs
+ */
+int runBoxBoxBenchmark(int count);
+
+#include "physicsbenchmarks.cpp"
+
+#endif
@@ -0,0 +1,289 @@
+#include "recordbenchmarks.h"
+
+/**
+ * Renders frames of a camera orbiting a small scene on the CPU tracer
+ * @param captured Receives the frames as RGBA, bottom row first as glReadPixels reads them
+ */
+static void captureOrbit(int frames, int size, vector<vector<uint8_t>>& captured) {
+    BBox world = BBox(vec3(100, 1, 100), 1.0f, vec3(0, -2, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 0, 1), 1, 1.5f);
+    Sphere sphere = Sphere(1.0f, 1.0f, vec3(1, 0, 1), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(0, 0, 1), 0, 1.5f);
+    BBox box = BBox(vec3(3, 0.5, 3), 1.0f, vec3(2, -0.5, -3), vec4(vec3(0, 1, 0), PI/8), 1.0f, false, vec3(1, 1, 1), 0, 1.5f);
+    BBox light = BBox(vec3(1, 1, 1), 1.0f, vec3(-3, 3, -2), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1, 1, 1), 3, 1.5f);
+    vector<Shape*> shapes = {&world, &sphere, &box, &light};
+
+    Tracer tracer = Tracer(size, size);
+    tracer.setScene(shapes);
+    tracer.setSamples(1);
+    tracer.setThreads(max((int)std::thread::hardware_concurrency(), 1));
+    FrameReader reader;
+    reader.setSize(size, size);
+    captured.assign(frames, vector<uint8_t>((size_t)size * size * 4));
+    for (int f = 0; f < frames; f ++) {
+        float theta = 2 * PI * f / max(frames, 1);
+        vec3 pos = vec3(18 * cos(theta), 2, 18 * sin(theta));
+        tracer.setCamera(pos, vec3::norm(pos * -1.0f));
+        tracer.render();
+        reader.read(tracer.getImage());
+        reader.collect(captured[f].data());
+    }
+}
+
+int runGifBenchmark(int frames, int size) {
+    vector<vector<uint8_t>> captured;
+    captureOrbit(frames, size, captured);
+
+    // column by column through bounds checked writes, as updateGif did
+    GifWriter writer;
+    vector<uint8_t> gifimage((size_t)size * size * 4, 0);
+    Stopwatch timer;
+    GifBegin(&writer, "serial.gif", size, size, 2, 8, true);
+    for (int f = 0; f < frames; f ++) {
+        for (int i = 0; i < size; i ++) {
+            for (int j = 0; j < size; j ++) {
+                const uint8_t* pixel = &captured[f][((size_t)(size - 1 - j) * size + i) * 4];
+                int ind = (j * size + i) * 4;
+                gifimage.at(ind + 0) = pixel[0];
+                gifimage.at(ind + 1) = pixel[1];
+                gifimage.at(ind + 2) = pixel[2];
+                gifimage.at(ind + 3) = 255;
+            }
+        }
+        GifWriteFrame(&writer, gifimage.data(), size, size, 2, 8, true);
+    }
+    GifEnd(&writer);
+    double serialTime = timer.elapsed();
+    cout << "\nFrames: " << frames << "\tSize: " << size;
+    cout << "\nSerial\tCaller: " << serialTime / frames * 1000 << " ms/frame\tTotal: " << serialTime;
+
+    // whole frame bands and a palette per frame, so the recorder writes exactly what gif.h writes
+    GifRecorder recorder;
+    recorder.getEncoder().setBandRows(0);
+    recorder.getEncoder().setPaletteTolerance(-1);
+    double blocked = 0;
+    timer.restart();
+    recorder.begin("recorded.gif", size, size, 2);
+    for (int f = 0; f < frames; f ++) {
+        Stopwatch capture;
+        memcpy(recorder.acquire(), captured[f].data(), captured[f].size());
+        recorder.submit();
+        blocked += capture.elapsed();
+    }
+    bool written = recorder.end();
+    double recordedTime = timer.elapsed();
+    cout << "\nRecorder\tCaller: " << blocked / frames * 1000 << " ms/frame\tTotal: " << recordedTime;
+
+    ifstream serial("serial.gif", ios::binary);
+    ifstream recorded("recorded.gif", ios::binary);
+    string serialBytes((istreambuf_iterator<char>(serial)), istreambuf_iterator<char>());
+    string recordedBytes((istreambuf_iterator<char>(recorded)), istreambuf_iterator<char>());
+    bool same = written && recorder.getFrames() == frames && !serialBytes.empty() && serialBytes == recordedBytes;
+    remove("serial.gif");
+    remove("recorded.gif");
+
+    cout << (same ? "\nRecorded GIF matches serial GIF\n" : "\nRecorded GIF differs from serial GIF\n");
+    return !same;
+}
+
+int runRecordBenchmark(int frames, int size) {
+    BBox world = BBox(vec3(100, 1, 100), 1.0f, vec3(0, -2, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 0, 1), 1, 1.5f);
+    Sphere sphere = Sphere(1.0f, 1.0f, vec3(1, 0, 1), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(0, 0, 1), 0, 1.5f);
+    BBox box = BBox(vec3(3, 0.5, 3), 1.0f, vec3(2, -0.5, -3), vec4(vec3(0, 1, 0), PI/8), 1.0f, false, vec3(1, 1, 1), 0, 1.5f);
+    BBox light = BBox(vec3(1, 1, 1), 1.0f, vec3(-3, 3, -2), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1, 1, 1), 3, 1.5f);
+    vector<Shape*> shapes = {&world, &sphere, &box, &light};
+
+    Tracer tracer = Tracer(size, size);
+    tracer.setScene(shapes);
+    tracer.setSamples(1);
+    // the tracer gets every core but one, which is left to the encoder
+    tracer.setThreads(max((int)std::thread::hardware_concurrency() - 1, 1));
+
+    double times[2];
+    int recordedFrames = 0;
+    bool written = true;
+    for (int run = 0; run < 2; run ++) {
+        FrameReader reader;
+        reader.setSize(size, size);
+        GifRecorder recorder;
+        if (run == 1) {
+            recorder.begin("record.gif", size, size, 2);
+        }
+        Stopwatch timer;
+        for (int f = 0; f < frames; f ++) {
+            float theta = 2 * PI * f / max(frames, 1);
+            vec3 pos = vec3(18 * cos(theta), 2, 18 * sin(theta));
+            tracer.setCamera(pos, vec3::norm(pos * -1.0f));
+            tracer.render();
+            if (run == 1) {
+                // the same hand off as Kernel::updateOutput
+                while (reader.ready() || reader.getPending() == reader.getBuffers()) {
+                    reader.collect(recorder.acquire(), true);
+                    recorder.submit();
+                }
+                reader.read(tracer.getImage());
+            }
+        }
+        if (run == 1) {
+            while (reader.getPending() > 0) {
+                reader.collect(recorder.acquire(), true);
+                recorder.submit();
+            }
+            written = recorder.end();
+            recordedFrames = recorder.getFrames();
+        }
+        times[run] = timer.elapsed();
+        cout << (run == 0 ? "\nRendering\tTime: " : "\nRecording\tTime: ") << times[run] << "\tms/frame: " << times[run] / frames * 1000;
+    }
+    remove("record.gif");
+
+    bool complete = written && recordedFrames == frames;
+    cout << "\nThreads: " << tracer.getThreads() << "\tFrames: " << frames << "\tSize: " << size << "\tOverhead: " << (times[1] / times[0] - 1) * 100 << "%";
+    cout << (complete ? "\nRecorded every frame\n" : "\nFrames were lost while recording\n");
+    return !complete;
+}
+
+int runSinkBenchmark(int frames, int size) {
+    vector<vector<uint8_t>> captured;
+    captureOrbit(frames, size, captured);
+    cout << "\nFrames: " << frames << "\tSize: " << size << "\tThreads: " << max((int)std::thread::hardware_concurrency(), 1);
+
+    const char* names[] = {"gif", "png", "ppm", "y4m"};
+    bool correct = true;
+    for (const char* name : names) {
+        FrameSinkType type = GIF_SINK;
+        FrameSink::parseType(name, type);
+        unique_ptr<FrameSink> sink(FrameSink::create(type));
+        string path = type == GIF_SINK || type == Y4M_SINK ? string("sink.") + name : string("sink_");
+
+        double blocked = 0;
+        Stopwatch timer;
+        int fps = 50;
+        bool written = sink->open(path, size, size, fps);
+        for (int f = 0; f < frames && written; f ++) {
+            Stopwatch capture;
+            memcpy(sink->acquire(), captured[f].data(), captured[f].size());
+            sink->submit();
+            blocked += capture.elapsed();
+        }
+        written = sink->close() && written && sink->getFrames() == frames;
+        double time = timer.elapsed();
+
+        // sequences are checked and removed file by file
+        vector<string> files;
+        if (type == PNG_SINK || type == PPM_SINK) {
+            for (int f = 0; f < frames; f ++) {
+                files.push_back(((ImageSequence*)sink.get())->getFile(f));
+            }
+        } else {
+            files.push_back(path);
+        }
+        double bytes = 0;
+        for (int f = 0; f < (int)files.size(); f ++) {
+            ifstream in(files[f].c_str(), ios::binary);
+            string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+            bytes += contents.size();
+            if (type == PPM_SINK) {
+                // the header is followed by the frame's rows from the top, without alpha
+                string header = "P6\n" + to_string(size) + " " + to_string(size) + "\n255\n";
+                bool same = contents.size() == header.size() + (size_t)size * size * 3 && contents.compare(0, header.size(), header) == 0;
+                for (int p = 0; same && p < size * size; p ++) {
+                    const uint8_t* pixel = &captured[f][((size_t)(size - 1 - p / size) * size + p % size) * 4];
+                    same = memcmp(&contents[header.size() + (size_t)p * 3], pixel, 3) == 0;
+                }
+                written = written && same;
+            }
+            if (type == Y4M_SINK) {
+                // the stream plays back at the rate it was opened with, and holds a header and the planes of every frame
+                string header = "YUV4MPEG2 W" + to_string(size) + " H" + to_string(size) + " F" + to_string(fps) + ":1 ";
+                size_t frameBytes = 6 + (size_t)size * size + 2 * (size_t)((size + 1) / 2) * ((size + 1) / 2);
+                size_t end = contents.find('\n');
+                written = written && contents.compare(0, header.size(), header) == 0 && end != string::npos &&
+                    contents.size() == end + 1 + frames * frameBytes;
+            }
+            if (contents.empty()) {
+                written = false;
+            }
+            remove(files[f].c_str());
+        }
+        correct = correct && written;
+        cout << "\n" << name << "\tCaller: " << blocked / frames * 1000 << " ms/frame\tTotal: " << time << "\tMB: " << bytes / 1048576.0 << (written ? "" : "\t(failed)");
+    }
+
+    cout << (correct ? "\nEvery sink wrote every frame\n" : "\nA sink lost frames\n");
+    return !correct;
+}
+
+/**
+ * Writes frames to a GIF through a GifEncoder, in runs of the given length
+ * @return the file's contents (empty if it could not be written)
+ */
+static string encodeGif(GifEncoder& encoder, const vector<vector<uint8_t>>& captured, int size, bool dither, int run, double& time) {
+    Stopwatch timer;
+    GifWriter writer;
+    if (!GifBegin(&writer, "encoded.gif", size, size, 2, 8, dither)) {
+        return "";
+    }
+    encoder.setDither(dither);
+    encoder.reset(size, size);
+    bool written = true;
+    for (size_t f = 0; f < captured.size(); f += run) {
+        vector<const uint8_t*> frames;
+        for (size_t i = f; i < min(f + run, captured.size()); i ++) {
+            frames.push_back(captured[i].data());
+        }
+        written = encoder.encode(frames, true, 2, writer.f) && written;
+    }
+    GifEnd(&writer);
+    time = timer.elapsed();
+
+    ifstream in("encoded.gif", ios::binary);
+    string contents((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    remove("encoded.gif");
+    return written ? contents : "";
+}
+
+int runGifEncodeBenchmark(int frames, int size) {
+    vector<vector<uint8_t>> captured;
+    captureOrbit(frames, size, captured);
+    int threads = max((int)std::thread::hardware_concurrency(), 2);
+    cout << "\nFrames: " << frames << "\tSize: " << size << "\tThreads: " << threads;
+
+    bool correct = true;
+    for (int dither = 1; dither >= 0; dither --) {
+        Stopwatch timer;
+        GifWriter writer;
+        GifBegin(&writer, "reference.gif", size, size, 2, 8, dither);
+        vector<uint8_t> image((size_t)size * size * 4);
+        for (int f = 0; f < frames; f ++) {
+            FrameSink::flip(captured[f].data(), image.data(), size, size);
+            GifWriteFrame(&writer, image.data(), size, size, 2, 8, dither);
+        }
+        GifEnd(&writer);
+        double referenceTime = timer.elapsed();
+        ifstream in("reference.gif", ios::binary);
+        string reference((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+        remove("reference.gif");
+        cout << "\n" << (dither ? "Dithered" : "Thresholded") << "\ngif.h\t\tTime: " << referenceTime << "\tKB: " << reference.size() / 1024;
+
+        double time;
+        GifEncoder exact(threads);
+        exact.setBandRows(0);
+        exact.setPaletteTolerance(-1);
+        string matched = encodeGif(exact, captured, size, dither, frames, time);
+        bool same = !matched.empty() && matched == reference;
+        cout << "\nExact\t\tTime: " << time << "\tSpeedup: " << referenceTime / time << (same ? "\t(matches gif.h)" : "\t(differs from gif.h)");
+
+        GifEncoder serial(1);
+        double serialTime;
+        string serialBytes = encodeGif(serial, captured, size, dither, 1, serialTime);
+        GifEncoder parallel(threads);
+        string parallelBytes = encodeGif(parallel, captured, size, dither, frames, time);
+        bool deterministic = !serialBytes.empty() && serialBytes == parallelBytes;
+        cout << "\nDefaults\tTime: " << time << "\tSpeedup: " << referenceTime / time << "\tKB: " << parallelBytes.size() / 1024;
+        cout << "\tPalettes: " << parallel.getPalettesBuilt() << " built, " << parallel.getPalettesReused() << " reused";
+        cout << (deterministic ? "\t(matches 1 thread)" : "\t(differs from 1 thread)");
+        correct = correct && same && deterministic;
+    }
+
+    cout << (correct ? "\nEncoded GIFs match\n" : "\nEncoded GIFs differ\n");
+    return !correct;
+}
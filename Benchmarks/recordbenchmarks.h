@@ -0,0 +1,45 @@
+// Headless benchmarks of frame recording and encoding (each returns nonzero when its checks fail)
+#ifndef _RECORDBENCHMARKS_H
+#define _RECORDBENCHMARKS_H
+
+#include "stopwatch.h"
+
+/**
+ * Renders frames of an orbiting camera on the CPU tracer, then writes them to a GIF the way the kernel used to (pixel by
+ * pixel, encoded on the calling thread) and through GifRecorder, reporting the time each leaves the caller blocked and
+ * checking both GIFs are identical
+ * @param frames Number of frames
+ * @param size Width and height of the frames in pixels
+ */
+int runGifBenchmark(int frames, int size);
+
+/**
+ * Renders an orbit of frames on the CPU tracer, once on its own and once recording every frame to a GIF through FrameReader
+ * and GifRecorder (as the kernel records), reporting how much longer the recorded run takes
+ * @param frames Number of frames
+ * @param size Width and height of the frames in pixels
+ */
+int runRecordBenchmark(int frames, int size);
+
+/**
+ * Writes an orbit of frames rendered on the CPU tracer through every frame sink, reporting the time each leaves the caller
+ * blocked per frame, the total time and the bytes written, and checking the PPM sequence holds the frames exactly (numbered
+ * from the first) and the Y4M stream plays back at the rate it was opened with
+ * @param frames Number of frames
+ * @param size Width and height of the frames in pixels
+ */
+int runSinkBenchmark(int frames, int size);
+
+/**
+ * Encodes an orbit of frames rendered on the CPU tracer with gif.h on one thread and with GifEncoder across every core,
+ * with and without dithering. GifEncoder is first set up to match gif.h byte for byte (whole frame bands, a palette per
+ * frame), then run with its defaults (banded dithering, palettes reused while the scene's colors hold), once on one thread
+ * a frame at a time and once across every core in a single run, checking both give the same file
+ * @param frames Number of frames
+ * @param size Width and height of the frames in pixels
+ */
+int runGifEncodeBenchmark(int frames, int size);
+
+#include "recordbenchmarks.cpp"
+
+#endif
@@ -0,0 +1,404 @@
+#include "renderbenchmarks.h"
+
+int runSceneBenchmark(int anchored, int moving, int count) {
+    World physics = World(0.01, AABB_TREE);
+    int side = (int)ceil(sqrt((float)max(anchored, moving)));
+    BBox ground = BBox(vec3(side * 4.0f, 1, side * 4.0f), 1.0f, vec3(0, -1, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 1, 1), 0, 1.5f);
+    physics.addShape(&ground);
+
+    vector<unique_ptr<Shape>> shapes;
+    for (int i = 0; i < anchored; i ++) {
+        vec3 com = vec3((i % side) * 4.0f - side * 2.0f, 0.5f, (i / side) * 4.0f - side * 2.0f);
+        shapes.push_back(unique_ptr<Shape>(new BBox(vec3(1), 1.0f, com, vec4(vec3(1, 0, 0), 0), 0.5f, true, vec3(1, 0, 0), 0, 1.5f)));
+        physics.addShape(shapes.back().get());
+    }
+    for (int i = 0; i < moving; i ++) {
+        vec3 com = vec3((i % side) * 4.0f - side * 2.0f + 2.0f, 3.0f, (i / side) * 4.0f - side * 2.0f + 2.0f);
+        shapes.push_back(unique_ptr<Shape>(new Sphere(1.0f, 1.0f, com, vec4(vec3(1, 0, 0), 0), 0.5f, false, vec3(0, 0, 1), 0, 1.5f)));
+        physics.addShape(shapes.back().get());
+    }
+
+    SceneBuffer incremental;
+    SceneBuffer full;
+    double times[2] = {0, 0};
+    long long changed = 0;
+    bool same = true;
+    for (int frame = 0; frame < count; frame ++) {
+        physics.step();
+
+        Stopwatch timer;
+        incremental.update(physics.getShapes());
+        times[0] += timer.elapsed();
+        changed += incremental.getChanged();
+
+        timer.restart();
+        full.invalidate();
+        full.update(physics.getShapes());
+        times[1] += timer.elapsed();
+
+        same = same && memcmp(incremental.getData(), full.getData(), full.getSize() * WIDTH * sizeof(float)) == 0;
+    }
+
+    int size = full.getSize();
+    double average = (double)changed / count;
+    cout << "\nShapes: " << size << "\tCapacity: " << full.getCapacity() << "\tFrames: " << count;
+    cout << "\nFull\tShapes parsed per frame: " << size << "\tBytes per frame: " << sizeof(SceneHeader) + size * WIDTH * sizeof(float) << "\tTime: " << times[1];
+    cout << "\nDirty\tShapes parsed per frame: " << average << "\tBytes per frame: " << sizeof(SceneHeader) + average * WIDTH * sizeof(float) << "\tTime: " << times[0] << "\tSpeedup: " << times[1] / times[0];
+    cout << (same ? "\nIncremental buffer matches full buffer\n" : "\nIncremental buffer differs from full buffer\n");
+    return !same;
+}
+
+int runRenderBenchmark(int samples, int size) {
+    BBox world = BBox(vec3(100, 1, 100), 1.0f, vec3(0, -2, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 0, 1), 1, 1.5f);
+    Sphere sphere = Sphere(1.0f, 1.0f, vec3(1, 0, 1), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(0, 0, 1), 0, 1.5f);
+    Sphere glass = Sphere(0.75f, 1.0f, vec3(-2, -0.25, 2), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1, 1, 1), 2, 1.5f);
+    BBox box = BBox(vec3(3, 0.5, 3), 1.0f, vec3(2, -0.5, -3), vec4(vec3(0, 1, 0), PI/8), 1.0f, false, vec3(1, 1, 1), 0, 1.5f);
+    BBox light = BBox(vec3(1, 1, 1), 1.0f, vec3(-3, 3, -2), vec4(vec3(1, 0, 0), 0), 1.0f, false, vec3(1, 1, 1), 3, 1.5f);
+    Capsule capsule = Capsule(1.0f, 0.5f, 1.0f, vec3(-3, 0, -2), vec4(vec3(1, -1, 1), PI/4), 1.0f, false, vec3(0, 1, 0), 1, 1.5f);
+    vector<Shape*> shapes = {&world, &sphere, &glass, &box, &light, &capsule};
+
+    // the camera the kernel starts with
+    float theta = -1.5806;
+    float phi = 0.00600009 + PI/2;
+
+    vector<vec3> images[2];
+    for (int run = 0; run < 2; run ++) {
+        Tracer tracer = Tracer(size, size);
+        tracer.setScene(shapes);
+        tracer.setCamera(vec3(0.207363, 0.474331, 18.6775), vec3(sin(phi) * cos(theta), cos(phi), sin(phi) * sin(theta)));
+        tracer.setSamples(samples);
+        tracer.setThreads(run == 0 ? 1 : max((int)std::thread::hardware_concurrency(), 2));
+
+        double time = tracer.render();
+        images[run] = tracer.getImage();
+        cout << "\nThreads: " << tracer.getThreads() << "\tSamples: " << samples << "\tTime: " << time << "\tPaths/s: " << (double)size * size * samples / time;
+        if (run == 1) {
+            tracer.save("render.bmp");
+        }
+    }
+
+    bool same = memcmp(images[0].data(), images[1].data(), images[0].size() * sizeof(vec3)) == 0;
+    cout << (same ? "\nThreaded image matches serial image (saved to render.bmp)\n" : "\nThreaded image differs from serial image\n");
+    return !same;
+}
+
+int runPacketBenchmark(int count, int size) {
+    BBox world = BBox(vec3(100, 1, 100), 1.0f, vec3(0, -2, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 0, 1), 1, 1.5f);
+    vector<unique_ptr<Shape>> owned;
+    vector<Shape*> shapes = {&world};
+    int side = (int)ceil(sqrt((float)count));
+    for (int i = 0; i < count; i ++) {
+        vec3 com = vec3((i % side) * 2.5f - side * 1.25f, (i / side) * 2.5f - side * 0.5f, 0);
+        vec4 rot = vec4(vec3(1, 1, 0), i * 0.3f);
+        switch (i % 3) {
+            case 0:
+                owned.push_back(unique_ptr<Shape>(new Sphere(0.9f, 1.0f, com, rot, 1.0f, false, vec3(0, 0, 1), 0, 1.5f)));
+                break;
+            case 1:
+                owned.push_back(unique_ptr<Shape>(new BBox(vec3(0.8, 0.6, 0.7), 1.0f, com, rot, 1.0f, false, vec3(1, 0, 0), 0, 1.5f)));
+                break;
+            default:
+                owned.push_back(unique_ptr<Shape>(new Capsule(0.6f, 0.4f, 1.0f, com, rot, 1.0f, false, vec3(0, 1, 0), 0, 1.5f)));
+                break;
+        }
+        shapes.push_back(owned.back().get());
+    }
+
+    Tracer tracer = Tracer(size, size);
+    tracer.setScene(shapes);
+    tracer.setCamera(vec3(0, 0, 4 + side * 3.0f), vec3(0, 0, -1));
+
+    vector<int> reference;
+    tracer.setPackets(false);
+    double time = tracer.castPrimary(reference);
+    double rays = (double)size * size;
+    cout << "\nSingle rays\tShapes: " << shapes.size() << "\tTime: " << time << "\tMrays/s: " << rays / time / 1e6;
+
+    SimdPath supported = Simd_detectPath();
+    tracer.setPackets(true);
+    for (int path = SIMD_SCALAR; path <= supported; path ++) {
+        tracer.setPath((SimdPath)path);
+
+        vector<int> hits;
+        time = tracer.castPrimary(hits);
+        int same = 0;
+        for (int i = 0; i < (int)hits.size(); i ++) {
+            same += hits[i] == reference[i];
+        }
+        cout << "\n" << Simd_pathName((SimdPath)path) << " packets\tShapes: " << shapes.size() << "\tTime: " << time << "\tMrays/s: " << rays / time / 1e6 << "\tMatching hits: " << 100.0 * same / hits.size() << "%";
+    }
+    cout << "\n";
+    return 0;
+}
+
+int runMeshBenchmark(const char* file, int queries) {
+    Stopwatch timer;
+    Mesh mesh = Mesh(0, 0, file, 1.0f, vec3(0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(0.8, 0.6, 0.4), 0, 1.5f);
+    double loadTime = timer.elapsed();
+
+    // further instances of the file share the first one's asset
+    int instances = 100;
+    vector<unique_ptr<Mesh>> props;
+    timer.restart();
+    for (int i = 0; i < instances; i ++) {
+        props.push_back(unique_ptr<Mesh>(new Mesh(0, 0, file, 1.0f, vec3(i, 0, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1), 0, 1.5f)));
+    }
+    double instanceTime = timer.elapsed();
+    cout << "\nInstances: " << instances + 1 << "\tAssets: " << MeshRegistry::getAssetCount() << "\tInstance time: " << instanceTime / instances << "\tBytes per instance: " << sizeof(Mesh);
+    props.clear();
+
+    // indexed storage against writing every corner out as the mesh used to
+    vector<float> vertices = mesh.getTriangles();
+    int triangles = vertices.size() / 9;
+    size_t indexed = (mesh.getVertices().size() + mesh.getNormals().size() + mesh.getTexcoords().size()) * sizeof(float)
+                   + mesh.getIndexCount() * (mesh.usesShortIndices() ? sizeof(uint16_t) : sizeof(uint32_t));
+    cout << "\nVertices: " << mesh.getVertexCount() << "\tIndices: " << mesh.getIndexCount() << " (" << (mesh.usesShortIndices() ? 16 : 32) << " bit)"
+         << "\tIndexed bytes: " << indexed << "\tUnindexed bytes (same attributes per corner): " << (size_t)mesh.getIndexCount() * 8 * sizeof(float);
+    MeshBVH bvh;
+    timer.restart();
+    bvh.build(vertices);
+    double buildTime = timer.elapsed();
+    cout << "\nTriangles: " << triangles << "\tNodes: " << bvh.getNodes() << "\tLoad time: " << loadTime << "\tBuild time: " << buildTime;
+
+    AABB bounds = bvh.getBounds();
+    vec3 center = (bounds.lower + bounds.upper) * 0.5f;
+    float radius = vec3::mag(bounds.upper - bounds.lower) * 0.5f;
+
+    // rays from a sphere around the mesh towards random points inside its bounds
+    srand(1);
+    vector<vec3> origins(queries);
+    vector<vec3> dirs(queries);
+    for (int i = 0; i < queries; i ++) {
+        vec3 dir = vec3::norm(vec3(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f));
+        vec3 target = bounds.lower + (bounds.upper - bounds.lower) * vec3(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX);
+        origins[i] = center + dir * (radius * 2);
+        dirs[i] = vec3::norm(target - origins[i]);
+    }
+
+    vector<float> bruteT(queries, -1);
+    timer.restart();
+    for (int i = 0; i < queries; i ++) {
+        float closest = TRACER_MAXT * radius;
+        for (int k = 0; k < triangles; k ++) {
+            const float* v = &vertices[9*k];
+            float t;
+            if (MeshBVH::rayTriangle(origins[i], dirs[i], vec3(v[0], v[1], v[2]), vec3(v[3], v[4], v[5]), vec3(v[6], v[7], v[8]), t) && t < closest) {
+                closest = t;
+                bruteT[i] = t;
+            }
+        }
+    }
+    double bruteTime = timer.elapsed();
+
+    int same = 0;
+    int hits = 0;
+    timer.restart();
+    for (int i = 0; i < queries; i ++) {
+        float t = -1;
+        int triangle;
+        if (!bvh.raycast(origins[i], dirs[i], 0, TRACER_MAXT * radius, t, triangle)) {
+            t = -1;
+        }
+        hits += t >= 0;
+        same += fabs(t - bruteT[i]) <= 1e-4f * radius;
+    }
+    double bvhTime = timer.elapsed();
+    cout << "\nRays\tQueries: " << queries << "\tHits: " << hits << "\tBrute force: " << bruteTime << "\tBVH: " << bvhTime << "\tSpeedup: " << bruteTime / bvhTime << "\tMatching: " << 100.0 * same / queries << "%";
+
+    // closest points to random points in and around the bounds, as a sphere of a tenth of the mesh's size would query them
+    float r = radius * 0.1f;
+    vector<vec3> points(queries);
+    for (int i = 0; i < queries; i ++) {
+        points[i] = bounds.lower - r + (bounds.upper - bounds.lower + r * 2) * vec3(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX);
+    }
+
+    vector<float> bruteD(queries, -1);
+    timer.restart();
+    for (int i = 0; i < queries; i ++) {
+        float closest = r;
+        for (int k = 0; k < triangles; k ++) {
+            const float* v = &vertices[9*k];
+            float d = vec3::mag(MeshBVH::closestOnTriangle(points[i], vec3(v[0], v[1], v[2]), vec3(v[3], v[4], v[5]), vec3(v[6], v[7], v[8])) - points[i]);
+            if (d <= closest) {
+                closest = d;
+                bruteD[i] = d;
+            }
+        }
+    }
+    bruteTime = timer.elapsed();
+
+    same = 0;
+    hits = 0;
+    timer.restart();
+    for (int i = 0; i < queries; i ++) {
+        vec3 point;
+        int triangle;
+        float d = bvh.closestPoint(points[i], r, point, triangle) ? vec3::mag(point - points[i]) : -1;
+        hits += d >= 0;
+        same += fabs(d - bruteD[i]) <= 1e-4f * radius;
+    }
+    bvhTime = timer.elapsed();
+    cout << "\nPoints\tQueries: " << queries << "\tContacts: " << hits << "\tBrute force: " << bruteTime << "\tBVH: " << bvhTime << "\tSpeedup: " << bruteTime / bvhTime << "\tMatching: " << 100.0 * same / queries << "%";
+
+    // centre the mesh in front of the camera on a floor
+    mesh.com() = center * -1;
+    BBox world = BBox(vec3(100, 1, 100), 1.0f, vec3(0, -(bounds.upper.Y() - bounds.lower.Y()) * 0.5f - 1, 0), vec4(vec3(1, 0, 0), 0), 1.0f, true, vec3(1, 0, 1), 1, 1.5f);
+    vector<Shape*> shapes = {&world, &mesh};
+
+    int size = 128;
+    Tracer tracer = Tracer(size, size);
+    tracer.setScene(shapes);
+    tracer.setCamera(vec3(0, radius * 0.5f, radius * 3.5f), vec3(0, 0.15, -1));
+
+    vector<int> reference;
+    vector<int> packetHits;
+    tracer.setPackets(false);
+    double time = tracer.castPrimary(reference);
+    tracer.setPackets(true);
+    double packetTime = tracer.castPrimary(packetHits);
+    int meshHits = 0;
+    same = 0;
+    for (int i = 0; i < (int)reference.size(); i ++) {
+        meshHits += reference[i] == 1;
+        same += reference[i] == packetHits[i];
+    }
+    cout << "\nPrimary rays\tMesh hits: " << meshHits << "\tSingle rays: " << time << "\tPackets: " << packetTime << "\tMatching: " << 100.0 * same / reference.size() << "%";
+
+    tracer.setSamples(4);
+    time = tracer.render();
+    tracer.save("mesh.bmp");
+    cout << "\nRendered " << size << "x" << size << " at 4 samples in " << time << "s (saved to mesh.bmp)\n";
+    return 0;
+}
+
+int runMeshCacheConverter(const char* file) {
+    bool caching = MeshAsset::usesCaching();
+    MeshAsset::setCaching(false);
+    Stopwatch timer;
+    // assets are loaded directly, as the registry would hand the second load the first one's asset
+    MeshAsset parsed(file);
+    double parseTime = timer.elapsed();
+    MeshAsset::setCaching(caching);
+
+    string cache = MeshAsset::getCachePath(file);
+    if (cache == file || !parsed.saveCache(cache)) {
+        cerr << "Could not write " << cache << "\n";
+        return 1;
+    }
+
+    timer.restart();
+    MeshAsset loaded(cache);
+    double loadTime = timer.elapsed();
+
+    // both assets must hold the same buffers (the cache's served from its mapping) and answer rays through the same triangles
+    bool same = loaded.isMapped() && !parsed.isMapped() && parsed.getVertices() == loaded.getVertices() && parsed.getNormals() == loaded.getNormals() &&
+                parsed.getTexcoords() == loaded.getTexcoords() && parsed.getTriangles() == loaded.getTriangles() &&
+                parsed.getBVH().getNodes() == loaded.getBVH().getNodes() && parsed.getHash() == loaded.getHash();
+    AABB bounds = parsed.getBVH().getBounds();
+    vec3 center = (bounds.lower + bounds.upper) * 0.5f;
+    srand(1);
+    for (int i = 0; i < 1000 && same; i ++) {
+        vec3 dir = vec3::norm(vec3(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f));
+        vec3 ro = center + dir * vec3::mag(bounds.upper - bounds.lower);
+        float t[2] = {-1, -1};
+        int triangle[2] = {-1, -1};
+        parsed.getBVH().raycast(ro, dir * -1, 0, TRACER_MAXT * 10, t[0], triangle[0]);
+        loaded.getBVH().raycast(ro, dir * -1, 0, TRACER_MAXT * 10, t[1], triangle[1]);
+        same = t[0] == t[1] && triangle[0] == triangle[1];
+    }
+
+    ifstream in(cache.c_str(), ios::binary | ios::ate);
+    cout << "\nWrote " << cache << " (" << in.tellg() << " bytes)";
+    cout << "\nObj\tTime: " << parseTime << "\nCache\tTime: " << loadTime << "\tSpeedup: " << parseTime / loadTime;
+    cout << (same ? "\nCached mesh matches parsed mesh\n" : "\nCached mesh differs from parsed mesh\n");
+    return !same;
+}
+
+int runObjParseBenchmark(const char* file, int copies) {
+    ifstream in(file, ios::binary);
+    if (!in) {
+        cerr << "Could not read " << file << "\n";
+        return 1;
+    }
+    vector<string> lines;
+    int counts[3] = {0, 0, 0};
+    for (string line; getline(in, line);) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start != string::npos && line.compare(start, 2, "v ") == 0) {
+            counts[0]++;
+        } else if (start != string::npos && line.compare(start, 3, "vn ") == 0) {
+            counts[1]++;
+        } else if (start != string::npos && line.compare(start, 3, "vt ") == 0) {
+            counts[2]++;
+        }
+        lines.push_back(line);
+    }
+
+    // absolute face indices are offset by the records of the copies before, relative ones are left alone
+    string scaled = string(file) + ".scaled.obj";
+    {
+        ofstream out(scaled.c_str(), ios::binary);
+        for (int c = 0; c < copies && out; c ++) {
+            for (size_t i = 0; i < lines.size(); i ++) {
+                const string& line = lines[i];
+                size_t start = line.find_first_not_of(" \t");
+                if (c == 0 || start == string::npos || line.compare(start, 2, "f ") != 0) {
+                    out << line << "\n";
+                    continue;
+                }
+                out << "f";
+                istringstream corners(line.substr(start + 2));
+                for (string corner; corners >> corner;) {
+                    out << " ";
+                    int field = 0;
+                    size_t begin = 0;
+                    while (begin <= corner.size()) {
+                        size_t end = min(corner.find('/', begin), corner.size());
+                        int index = atoi(corner.substr(begin, end - begin).c_str());
+                        if (end > begin) {
+                            // fields are vertex/texcoord/normal
+                            out << (index > 0 ? index + c * counts[field == 0 ? 0 : field == 1 ? 2 : 1] : index);
+                        }
+                        if (end < corner.size()) {
+                            out << "/";
+                        }
+                        begin = end + 1;
+                        field++;
+                    }
+                }
+                out << "\n";
+            }
+        }
+        if (!out) {
+            cerr << "Could not write " << scaled << "\n";
+            remove(scaled.c_str());
+            return 1;
+        }
+    }
+    ifstream written(scaled.c_str(), ios::binary | ios::ate);
+    double megabytes = written.tellg() / 1048576.0;
+
+    ObjData reference;
+    Stopwatch timer;
+    bool parsed = ObjParser::parseSerial(scaled, reference);
+    double serialTime = timer.elapsed();
+    cout << "\nFile: " << scaled << " (" << megabytes << " MB, " << reference.corners.size() / 3 << " triangles)";
+    cout << "\ntinyobj\tTime: " << serialTime << "\tMB/s: " << megabytes / serialTime;
+
+    bool same = parsed;
+    for (int run = 0; run < 2 && same; run ++) {
+        ObjParser parser = ObjParser(run == 0 ? 1 : max((int)std::thread::hardware_concurrency(), 2));
+        ObjData data;
+        timer.restart();
+        same = parser.parse(scaled, data);
+        double time = timer.elapsed();
+        same = same && data.vertices == reference.vertices && data.normals == reference.normals && data.texcoords == reference.texcoords &&
+               data.corners.size() == reference.corners.size() &&
+               memcmp(data.corners.data(), reference.corners.data(), data.corners.size() * sizeof(tinyobj::index_t)) == 0;
+        cout << "\nThreads: " << parser.getThreads() << "\tTime: " << time << "\tMB/s: " << megabytes / time << "\tSpeedup: " << serialTime / time;
+    }
+    remove(scaled.c_str());
+
+    cout << (same ? "\nParallel parse matches tinyobj\n" : "\nParallel parse differs from tinyobj\n");
+    return !same;
+}
@@ -0,0 +1,53 @@
+// Headless benchmarks of scene upload, the CPU tracer and meshes (each returns nonzero when its checks fail)
+#ifndef _RENDERBENCHMARKS_H
+#define _RENDERBENCHMARKS_H
+
+#include "stopwatch.h"
+
+/**
+ * Steps a scene of mostly anchored shapes, keeping one scene buffer up to date incrementally and reparsing another in full every frame
+ * @param anchored Number of anchored boxes
+ * @param moving Number of falling spheres
+ * @param count Number of frames (one fixed timestep each)
+ */
+int runSceneBenchmark(int anchored, int moving, int count);
+
+/**
+ * Renders the kernel's scene on the CPU tracer with one thread and then across every core, saving the image
+ * @param samples Number of samples per pixel
+ * @param size Width and height of the image in pixels
+ */
+int runRenderBenchmark(int samples, int size);
+
+/**
+ * Casts primary rays through a grid of shapes one ray at a time and in packets on each path, reporting rays per second
+ * on one core and how many rays hit the same shape as the one ray at a time reference
+ * @param count Number of shapes in the grid
+ * @param size Width and height of the image in pixels
+ */
+int runPacketBenchmark(int count, int size);
+
+/**
+ * Loads a mesh and compares its BVH against testing every triangle, for ray casts and for the closest point queries
+ * sphere collisions use, then renders it on the CPU tracer (saved to mesh.bmp)
+ * @param file Path of the obj file
+ * @param queries Number of queries of each kind
+ */
+int runMeshBenchmark(const char* file, int queries);
+
+/**
+ * Converts an obj file to a binary mesh cache next to it, then compares loading the obj against mapping the cache
+ * @param file Path of the obj file
+ */
+int runMeshCacheConverter(const char* file);
+
+/**
+ * Writes an obj file scaled up by repeating its records, then compares parsing it with tinyobj against the parallel parser
+ * @param file Path of the obj file to repeat
+ * @param copies Times the file is repeated (face indices of each copy point at that copy's records)
+ */
+int runObjParseBenchmark(const char* file, int copies);
+
+#include "renderbenchmarks.cpp"
+
+#endif
@@ -0,0 +1,12 @@
+#include "stopwatch.h"
+
+Stopwatch::Stopwatch() : start(chrono::steady_clock::now()) {
+}
+
+void Stopwatch::restart() {
+    start = chrono::steady_clock::now();
+}
+
+double Stopwatch::elapsed() const {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,22 @@
+// Wall clock timer shared by the benchmarks
+#ifndef _STOPWATCH_H
+#define _STOPWATCH_H
+
+#include "../common.h"
+
+class Stopwatch {
+    public:
+        // starts timing
+        Stopwatch();
+
+        void restart();
+        // seconds since the stopwatch was made or last restarted
+        double elapsed() const;
+
+    private:
+        chrono::steady_clock::time_point start;
+};
+
+#include "stopwatch.cpp"
+
+#endif
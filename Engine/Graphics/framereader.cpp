@@ -0,0 +1,183 @@
+#include "framereader.h"
+
+FrameReader::FrameReader(int buffers) : width(0), height(0), next(0), buffers(max(buffers, 1)) {
+    pixels.resize(this->buffers);
+#ifndef HEADLESS
+    pbos.assign(this->buffers, 0);
+    fences.assign(this->buffers, (GLsync)0);
+    gpu.assign(this->buffers, false);
+    async = false;
+#endif
+}
+
+FrameReader::~FrameReader() {
+#ifndef HEADLESS
+    release();
+#endif
+}
+
+void FrameReader::setSize(int width, int height) {
+    if (width == this->width && height == this->height) {
+        return;
+    }
+#ifndef HEADLESS
+    release();
+#endif
+    this->width = width;
+    this->height = height;
+    pending.clear();
+    next = 0;
+    for (int i = 0; i < buffers; i ++) {
+        pixels[i].clear();
+    }
+}
+
+#ifndef HEADLESS
+bool FrameReader::read(GLenum buffer) {
+    if ((int)pending.size() == buffers) {
+        return false;
+    }
+    size_t bytes = (size_t)width * height * 4;
+    // pixel buffer objects are core since GL 2.1, so this only falls back on very old drivers
+    if (!pbos[0] && (GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object)) {
+        glGenBuffers(buffers, pbos.data());
+        for (int i = 0; i < buffers; i ++) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, bytes, NULL, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        async = true;
+    }
+
+    int slot = next;
+    glReadBuffer(buffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    if (async) {
+        // with a pack buffer bound the pixels are copied on the gpu, and the call returns straight away
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    } else {
+        pixels[slot].resize(bytes);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels[slot].data());
+    }
+    gpu[slot] = async;
+    pending.push_back(slot);
+    next = (next + 1) % buffers;
+    return true;
+}
+#endif
+
+bool FrameReader::read(const vector<vec3>& image) {
+    if ((int)pending.size() == buffers || (int)image.size() < width * height) {
+        return false;
+    }
+    int slot = next;
+    pixels[slot].resize((size_t)width * height * 4);
+    for (int y = 0; y < height; y ++) {
+        const vec3* row = &image[(size_t)(height - 1 - y) * width];
+        uint8_t* out = &pixels[slot][(size_t)y * width * 4];
+        for (int x = 0; x < width; x ++) {
+            // rounded and clamped as Tracer::save does
+            out[4*x+0] = (uint8_t)roundf(255.0f * max(0.0f, min(row[x].X(), 1.0f)));
+            out[4*x+1] = (uint8_t)roundf(255.0f * max(0.0f, min(row[x].Y(), 1.0f)));
+            out[4*x+2] = (uint8_t)roundf(255.0f * max(0.0f, min(row[x].Z(), 1.0f)));
+            out[4*x+3] = 255;
+        }
+    }
+#ifndef HEADLESS
+    gpu[slot] = false;
+#endif
+    pending.push_back(slot);
+    next = (next + 1) % buffers;
+    return true;
+}
+
+bool FrameReader::ready() {
+    if (pending.empty()) {
+        return false;
+    }
+#ifndef HEADLESS
+    int slot = pending.front();
+    if (gpu[slot]) {
+        GLenum status = glClientWaitSync(fences[slot], 0, 0);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+#endif
+    return true;
+}
+
+bool FrameReader::collect(uint8_t* destination, bool wait) {
+    if (pending.empty() || (!wait && !ready())) {
+        return false;
+    }
+    int slot = pending.front();
+    size_t bytes = (size_t)width * height * 4;
+#ifndef HEADLESS
+    if (gpu[slot]) {
+        GLenum status = GL_TIMEOUT_EXPIRED;
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(fences[slot]);
+        fences[slot] = 0;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, bytes, GL_MAP_READ_BIT);
+        if (mapped) {
+            memcpy(destination, mapped, bytes);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        pending.pop_front();
+        return mapped != NULL;
+    }
+#endif
+    memcpy(destination, pixels[slot].data(), bytes);
+    pending.pop_front();
+    return true;
+}
+
+int FrameReader::getPending() const {
+    return pending.size();
+}
+
+int FrameReader::getBuffers() const {
+    return buffers;
+}
+
+int FrameReader::getWidth() const {
+    return width;
+}
+
+int FrameReader::getHeight() const {
+    return height;
+}
+
+bool FrameReader::isAsync() const {
+#ifndef HEADLESS
+    return async;
+#else
+    return false;
+#endif
+}
+
+#ifndef HEADLESS
+// Deletes the pixel buffers and fences, dropping any pending reads (the next read makes new buffers)
+void FrameReader::release() {
+    for (int i = 0; i < buffers; i ++) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = 0;
+        }
+    }
+    if (pbos[0]) {
+        glDeleteBuffers(buffers, pbos.data());
+        pbos.assign(buffers, 0);
+    }
+    async = false;
+    pending.clear();
+    next = 0;
+}
+#endif
@@ -0,0 +1,81 @@
+// Reads rendered frames back to the cpu a few frames behind, without waiting on the gpu
+#ifndef _FRAMEREADER_H
+#define _FRAMEREADER_H
+
+#include "../../common.h"
+
+// reads that can be in flight at once (the frame read N frames ago is collected while the latest renders)
+#define FRAMEREADER_BUFFERS 3
+
+class FrameReader {
+    public:
+        // @param buffers Number of frames that can be read before the oldest has to be collected
+        FrameReader(int buffers = FRAMEREADER_BUFFERS);
+        ~FrameReader();
+
+        // size of the frames read (pending reads are dropped if it changes)
+        void setSize(int width, int height);
+
+#ifndef HEADLESS
+        /**
+         * Starts reading a color buffer of the current framebuffer as RGBA into the next pixel buffer object, fencing the read so it
+         * can be collected once the gpu is done with it. Without pixel buffer objects the pixels are read straight away
+         * @param buffer Color buffer to read (GL_FRONT or GL_BACK)
+         * @return whether or not the read was queued (false while every buffer is pending)
+         */
+        bool read(GLenum buffer);
+#endif
+        /**
+         * Software path for frames rendered on the cpu: converts an image (rows from the top, as the tracer stores it) to the
+         * layout reads from the gpu have, so headless runs can record through the same code
+         * @return whether or not the frame was queued (false while every buffer is pending)
+         */
+        bool read(const vector<vec3>& image);
+
+        // whether the oldest pending read can be collected without waiting
+        bool ready();
+        /**
+         * Copies the oldest pending frame (width * height RGBA pixels, bottom row first as glReadPixels writes them) and frees its buffer
+         * @param wait Whether to wait for the gpu to finish the read
+         * @return whether or not a frame was copied
+         */
+        bool collect(uint8_t* destination, bool wait = false);
+
+        int getPending() const;
+        int getBuffers() const;
+        int getWidth() const;
+        int getHeight() const;
+        // whether gpu reads go through pixel buffer objects
+        bool isAsync() const;
+
+#ifndef HEADLESS
+        // deletes the pixel buffers and fences (has to happen while the context is current)
+        void release();
+#endif
+
+    private:
+        // the pixel buffers are owned, so copying would delete them twice
+        FrameReader(const FrameReader&);
+        FrameReader& operator= (const FrameReader&);
+
+        int width;
+        int height;
+        // buffers in the order they were read, oldest first, and the buffer the next read goes into
+        deque<int> pending;
+        int next;
+        int buffers;
+        // frames read on the cpu (or without pixel buffer objects)
+        vector<vector<uint8_t>> pixels;
+
+#ifndef HEADLESS
+        vector<GLuint> pbos;
+        vector<GLsync> fences;
+        // whether each buffer was read through its pixel buffer object
+        vector<bool> gpu;
+        bool async;
+#endif
+};
+
+#include "framereader.cpp"
+
+#endif
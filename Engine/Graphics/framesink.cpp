@@ -0,0 +1,154 @@
+#include "framesink.h"
+
+FrameSink::FrameSink(int buffers) : width(0), height(0), current(-1), running(false), stopping(false), failed(false), frames(0) {
+    this->buffers.resize(max(buffers, 1));
+}
+
+// Sinks stop the encoder in their own destructors (encode cannot be called once a sink is being destroyed)
+FrameSink::~FrameSink() {}
+
+void FrameSink::start(int width, int height) {
+    this->width = width;
+    this->height = height;
+    idle.clear();
+    queued.clear();
+    for (int i = 0; i < (int)buffers.size(); i ++) {
+        buffers[i].assign((size_t)width * height * 4, 0);
+        idle.push_back(i);
+    }
+    current = -1;
+    stopping = false;
+    failed = false;
+    frames = 0;
+    running = true;
+    encoder = std::thread(&FrameSink::encodeLoop, this);
+}
+
+bool FrameSink::finish() {
+    if (!running) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    changed.notify_all();
+    encoder.join();
+    running = false;
+    return !failed;
+}
+
+uint8_t* FrameSink::acquire() {
+    std::unique_lock<std::mutex> guard(lock);
+    if (current < 0) {
+        changed.wait(guard, [this] { return !idle.empty(); });
+        current = idle.back();
+        idle.pop_back();
+    }
+    return buffers[current].data();
+}
+
+void FrameSink::submit() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (current < 0) {
+            return;
+        }
+        queued.push_back(current);
+        current = -1;
+    }
+    changed.notify_all();
+}
+
+/**
+ * Encodes every frame queued since the last run, in the order they were captured, until finish is called and the queue has run dry
+ */
+void FrameSink::encodeLoop() {
+    vector<int> run;
+    vector<const uint8_t*> pixels;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            changed.wait(guard, [this] { return stopping || !queued.empty(); });
+            if (queued.empty()) {
+                return;
+            }
+            run.assign(queued.begin(), queued.end());
+            queued.clear();
+        }
+
+        pixels.clear();
+        for (int frame : run) {
+            pixels.push_back(buffers[frame].data());
+        }
+        if (!encode(pixels, frames)) {
+            failed = true;
+        }
+        frames += run.size();
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            idle.insert(idle.end(), run.begin(), run.end());
+        }
+        changed.notify_all();
+    }
+}
+
+bool FrameSink::isOpen() const {
+    return running;
+}
+
+int FrameSink::getWidth() const {
+    return width;
+}
+
+int FrameSink::getHeight() const {
+    return height;
+}
+
+int FrameSink::getFrames() const {
+    return frames;
+}
+
+FrameSink* FrameSink::create(FrameSinkType type, int threads) {
+    switch (type) {
+        case GIF_SINK:
+            return new GifRecorder(GIFRECORDER_QUEUE, threads);
+        case PNG_SINK:
+            return new ImageSequence(true, threads);
+        case PPM_SINK:
+            return new ImageSequence(false, threads);
+        case Y4M_SINK:
+            return new Y4mStream(threads);
+    }
+    return NULL;
+}
+
+bool FrameSink::parseType(const string& name, FrameSinkType& type) {
+    static const pair<const char*, FrameSinkType> names[] = {
+        {"gif", GIF_SINK}, {"png", PNG_SINK}, {"ppm", PPM_SINK}, {"y4m", Y4M_SINK}
+    };
+    for (const pair<const char*, FrameSinkType>& entry : names) {
+        if (name == entry.first) {
+            type = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameSink::flip(const uint8_t* source, uint8_t* destination, int width, int height) {
+    size_t row = (size_t)width * 4;
+    for (int y = 0; y < height; y ++) {
+        const uint8_t* from = source + (size_t)(height - 1 - y) * row;
+        uint8_t* to = destination + (size_t)y * row;
+        size_t x = 0;
+#ifdef FRAMESINK_SIMD
+        // 4 pixels per copy
+        for (; x + 16 <= row; x += 16) {
+            _mm_storeu_si128((__m128i*)(to + x), _mm_loadu_si128((const __m128i*)(from + x)));
+        }
+#endif
+        memcpy(to + x, from + x, row - x);
+    }
+}
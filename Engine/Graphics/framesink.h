@@ -0,0 +1,107 @@
+// Destination for recorded frames, encoded on a background thread
+#ifndef _FRAMESINK_H
+#define _FRAMESINK_H
+
+#include "../../common.h"
+
+// SSE2 is part of x86-64, so the row copies need no cpu detection
+#if defined(__SSE2__)
+#define FRAMESINK_SIMD
+#include <emmintrin.h>
+#endif
+
+enum FrameSinkType {
+    // one animated GIF (GifRecorder)
+    GIF_SINK,
+    // numbered PNG or PPM files, compressed across worker threads (ImageSequence)
+    PNG_SINK,
+    PPM_SINK,
+    // raw YUV4MPEG2 stream, to a file or standard output for piping into a video encoder (Y4mStream)
+    Y4M_SINK
+};
+
+class FrameSink {
+    public:
+        // @param buffers Number of frame buffers (frames captured while the encoder is that far behind wait for it)
+        FrameSink(int buffers);
+        virtual ~FrameSink();
+
+        /**
+         * Opens the output and starts the encoder thread
+         * @param path File to write (for sequences, the prefix each frame's number and extension are added to; "-" streams to standard output)
+         * @param fps Frames per second the output plays back at
+         * @return whether or not the output could be opened
+         */
+        virtual bool open(const string& path, int width, int height, int fps) = 0;
+        // encodes the frames still queued, then closes the output
+        // @return whether or not every frame was written
+        virtual bool close() = 0;
+
+        /**
+         * Buffer for the next frame: width * height RGBA pixels, bottom row first (as glReadPixels writes them)
+         * Waits while every buffer is queued for the encoder
+         */
+        uint8_t* acquire();
+        // queues the acquired frame for encoding
+        void submit();
+
+        bool isOpen() const;
+        int getWidth() const;
+        int getHeight() const;
+        // number of frames encoded so far
+        int getFrames() const;
+
+        /**
+         * Makes a sink of the given type (closed until open is called)
+         * @param threads Worker threads sequences compress on (0 for one per core)
+         */
+        static FrameSink* create(FrameSinkType type, int threads = 0);
+        // @return whether or not name is gif, png, ppm or y4m
+        static bool parseType(const string& name, FrameSinkType& type);
+        // copies an RGBA frame with its rows in reverse order (turns a bottom up capture into a top down image)
+        static void flip(const uint8_t* source, uint8_t* destination, int width, int height);
+
+    protected:
+        // starts the encoder thread (called by open once the output is ready)
+        void start(int width, int height);
+        // waits for the encoder to finish every queued frame and stops it
+        // @return whether or not every frame was encoded
+        bool finish();
+
+        /**
+         * Encodes a run of frames on the encoder thread, in the order they were captured
+         * @param frames Frames queued since the last run (their buffers are reused once this returns)
+         * @param first Number of the first frame in the run
+         * @return whether or not every frame was written
+         */
+        virtual bool encode(const vector<const uint8_t*>& frames, int first) = 0;
+
+        int width;
+        int height;
+
+    private:
+        // the encoder thread is owned, so copying would join it twice
+        FrameSink(const FrameSink&);
+        FrameSink& operator= (const FrameSink&);
+
+        void encodeLoop();
+
+        // frame buffers, the idle buffers free to capture into and the buffers waiting for the encoder (in capture order)
+        vector<vector<uint8_t>> buffers;
+        vector<int> idle;
+        deque<int> queued;
+        // buffer handed out by acquire (-1 if none)
+        int current;
+
+        std::mutex lock;
+        std::condition_variable changed;
+        std::thread encoder;
+        bool running;
+        bool stopping;
+        bool failed;
+        std::atomic<int> frames;
+};
+
+// FrameSink's definitions (in "framesink.cpp") are included by common.h once every sink is complete, as create makes them
+
+#endif
@@ -0,0 +1,259 @@
+#include "gifencoder.h"
+
+GifEncoder::GifEncoder(int threads) : jobs(threads > 0 ? threads : max((int)std::thread::hardware_concurrency(), 1)),
+    width(0), height(0), dither(true), bandRows(GIF_BAND_ROWS), tolerance(GIF_PALETTE_TOLERANCE), first(true), hasPalette(false), built(0), reused(0) {}
+
+void GifEncoder::reset(int width, int height) {
+    this->width = width;
+    this->height = height;
+    previous.clear();
+    first = true;
+    hasPalette = false;
+    paletteHistogram.clear();
+    built = 0;
+    reused = 0;
+}
+
+void GifEncoder::setDither(bool dither) {
+    this->dither = dither;
+}
+
+void GifEncoder::setBandRows(int rows) {
+    bandRows = max(rows, 0);
+}
+
+void GifEncoder::setPaletteTolerance(float tolerance) {
+    this->tolerance = tolerance;
+}
+
+int GifEncoder::getThreads() const {
+    return jobs.getThreads();
+}
+
+int GifEncoder::getPalettesBuilt() const {
+    return built;
+}
+
+int GifEncoder::getPalettesReused() const {
+    return reused;
+}
+
+float GifEncoder::distance(const vector<int>& a, const vector<int>& b) const {
+    long total = 0;
+    for (size_t i = 0; i < a.size(); i ++) {
+        total += abs(a[i] - b[i]);
+    }
+    return total / (2.0f * max(width * height, 1));
+}
+
+/**
+ * The run goes through its stages one after another, each spread over the job system:
+ * 1. frames are copied top down (and binned into coarse histograms when palettes are reused)
+ * 2. each frame keeps the last palette if its histogram is close to the one the palette was built for, or gets a new one
+ * 3. new palettes are built, one frame per job (when they do not depend on the last frame's output)
+ * 4. frames are quantized in bands, each band working through the run's frames in order, as a band only draws over the
+ *    same band of the frame before it
+ * 5. image blocks are compressed, one frame per job, and written in order
+ */
+bool GifEncoder::encode(const vector<const uint8_t*>& frames, bool bottomUp, uint32_t delay, FILE* file) {
+    int count = frames.size();
+    if (count == 0) {
+        return true;
+    }
+    size_t bytes = (size_t)width * height * 4;
+    bool reuse = tolerance >= 0;
+    images.resize(count);
+    histograms.resize(count);
+    palettes.resize(count);
+    outputs.resize(count);
+    blocks.resize(count);
+
+    jobs.parallelFor(count, [&](int i) {
+        images[i].resize(bytes);
+        outputs[i].resize(bytes);
+        if (bottomUp) {
+            FrameSink::flip(frames[i], images[i].data(), width, height);
+        } else {
+            memcpy(images[i].data(), frames[i], bytes);
+        }
+        if (reuse) {
+            const int shift = 8 - GIF_HISTOGRAM_BITS;
+            histograms[i].assign(1 << (3 * GIF_HISTOGRAM_BITS), 0);
+            const uint8_t* pixel = images[i].data();
+            for (int p = 0; p < width * height; p ++, pixel += 4) {
+                histograms[i][(pixel[0] >> shift) << (2 * GIF_HISTOGRAM_BITS) | (pixel[1] >> shift) << GIF_HISTOGRAM_BITS | pixel[2] >> shift]++;
+            }
+        }
+    });
+
+    // frame each frame takes its palette from (-1 for the palette of the last run)
+    vector<int> source(count);
+    int key = -1;
+    bool keyed = hasPalette;
+    for (int i = 0; i < count; i ++) {
+        const vector<int>& keyHistogram = key < 0 ? paletteHistogram : histograms[key];
+        if (reuse && keyed && distance(histograms[i], keyHistogram) <= tolerance) {
+            source[i] = key;
+            reused++;
+        } else {
+            source[i] = i;
+            key = i;
+            keyed = true;
+            built++;
+        }
+    }
+
+    // dithered palettes are made from whole frames, and so are reused ones (they have to fit more than the pixels that changed)
+    bool independent = dither || reuse;
+    if (independent) {
+        jobs.parallelFor(count, [&](int i) {
+            if (source[i] == i) {
+                // entries no pixels fall into are never written (gif.h leaves them as whatever was on the stack)
+                palettes[i] = GifPalette();
+                GifMakePalette(NULL, images[i].data(), width, height, 8, dither, &palettes[i]);
+            }
+        });
+        for (int i = 0; i < count; i ++) {
+            if (source[i] != i) {
+                palettes[i] = source[i] < 0 ? palette : palettes[source[i]];
+            }
+        }
+    }
+
+    int rows = bandRows > 0 ? bandRows : max(height, 1);
+    int bands = (height + rows - 1) / rows;
+    // quantizes a band of a frame over the output of the frame before it
+    auto quantize = [&](int i, int band) {
+        int top = band * rows;
+        int bottom = min(top + rows, height);
+        size_t offset = (size_t)top * width * 4;
+        const uint8_t* last = i > 0 ? outputs[i-1].data() : first ? NULL : previous.data();
+        if (dither) {
+            GifDitherImage(last ? last + offset : NULL, images[i].data() + offset, outputs[i].data() + offset, width, bottom - top, &palettes[i]);
+        } else {
+            GifThresholdImage(last ? last + offset : NULL, images[i].data() + offset, outputs[i].data() + offset, width, bottom - top, &palettes[i]);
+        }
+    };
+    if (independent) {
+        jobs.parallelFor(bands, [&](int band) {
+            for (int i = 0; i < count; i ++) {
+                quantize(i, band);
+            }
+        });
+    } else {
+        // each palette is made from the pixels that changed since the frame before, so it has to wait for that frame's output
+        for (int i = 0; i < count; i ++) {
+            const uint8_t* last = i > 0 ? outputs[i-1].data() : first ? NULL : previous.data();
+            palettes[i] = GifPalette();
+            GifMakePalette(last, images[i].data(), width, height, 8, false, &palettes[i]);
+            jobs.parallelFor(bands, [&](int band) {
+                quantize(i, band);
+            });
+        }
+    }
+
+    jobs.parallelFor(count, [&](int i) {
+        writeImage(outputs[i].data(), width, height, delay, palettes[i], blocks[i]);
+    });
+    bool written = true;
+    for (int i = 0; i < count; i ++) {
+        written = fwrite(blocks[i].data(), 1, blocks[i].size(), file) == blocks[i].size() && written;
+    }
+
+    previous.swap(outputs[count - 1]);
+    first = false;
+    palette = palettes[count - 1];
+    if (key >= 0) {
+        paletteHistogram = histograms[key];
+    }
+    hasPalette = true;
+    return written;
+}
+
+void GifEncoder::writeImage(const uint8_t* image, int width, int height, uint32_t delay, const GifPalette& palette, vector<uint8_t>& out) {
+    out.clear();
+    // graphics control extension: leave the last frame in place, with palette index 0 transparent
+    const uint8_t control[8] = {0x21, 0xf9, 0x04, 0x05, (uint8_t)(delay & 0xff), (uint8_t)((delay >> 8) & 0xff), (uint8_t)kGifTransIndex, 0};
+    out.insert(out.end(), control, control + 8);
+    // image descriptor covering the whole canvas, with a local color table of 2 ^ bitDepth entries
+    const uint8_t descriptor[10] = {0x2c, 0, 0, 0, 0, (uint8_t)(width & 0xff), (uint8_t)((width >> 8) & 0xff),
+                                    (uint8_t)(height & 0xff), (uint8_t)((height >> 8) & 0xff), (uint8_t)(0x80 + palette.bitDepth - 1)};
+    out.insert(out.end(), descriptor, descriptor + 10);
+    out.push_back(0);
+    out.push_back(0);
+    out.push_back(0);
+    for (int i = 1; i < (1 << palette.bitDepth); i ++) {
+        out.push_back(palette.r[i]);
+        out.push_back(palette.g[i]);
+        out.push_back(palette.b[i]);
+    }
+
+    const int minCodeSize = palette.bitDepth;
+    const uint32_t clearCode = 1 << palette.bitDepth;
+    out.push_back(minCodeSize);
+
+    // the dictionary is a 256-ary tree as in gif.h, but a node's children are only cleared when it is first used after the
+    // dictionary was reset (gif.h clears all 2 MB of it every time it fills)
+    vector<uint16_t> tree(4096 * 256);
+    vector<uint32_t> generation(4096, 0);
+    uint32_t current = 1;
+
+    vector<uint8_t> stream;
+    stream.reserve((size_t)width * height / 2);
+    uint64_t bits = 0;
+    int count = 0;
+    auto put = [&](uint32_t code, uint32_t length) {
+        bits |= (uint64_t)(code & ((1u << length) - 1)) << count;
+        count += length;
+        while (count >= 8) {
+            stream.push_back(bits & 0xFF);
+            bits >>= 8;
+            count -= 8;
+        }
+    };
+
+    int32_t curCode = -1;
+    uint32_t codeSize = minCodeSize + 1;
+    uint32_t maxCode = clearCode + 1;
+    put(clearCode, codeSize);
+    const uint8_t* pixel = image + 3;
+    for (int p = 0; p < width * height; p ++, pixel += 4) {
+        uint8_t value = *pixel;
+        if (curCode < 0) {
+            curCode = value;
+        } else if (generation[curCode] == current && tree[curCode * 256 + value]) {
+            curCode = tree[curCode * 256 + value];
+        } else {
+            put(curCode, codeSize);
+            if (generation[curCode] != current) {
+                memset(&tree[curCode * 256], 0, 256 * sizeof(uint16_t));
+                generation[curCode] = current;
+            }
+            tree[curCode * 256 + value] = ++maxCode;
+            if (maxCode >= (1u << codeSize)) {
+                codeSize++;
+            }
+            if (maxCode == 4095) {
+                put(clearCode, codeSize);
+                current++;
+                codeSize = minCodeSize + 1;
+                maxCode = clearCode + 1;
+            }
+            curCode = value;
+        }
+    }
+    put(curCode, codeSize);
+    put(clearCode, codeSize);
+    put(clearCode + 1, minCodeSize + 1);
+    if (count > 0) {
+        put(0, 8 - count);
+    }
+
+    // the stream is split into sub-blocks of at most 255 bytes, each led by its length
+    for (size_t start = 0; start < stream.size(); start += 255) {
+        size_t length = min(stream.size() - start, (size_t)255);
+        out.push_back(length);
+        out.insert(out.end(), stream.begin() + start, stream.begin() + start + length);
+    }
+    out.push_back(0);
+}
@@ -0,0 +1,87 @@
+// GIF frame encoder that quantizes and compresses runs of frames across worker threads
+#ifndef _GIFENCODER_H
+#define _GIFENCODER_H
+
+#include "../../common.h"
+
+// rows dithered together (error diffusion stops at the edge of a band, so bands of one frame can be dithered at once)
+#define GIF_BAND_ROWS 32
+// share of pixels whose coarse color can change before a frame stops reusing the last palette
+#define GIF_PALETTE_TOLERANCE 0.02f
+// bits kept per channel in the histograms palettes are compared by
+#define GIF_HISTOGRAM_BITS 4
+
+class GifEncoder {
+    public:
+        // @param threads Number of threads frames are encoded on (0 for one per core)
+        GifEncoder(int threads = 0);
+
+        // starts a new animation (the next frame has no previous frame to be drawn over)
+        void reset(int width, int height);
+
+        /**
+         * Whether frames are Floyd-Steinberg dithered to their palette
+         * Without dithering, palettes are built from the pixels that changed since the last frame, as GifWriteFrame does
+         */
+        void setDither(bool dither);
+        // @param rows Rows dithered together (0 dithers whole frames, exactly as GifWriteFrame does)
+        void setBandRows(int rows);
+        // @param tolerance Largest histogram change a frame can reuse the last palette across (negative to build every palette)
+        void setPaletteTolerance(float tolerance);
+
+        /**
+         * Encodes a run of frames in order and writes their image blocks, byte for byte as GifWriteFrame would with the same
+         * settings (whole frame bands, no palette reuse). The output only depends on the frames, never on how they are split
+         * into runs or on the number of threads
+         * @param frames width * height RGBA pixels each
+         * @param bottomUp Whether rows are stored bottom first, as glReadPixels writes them
+         * @param delay Time the frames are shown for in hundredths of a second
+         * @param file File opened by GifBegin
+         * @return whether or not every frame was written
+         */
+        bool encode(const vector<const uint8_t*>& frames, bool bottomUp, uint32_t delay, FILE* file);
+
+        int getThreads() const;
+        // palettes built and reused since the last reset
+        int getPalettesBuilt() const;
+        int getPalettesReused() const;
+
+        // image block of a palettized frame (indices in alpha), as GifWriteLzwImage writes it
+        static void writeImage(const uint8_t* image, int width, int height, uint32_t delay, const GifPalette& palette, vector<uint8_t>& out);
+
+    private:
+        // frames can only be encoded by one run at a time
+        GifEncoder(const GifEncoder&);
+        GifEncoder& operator= (const GifEncoder&);
+
+        // total variation between two histograms, as a share of the pixels
+        float distance(const vector<int>& a, const vector<int>& b) const;
+
+        JobSystem jobs;
+        int width;
+        int height;
+        bool dither;
+        int bandRows;
+        float tolerance;
+
+        // output of the last frame encoded (palette colors, with the index in alpha), which the next frame is drawn over
+        vector<uint8_t> previous;
+        bool first;
+        // palette the last frame used, and the histogram of the frame it was built for
+        GifPalette palette;
+        vector<int> paletteHistogram;
+        bool hasPalette;
+        int built;
+        int reused;
+
+        // per frame working space of a run: top down copies, histograms, palettes, outputs and image blocks
+        vector<vector<uint8_t>> images;
+        vector<vector<int>> histograms;
+        vector<GifPalette> palettes;
+        vector<vector<uint8_t>> outputs;
+        vector<vector<uint8_t>> blocks;
+};
+
+#include "gifencoder.cpp"
+
+#endif
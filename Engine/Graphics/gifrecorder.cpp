@@ -0,0 +1,49 @@
+#include "gifrecorder.h"
+
+GifRecorder::GifRecorder(int queue, int threads) : FrameSink(max(queue, 2 * (threads > 0 ? threads : (int)std::thread::hardware_concurrency()))),
+    encoder(threads), delay(0), recording(false) {
+    writer.f = NULL;
+    writer.oldImage = NULL;
+}
+
+GifRecorder::~GifRecorder() {
+    end();
+}
+
+bool GifRecorder::begin(const char* file, int width, int height, int delay, bool dither) {
+    end();
+    if (!GifBegin(&writer, file, width, height, delay, 8, dither)) {
+        return false;
+    }
+    this->delay = delay;
+    encoder.setDither(dither);
+    encoder.reset(width, height);
+    recording = true;
+    start(width, height);
+    return true;
+}
+
+bool GifRecorder::end() {
+    if (!recording) {
+        return false;
+    }
+    bool written = finish();
+    recording = false;
+    return GifEnd(&writer) && written;
+}
+
+bool GifRecorder::open(const string& path, int width, int height, int fps) {
+    return begin(path.c_str(), width, height, max((int)roundf(100.0f / max(fps, 1)), 1));
+}
+
+bool GifRecorder::close() {
+    return end();
+}
+
+GifEncoder& GifRecorder::getEncoder() {
+    return encoder;
+}
+
+bool GifRecorder::encode(const vector<const uint8_t*>& frames, int) {
+    return encoder.encode(frames, true, delay, writer.f);
+}
@@ -0,0 +1,49 @@
+// Records frames to a GIF, encoding them on a background thread
+#ifndef _GIFRECORDER_H
+#define _GIFRECORDER_H
+
+#include "../../common.h"
+
+// frames that can wait for the encoder before acquire blocks (at least two per encoder thread, so runs keep every thread busy)
+#define GIFRECORDER_QUEUE 4
+
+class GifRecorder : public FrameSink {
+    public:
+        /**
+         * @param queue Number of frame buffers (frames captured while the encoder is that far behind wait for it)
+         * @param threads Number of threads frames are encoded on (0 for one per core)
+         */
+        GifRecorder(int queue = GIFRECORDER_QUEUE, int threads = 0);
+        // finishes the GIF if it is still being recorded
+        ~GifRecorder();
+
+        /**
+         * Opens a GIF and starts the encoder thread
+         * @param delay Time between frames in hundredths of a second
+         * @param dither Whether gif.h dithers frames to their palette
+         * @return whether or not the file could be opened
+         */
+        bool begin(const char* file, int width, int height, int delay, bool dither = true);
+        // encodes the frames still queued, then closes the file
+        // @return whether or not every frame was written
+        bool end();
+
+        // begin with the delay closest to fps (GIF delays are in hundredths of a second)
+        bool open(const string& path, int width, int height, int fps);
+        bool close();
+
+        // band, palette reuse and thread settings (change them before begin)
+        GifEncoder& getEncoder();
+
+    private:
+        bool encode(const vector<const uint8_t*>& frames, int first);
+
+        GifWriter writer;
+        GifEncoder encoder;
+        int delay;
+        bool recording;
+};
+
+#include "gifrecorder.cpp"
+
+#endif
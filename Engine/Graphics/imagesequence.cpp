@@ -0,0 +1,67 @@
+#include "imagesequence.h"
+
+int ImageSequence_threads(int threads) {
+    return threads > 0 ? threads : max((int)std::thread::hardware_concurrency(), 1);
+}
+
+// two buffers per thread, so a full run can compress while the next one is captured
+ImageSequence::ImageSequence(bool png, int threads) : FrameSink(2 * ImageSequence_threads(threads)), png(png), jobs(ImageSequence_threads(threads)) {}
+
+ImageSequence::~ImageSequence() {
+    close();
+}
+
+bool ImageSequence::open(const string& path, int width, int height, int) {
+    close();
+    prefix = path;
+    start(width, height);
+    return true;
+}
+
+bool ImageSequence::close() {
+    return finish();
+}
+
+int ImageSequence::getThreads() const {
+    return jobs.getThreads();
+}
+
+string ImageSequence::getFile(int frame) const {
+    char number[16];
+    snprintf(number, sizeof(number), "%06d", frame);
+    return prefix + number + (png ? ".png" : ".ppm");
+}
+
+bool ImageSequence::encode(const vector<const uint8_t*>& frames, int first) {
+    std::atomic<bool> written(true);
+    jobs.parallelFor(frames.size(), [&](int i) {
+        vector<uint8_t> file;
+        if (png) {
+            PngEncoder::encode(frames[i], width, height, true, file);
+        } else {
+            char header[64];
+            int length = snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+            file.assign(header, header + length);
+            file.resize(length + (size_t)width * height * 3);
+            uint8_t* out = &file[length];
+            for (int y = 0; y < height; y ++) {
+                const uint8_t* row = frames[i] + (size_t)(height - 1 - y) * width * 4;
+                for (int x = 0; x < width; x ++) {
+                    *out++ = row[4*x+0];
+                    *out++ = row[4*x+1];
+                    *out++ = row[4*x+2];
+                }
+            }
+        }
+
+        string name = getFile(first + i);
+        FILE* out = fopen(name.c_str(), "wb");
+        if (!out || fwrite(file.data(), 1, file.size(), out) != file.size()) {
+            written = false;
+        }
+        if (out && fclose(out) != 0) {
+            written = false;
+        }
+    });
+    return written;
+}
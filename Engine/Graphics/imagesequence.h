@@ -0,0 +1,35 @@
+// Writes frames as numbered PNG or PPM files, compressed across worker threads
+#ifndef _IMAGESEQUENCE_H
+#define _IMAGESEQUENCE_H
+
+#include "../../common.h"
+
+class ImageSequence : public FrameSink {
+    public:
+        /**
+         * @param png Whether frames are written as PNG (otherwise as binary PPM, which is uncompressed)
+         * @param threads Number of threads frames are compressed on (0 for one per core)
+         */
+        ImageSequence(bool png, int threads = 0);
+        ~ImageSequence();
+
+        // frames go to path followed by the frame number (6 digits) and the extension, so the fps is ignored
+        bool open(const string& path, int width, int height, int fps);
+        bool close();
+
+        int getThreads() const;
+        // name of a frame's file
+        string getFile(int frame) const;
+
+    private:
+        // every frame queued since the last run is compressed and written by its own job
+        bool encode(const vector<const uint8_t*>& frames, int first);
+
+        bool png;
+        string prefix;
+        JobSystem jobs;
+};
+
+#include "imagesequence.cpp"
+
+#endif
@@ -0,0 +1,453 @@
+#include "packet.h"
+
+void Packet_clear(RayPacket& packet, float maxT) {
+    for (int i = 0; i < PACKET_SIZE; i ++) {
+        packet.ox[i] = 0; packet.oy[i] = 0; packet.oz[i] = 0;
+        packet.dx[i] = 0; packet.dy[i] = 0; packet.dz[i] = 1;
+        // nothing can be closer than 0, so padding lanes never record a hit
+        packet.t[i] = 0;
+        packet.obi[i] = -1;
+    }
+    packet.count = 0;
+    packet.maxT = maxT;
+}
+
+void Packet_addRay(RayPacket& packet, const vec3& ro, const vec3& rd) {
+    int i = packet.count ++;
+    packet.ox[i] = ro.X(); packet.oy[i] = ro.Y(); packet.oz[i] = ro.Z();
+    packet.dx[i] = rd.X(); packet.dy[i] = rd.Y(); packet.dz[i] = rd.Z();
+    packet.t[i] = packet.maxT;
+    packet.obi[i] = -1;
+}
+
+/*=======SCALAR KERNELS=======*/
+
+static void Packet_sphereScalar(RayPacket& p, const vec3& pos, float r, int index, float minT) {
+    for (int i = 0; i < p.count; i ++) {
+        float cx = pos.X() - p.ox[i];
+        float cy = pos.Y() - p.oy[i];
+        float cz = pos.Z() - p.oz[i];
+
+        float a = p.dx[i]*p.dx[i] + p.dy[i]*p.dy[i] + p.dz[i]*p.dz[i];
+        float nb = 2*(p.dx[i]*cx + p.dy[i]*cy + p.dz[i]*cz);
+        float c = cx*cx + cy*cy + cz*cz - r*r;
+        float disc = nb*nb - 4*a*c;
+        if (disc < 0) {
+            continue;
+        }
+
+        // the nearer root, unless it is behind the ray
+        float sq = sqrt(disc);
+        float t = (nb - sq) * (0.5f/a);
+        if (t < minT) {
+            t = (nb + sq) * (0.5f/a);
+        }
+        if (t >= minT && t < p.t[i]) {
+            p.t[i] = t;
+            p.obi[i] = index;
+        }
+    }
+}
+
+static void Packet_boxScalar(RayPacket& p, const vec3& pos, const vec3 axes[3], const float h[3], int index, float minT) {
+    for (int i = 0; i < p.count; i ++) {
+        float rx = p.ox[i] - pos.X();
+        float ry = p.oy[i] - pos.Y();
+        float rz = p.oz[i] - pos.Z();
+
+        float tnear = -numeric_limits<float>::infinity();
+        float tfar = numeric_limits<float>::infinity();
+        for (int k = 0; k < 3; k ++) {
+            float lo = rx*axes[k].X() + ry*axes[k].Y() + rz*axes[k].Z();
+            float ld = p.dx[i]*axes[k].X() + p.dy[i]*axes[k].Y() + p.dz[i]*axes[k].Z();
+            float inv = 1/ld;
+            float t1 = (-h[k] - lo)*inv;
+            float t2 = (h[k] - lo)*inv;
+            tnear = max(tnear, min(t1, t2));
+            tfar = min(tfar, max(t1, t2));
+        }
+
+        // rays starting inside the box hit its far side
+        float t = tnear > minT ? tnear : tfar;
+        if (tfar >= tnear && t > minT && t < p.t[i]) {
+            p.t[i] = t;
+            p.obi[i] = index;
+        }
+    }
+}
+
+static void Packet_capsuleScalar(RayPacket& p, const vec3& pa, const vec3& pb, float r, int index, float minT) {
+    vec3 ba = pb - pa;
+    float baba = vec3::dot(ba, ba);
+
+    for (int i = 0; i < p.count; i ++) {
+        vec3 ro = vec3(p.ox[i], p.oy[i], p.oz[i]);
+        vec3 rd = vec3(p.dx[i], p.dy[i], p.dz[i]);
+        vec3 oa = ro - pa;
+
+        float bard = vec3::dot(ba, rd);
+        float baoa = vec3::dot(ba, oa);
+        float rdoa = vec3::dot(rd, oa);
+        float oaoa = vec3::dot(oa, oa);
+
+        float a = baba      - bard*bard;
+        float b = baba*rdoa - baoa*bard;
+        float c = baba*oaoa - baoa*baoa - r*r*baba;
+        float h = b*b - a*c;
+        if (h < 0) {
+            continue;
+        }
+
+        // body
+        float t = (-b - sqrt(h))/a;
+        float y = baoa + t*bard;
+        if (y > 0 && y < baba && t < p.t[i] && t > minT) {
+            p.t[i] = t;
+            p.obi[i] = index;
+        }
+
+        // caps
+        vec3 oc = y <= 0 ? oa : ro - pb;
+        b = vec3::dot(rd, oc);
+        c = vec3::dot(oc, oc) - r*r;
+        h = b*b - c;
+        if (h > 0) {
+            t = -b - sqrt(h);
+            if (t < p.t[i] && t > minT) {
+                p.t[i] = t;
+                p.obi[i] = index;
+            }
+        }
+    }
+}
+
+#ifdef SIMD_X86
+
+/*=======SSE KERNELS (4 lanes, starting at lane o)=======*/
+
+// mask ? b : a
+SSE_TARGET static inline __m128 Packet_select(__m128 a, __m128 b, __m128 mask) {
+    return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+}
+
+SSE_TARGET static inline __m128 Packet_dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+SSE_TARGET static inline void Packet_update(RayPacket& p, int o, __m128 t, __m128 mask, int index) {
+    __m128 obi = _mm_castsi128_ps(_mm_load_si128((const __m128i*)(p.obi + o)));
+    _mm_store_ps(p.t + o, Packet_select(_mm_load_ps(p.t + o), t, mask));
+    _mm_store_si128((__m128i*)(p.obi + o), _mm_castps_si128(Packet_select(obi, _mm_castsi128_ps(_mm_set1_epi32(index)), mask)));
+}
+
+SSE_TARGET static void Packet_sphereSSE(RayPacket& p, int o, const vec3& pos, float r, int index, float minT) {
+    __m128 dx = _mm_load_ps(p.dx + o);
+    __m128 dy = _mm_load_ps(p.dy + o);
+    __m128 dz = _mm_load_ps(p.dz + o);
+    __m128 cx = _mm_sub_ps(_mm_set1_ps(pos.X()), _mm_load_ps(p.ox + o));
+    __m128 cy = _mm_sub_ps(_mm_set1_ps(pos.Y()), _mm_load_ps(p.oy + o));
+    __m128 cz = _mm_sub_ps(_mm_set1_ps(pos.Z()), _mm_load_ps(p.oz + o));
+
+    __m128 a = Packet_dot(dx, dy, dz, dx, dy, dz);
+    __m128 nb = _mm_mul_ps(_mm_set1_ps(2), Packet_dot(dx, dy, dz, cx, cy, cz));
+    __m128 c = _mm_sub_ps(Packet_dot(cx, cy, cz, cx, cy, cz), _mm_set1_ps(r*r));
+    __m128 disc = _mm_sub_ps(_mm_mul_ps(nb, nb), _mm_mul_ps(_mm_set1_ps(4), _mm_mul_ps(a, c)));
+
+    __m128 sq = _mm_sqrt_ps(_mm_max_ps(disc, _mm_setzero_ps()));
+    __m128 inv = _mm_div_ps(_mm_set1_ps(0.5f), a);
+    __m128 vminT = _mm_set1_ps(minT);
+    __m128 t = _mm_mul_ps(_mm_sub_ps(nb, sq), inv);
+    t = Packet_select(_mm_mul_ps(_mm_add_ps(nb, sq), inv), t, _mm_cmpge_ps(t, vminT));
+
+    __m128 mask = _mm_and_ps(_mm_cmpge_ps(disc, _mm_setzero_ps()), _mm_and_ps(_mm_cmpge_ps(t, vminT), _mm_cmplt_ps(t, _mm_load_ps(p.t + o))));
+    Packet_update(p, o, t, mask, index);
+}
+
+SSE_TARGET static void Packet_boxSSE(RayPacket& p, int o, const vec3& pos, const vec3 axes[3], const float h[3], int index, float minT) {
+    __m128 dx = _mm_load_ps(p.dx + o);
+    __m128 dy = _mm_load_ps(p.dy + o);
+    __m128 dz = _mm_load_ps(p.dz + o);
+    __m128 rx = _mm_sub_ps(_mm_load_ps(p.ox + o), _mm_set1_ps(pos.X()));
+    __m128 ry = _mm_sub_ps(_mm_load_ps(p.oy + o), _mm_set1_ps(pos.Y()));
+    __m128 rz = _mm_sub_ps(_mm_load_ps(p.oz + o), _mm_set1_ps(pos.Z()));
+
+    __m128 tnear = _mm_set1_ps(-numeric_limits<float>::infinity());
+    __m128 tfar = _mm_set1_ps(numeric_limits<float>::infinity());
+    for (int k = 0; k < 3; k ++) {
+        __m128 axx = _mm_set1_ps(axes[k].X());
+        __m128 axy = _mm_set1_ps(axes[k].Y());
+        __m128 axz = _mm_set1_ps(axes[k].Z());
+        __m128 lo = Packet_dot(rx, ry, rz, axx, axy, axz);
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1), Packet_dot(dx, dy, dz, axx, axy, axz));
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(-h[k]), lo), inv);
+        __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(h[k]), lo), inv);
+        tnear = _mm_max_ps(tnear, _mm_min_ps(t1, t2));
+        tfar = _mm_min_ps(tfar, _mm_max_ps(t1, t2));
+    }
+
+    __m128 vminT = _mm_set1_ps(minT);
+    __m128 t = Packet_select(tfar, tnear, _mm_cmpgt_ps(tnear, vminT));
+    __m128 mask = _mm_and_ps(_mm_cmpge_ps(tfar, tnear), _mm_and_ps(_mm_cmpgt_ps(t, vminT), _mm_cmplt_ps(t, _mm_load_ps(p.t + o))));
+    Packet_update(p, o, t, mask, index);
+}
+
+SSE_TARGET static void Packet_capsuleSSE(RayPacket& p, int o, const vec3& pa, const vec3& pb, float r, int index, float minT) {
+    vec3 ba = pb - pa;
+    __m128 bax = _mm_set1_ps(ba.X());
+    __m128 bay = _mm_set1_ps(ba.Y());
+    __m128 baz = _mm_set1_ps(ba.Z());
+    __m128 baba = _mm_set1_ps(vec3::dot(ba, ba));
+    __m128 rr = _mm_set1_ps(r*r);
+    __m128 zero = _mm_setzero_ps();
+    __m128 vminT = _mm_set1_ps(minT);
+
+    __m128 dx = _mm_load_ps(p.dx + o);
+    __m128 dy = _mm_load_ps(p.dy + o);
+    __m128 dz = _mm_load_ps(p.dz + o);
+    __m128 ox = _mm_load_ps(p.ox + o);
+    __m128 oy = _mm_load_ps(p.oy + o);
+    __m128 oz = _mm_load_ps(p.oz + o);
+    __m128 oax = _mm_sub_ps(ox, _mm_set1_ps(pa.X()));
+    __m128 oay = _mm_sub_ps(oy, _mm_set1_ps(pa.Y()));
+    __m128 oaz = _mm_sub_ps(oz, _mm_set1_ps(pa.Z()));
+
+    __m128 bard = Packet_dot(bax, bay, baz, dx, dy, dz);
+    __m128 baoa = Packet_dot(bax, bay, baz, oax, oay, oaz);
+    __m128 rdoa = Packet_dot(dx, dy, dz, oax, oay, oaz);
+    __m128 oaoa = Packet_dot(oax, oay, oaz, oax, oay, oaz);
+
+    __m128 a = _mm_sub_ps(baba, _mm_mul_ps(bard, bard));
+    __m128 b = _mm_sub_ps(_mm_mul_ps(baba, rdoa), _mm_mul_ps(baoa, bard));
+    __m128 c = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(baba, oaoa), _mm_mul_ps(baoa, baoa)), _mm_mul_ps(rr, baba));
+    __m128 h = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+    __m128 valid = _mm_cmpge_ps(h, zero);
+
+    // body
+    __m128 best = _mm_load_ps(p.t + o);
+    __m128 t = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(h, zero))), a);
+    __m128 y = _mm_add_ps(baoa, _mm_mul_ps(t, bard));
+    __m128 mask = _mm_and_ps(valid, _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(y, zero), _mm_cmplt_ps(y, baba)), _mm_and_ps(_mm_cmplt_ps(t, best), _mm_cmpgt_ps(t, vminT))));
+    Packet_update(p, o, t, mask, index);
+
+    // caps
+    __m128 below = _mm_cmple_ps(y, zero);
+    __m128 ocx = Packet_select(_mm_sub_ps(ox, _mm_set1_ps(pb.X())), oax, below);
+    __m128 ocy = Packet_select(_mm_sub_ps(oy, _mm_set1_ps(pb.Y())), oay, below);
+    __m128 ocz = Packet_select(_mm_sub_ps(oz, _mm_set1_ps(pb.Z())), oaz, below);
+    b = Packet_dot(dx, dy, dz, ocx, ocy, ocz);
+    c = _mm_sub_ps(Packet_dot(ocx, ocy, ocz, ocx, ocy, ocz), rr);
+    h = _mm_sub_ps(_mm_mul_ps(b, b), c);
+    t = _mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(h, zero)));
+    best = _mm_load_ps(p.t + o);
+    mask = _mm_and_ps(_mm_and_ps(valid, _mm_cmpgt_ps(h, zero)), _mm_and_ps(_mm_cmplt_ps(t, best), _mm_cmpgt_ps(t, vminT)));
+    Packet_update(p, o, t, mask, index);
+}
+
+/*=======AVX2 KERNELS (8 lanes)=======*/
+
+AVX2_TARGET static inline __m256 Packet_dot(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz) {
+    return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+}
+
+AVX2_TARGET static inline void Packet_update(RayPacket& p, __m256 t, __m256 mask, int index) {
+    __m256i obi = _mm256_load_si256((const __m256i*)p.obi);
+    _mm256_store_ps(p.t, _mm256_blendv_ps(_mm256_load_ps(p.t), t, mask));
+    _mm256_store_si256((__m256i*)p.obi, _mm256_blendv_epi8(obi, _mm256_set1_epi32(index), _mm256_castps_si256(mask)));
+}
+
+AVX2_TARGET static void Packet_sphereAVX2(RayPacket& p, const vec3& pos, float r, int index, float minT) {
+    __m256 dx = _mm256_load_ps(p.dx);
+    __m256 dy = _mm256_load_ps(p.dy);
+    __m256 dz = _mm256_load_ps(p.dz);
+    __m256 cx = _mm256_sub_ps(_mm256_set1_ps(pos.X()), _mm256_load_ps(p.ox));
+    __m256 cy = _mm256_sub_ps(_mm256_set1_ps(pos.Y()), _mm256_load_ps(p.oy));
+    __m256 cz = _mm256_sub_ps(_mm256_set1_ps(pos.Z()), _mm256_load_ps(p.oz));
+
+    __m256 a = Packet_dot(dx, dy, dz, dx, dy, dz);
+    __m256 nb = _mm256_mul_ps(_mm256_set1_ps(2), Packet_dot(dx, dy, dz, cx, cy, cz));
+    __m256 c = _mm256_sub_ps(Packet_dot(cx, cy, cz, cx, cy, cz), _mm256_set1_ps(r*r));
+    __m256 disc = _mm256_sub_ps(_mm256_mul_ps(nb, nb), _mm256_mul_ps(_mm256_set1_ps(4), _mm256_mul_ps(a, c)));
+
+    __m256 sq = _mm256_sqrt_ps(_mm256_max_ps(disc, _mm256_setzero_ps()));
+    __m256 inv = _mm256_div_ps(_mm256_set1_ps(0.5f), a);
+    __m256 vminT = _mm256_set1_ps(minT);
+    __m256 t = _mm256_mul_ps(_mm256_sub_ps(nb, sq), inv);
+    t = _mm256_blendv_ps(_mm256_mul_ps(_mm256_add_ps(nb, sq), inv), t, _mm256_cmp_ps(t, vminT, _CMP_GE_OQ));
+
+    __m256 mask = _mm256_and_ps(_mm256_cmp_ps(disc, _mm256_setzero_ps(), _CMP_GE_OQ), _mm256_and_ps(_mm256_cmp_ps(t, vminT, _CMP_GE_OQ), _mm256_cmp_ps(t, _mm256_load_ps(p.t), _CMP_LT_OQ)));
+    Packet_update(p, t, mask, index);
+}
+
+AVX2_TARGET static void Packet_boxAVX2(RayPacket& p, const vec3& pos, const vec3 axes[3], const float h[3], int index, float minT) {
+    __m256 dx = _mm256_load_ps(p.dx);
+    __m256 dy = _mm256_load_ps(p.dy);
+    __m256 dz = _mm256_load_ps(p.dz);
+    __m256 rx = _mm256_sub_ps(_mm256_load_ps(p.ox), _mm256_set1_ps(pos.X()));
+    __m256 ry = _mm256_sub_ps(_mm256_load_ps(p.oy), _mm256_set1_ps(pos.Y()));
+    __m256 rz = _mm256_sub_ps(_mm256_load_ps(p.oz), _mm256_set1_ps(pos.Z()));
+
+    __m256 tnear = _mm256_set1_ps(-numeric_limits<float>::infinity());
+    __m256 tfar = _mm256_set1_ps(numeric_limits<float>::infinity());
+    for (int k = 0; k < 3; k ++) {
+        __m256 axx = _mm256_set1_ps(axes[k].X());
+        __m256 axy = _mm256_set1_ps(axes[k].Y());
+        __m256 axz = _mm256_set1_ps(axes[k].Z());
+        __m256 lo = Packet_dot(rx, ry, rz, axx, axy, axz);
+        __m256 inv = _mm256_div_ps(_mm256_set1_ps(1), Packet_dot(dx, dy, dz, axx, axy, axz));
+        __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(-h[k]), lo), inv);
+        __m256 t2 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(h[k]), lo), inv);
+        tnear = _mm256_max_ps(tnear, _mm256_min_ps(t1, t2));
+        tfar = _mm256_min_ps(tfar, _mm256_max_ps(t1, t2));
+    }
+
+    __m256 vminT = _mm256_set1_ps(minT);
+    __m256 t = _mm256_blendv_ps(tfar, tnear, _mm256_cmp_ps(tnear, vminT, _CMP_GT_OQ));
+    __m256 mask = _mm256_and_ps(_mm256_cmp_ps(tfar, tnear, _CMP_GE_OQ), _mm256_and_ps(_mm256_cmp_ps(t, vminT, _CMP_GT_OQ), _mm256_cmp_ps(t, _mm256_load_ps(p.t), _CMP_LT_OQ)));
+    Packet_update(p, t, mask, index);
+}
+
+AVX2_TARGET static void Packet_capsuleAVX2(RayPacket& p, const vec3& pa, const vec3& pb, float r, int index, float minT) {
+    vec3 ba = pb - pa;
+    __m256 bax = _mm256_set1_ps(ba.X());
+    __m256 bay = _mm256_set1_ps(ba.Y());
+    __m256 baz = _mm256_set1_ps(ba.Z());
+    __m256 baba = _mm256_set1_ps(vec3::dot(ba, ba));
+    __m256 rr = _mm256_set1_ps(r*r);
+    __m256 zero = _mm256_setzero_ps();
+    __m256 vminT = _mm256_set1_ps(minT);
+
+    __m256 dx = _mm256_load_ps(p.dx);
+    __m256 dy = _mm256_load_ps(p.dy);
+    __m256 dz = _mm256_load_ps(p.dz);
+    __m256 ox = _mm256_load_ps(p.ox);
+    __m256 oy = _mm256_load_ps(p.oy);
+    __m256 oz = _mm256_load_ps(p.oz);
+    __m256 oax = _mm256_sub_ps(ox, _mm256_set1_ps(pa.X()));
+    __m256 oay = _mm256_sub_ps(oy, _mm256_set1_ps(pa.Y()));
+    __m256 oaz = _mm256_sub_ps(oz, _mm256_set1_ps(pa.Z()));
+
+    __m256 bard = Packet_dot(bax, bay, baz, dx, dy, dz);
+    __m256 baoa = Packet_dot(bax, bay, baz, oax, oay, oaz);
+    __m256 rdoa = Packet_dot(dx, dy, dz, oax, oay, oaz);
+    __m256 oaoa = Packet_dot(oax, oay, oaz, oax, oay, oaz);
+
+    __m256 a = _mm256_sub_ps(baba, _mm256_mul_ps(bard, bard));
+    __m256 b = _mm256_sub_ps(_mm256_mul_ps(baba, rdoa), _mm256_mul_ps(baoa, bard));
+    __m256 c = _mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(baba, oaoa), _mm256_mul_ps(baoa, baoa)), _mm256_mul_ps(rr, baba));
+    __m256 h = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+    __m256 valid = _mm256_cmp_ps(h, zero, _CMP_GE_OQ);
+
+    // body
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b), _mm256_sqrt_ps(_mm256_max_ps(h, zero))), a);
+    __m256 y = _mm256_add_ps(baoa, _mm256_mul_ps(t, bard));
+    __m256 mask = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_GT_OQ), _mm256_cmp_ps(y, baba, _CMP_LT_OQ)), _mm256_and_ps(_mm256_cmp_ps(t, _mm256_load_ps(p.t), _CMP_LT_OQ), _mm256_cmp_ps(t, vminT, _CMP_GT_OQ)));
+    Packet_update(p, t, _mm256_and_ps(valid, mask), index);
+
+    // caps
+    __m256 below = _mm256_cmp_ps(y, zero, _CMP_LE_OQ);
+    __m256 ocx = _mm256_blendv_ps(_mm256_sub_ps(ox, _mm256_set1_ps(pb.X())), oax, below);
+    __m256 ocy = _mm256_blendv_ps(_mm256_sub_ps(oy, _mm256_set1_ps(pb.Y())), oay, below);
+    __m256 ocz = _mm256_blendv_ps(_mm256_sub_ps(oz, _mm256_set1_ps(pb.Z())), oaz, below);
+    b = Packet_dot(dx, dy, dz, ocx, ocy, ocz);
+    c = _mm256_sub_ps(Packet_dot(ocx, ocy, ocz, ocx, ocy, ocz), rr);
+    h = _mm256_sub_ps(_mm256_mul_ps(b, b), c);
+    t = _mm256_sub_ps(_mm256_sub_ps(zero, b), _mm256_sqrt_ps(_mm256_max_ps(h, zero)));
+    mask = _mm256_and_ps(_mm256_and_ps(valid, _mm256_cmp_ps(h, zero, _CMP_GT_OQ)), _mm256_and_ps(_mm256_cmp_ps(t, _mm256_load_ps(p.t), _CMP_LT_OQ), _mm256_cmp_ps(t, vminT, _CMP_GT_OQ)));
+    Packet_update(p, t, mask, index);
+}
+
+#endif
+
+/**
+ * Prepares shapes for the packet kernels
+ */
+void Packet_prepare(const float* data, int size, int width, vector<PacketShape>& shapes) {
+    shapes.clear();
+    for (int k = 0; k < size; k ++) {
+        const float* shape = data + k*width;
+        PacketShape prepared;
+        prepared.type = (int)shape[0];
+        prepared.index = k;
+        prepared.pos = vec3(shape[1], shape[2], shape[3]);
+        vec4 rot = vec4(shape[4], shape[5], shape[6], shape[7]);
+
+        switch (prepared.type) {
+            case 0: // sphere
+                prepared.r = shape[8];
+                break;
+            case 1: { // box, tested in its own frame
+                prepared.axes[0] = vec3::rotate(vec3(1, 0, 0), rot);
+                prepared.axes[1] = vec3::rotate(vec3(0, 1, 0), rot);
+                prepared.axes[2] = vec3::rotate(vec3(0, 0, 1), rot);
+                // quaternions are not always normalized, which scales the rotated axes (and the box the shader draws) by |rot|^2
+                float s = vec3::dot(prepared.axes[0], prepared.axes[0]);
+                for (int i = 0; i < 3; i ++) {
+                    prepared.h[i] = shape[8+i]*s;
+                }
+                break;
+            }
+            case 2: // capsule
+                prepared.pa = prepared.pos + vec3::rotate(vec3(0, shape[8], 0), rot);
+                prepared.pb = prepared.pos + vec3::rotate(vec3(0, -shape[8], 0), rot);
+                prepared.r = shape[9];
+                break;
+            default:
+                continue;
+        }
+        shapes.push_back(prepared);
+    }
+}
+
+void Packet_intersect(RayPacket& packet, const vector<PacketShape>& shapes, float minT, SimdPath path) {
+    static const SimdPath supported = Simd_detectPath();
+    if (path > supported) {
+        path = supported;
+    }
+
+    for (const PacketShape& shape : shapes) {
+        switch (shape.type) {
+            case 0: // sphere
+#ifdef SIMD_X86
+                if (path == SIMD_AVX2) {
+                    Packet_sphereAVX2(packet, shape.pos, shape.r, shape.index, minT);
+                    break;
+                }
+                if (path == SIMD_SSE) {
+                    Packet_sphereSSE(packet, 0, shape.pos, shape.r, shape.index, minT);
+                    Packet_sphereSSE(packet, 4, shape.pos, shape.r, shape.index, minT);
+                    break;
+                }
+#endif
+                Packet_sphereScalar(packet, shape.pos, shape.r, shape.index, minT);
+                break;
+            case 1: // box
+#ifdef SIMD_X86
+                if (path == SIMD_AVX2) {
+                    Packet_boxAVX2(packet, shape.pos, shape.axes, shape.h, shape.index, minT);
+                    break;
+                }
+                if (path == SIMD_SSE) {
+                    Packet_boxSSE(packet, 0, shape.pos, shape.axes, shape.h, shape.index, minT);
+                    Packet_boxSSE(packet, 4, shape.pos, shape.axes, shape.h, shape.index, minT);
+                    break;
+                }
+#endif
+                Packet_boxScalar(packet, shape.pos, shape.axes, shape.h, shape.index, minT);
+                break;
+            case 2: // capsule
+#ifdef SIMD_X86
+                if (path == SIMD_AVX2) {
+                    Packet_capsuleAVX2(packet, shape.pa, shape.pb, shape.r, shape.index, minT);
+                    break;
+                }
+                if (path == SIMD_SSE) {
+                    Packet_capsuleSSE(packet, 0, shape.pa, shape.pb, shape.r, shape.index, minT);
+                    Packet_capsuleSSE(packet, 4, shape.pa, shape.pb, shape.r, shape.index, minT);
+                    break;
+                }
+#endif
+                Packet_capsuleScalar(packet, shape.pa, shape.pb, shape.r, shape.index, minT);
+                break;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+// SIMD ray packets for the CPU tracer
+#ifndef _PACKET_H
+#define _PACKET_H
+
+#include "../../common.h"
+
+// number of rays in a packet
+#define PACKET_SIZE 8
+
+// rays stored as a structure of arrays, one register wide per component
+struct RayPacket {
+    alignas(32) float ox[PACKET_SIZE];
+    alignas(32) float oy[PACKET_SIZE];
+    alignas(32) float oz[PACKET_SIZE];
+    alignas(32) float dx[PACKET_SIZE];
+    alignas(32) float dy[PACKET_SIZE];
+    alignas(32) float dz[PACKET_SIZE];
+
+    // closest hit of each ray (obi is -1 if nothing was hit)
+    alignas(32) float t[PACKET_SIZE];
+    alignas(32) int obi[PACKET_SIZE];
+
+    // number of lanes holding rays (the rest are padding and never hit anything)
+    int count;
+    float maxT;
+};
+
+// a shape from the shader_data layout, with the values the kernels need worked out once per scene
+struct PacketShape {
+    // 0 sphere, 1 box, 2 capsule
+    int type;
+    // index of the shape in the shader_data layout
+    int index;
+    // center of a sphere or box
+    vec3 pos;
+    // radius of a sphere or capsule
+    float r;
+    // rotated axes and half extents of a box
+    vec3 axes[3];
+    float h[3];
+    // segment ends of a capsule
+    vec3 pa;
+    vec3 pb;
+};
+
+// empties a packet, padding every lane with a ray that misses (rays added later are limited to maxT)
+void Packet_clear(RayPacket& packet, float maxT);
+void Packet_addRay(RayPacket& packet, const vec3& ro, const vec3& rd);
+
+/**
+ * Prepares the shapes of a buffer in the shader_data layout for Packet_intersect (meshes are skipped, the tracer walks their BVH per ray)
+ * @param data Shapes in the shader_data layout
+ * @param size Number of shapes
+ * @param width Number of floats per shape
+ * @param shapes Result
+ */
+void Packet_prepare(const float* data, int size, int width, vector<PacketShape>& shapes);
+
+/**
+ * Finds the closest sphere, box or capsule hit by each ray of a packet
+ * Spheres and capsules are solved as quadratics and boxes with a slab test in the box's frame, so hits agree with
+ * the shader's routines up to rounding
+ * @param packet Rays to intersect, with t and obi set to the closest hit so far
+ * @param shapes Shapes prepared by Packet_prepare
+ * @param minT Hits closer than this are ignored
+ * @param path Kernels to use (falls back to the widest supported path)
+ */
+void Packet_intersect(RayPacket& packet, const vector<PacketShape>& shapes, float minT, SimdPath path);
+
+#include "packet.cpp"
+
+#endif
\ No newline at end of file
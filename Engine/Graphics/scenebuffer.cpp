@@ -0,0 +1,235 @@
+#include "scenebuffer.h"
+
+SceneBuffer::SceneBuffer(int capacity) : capacity(max(capacity, 1)), minCapacity(max(capacity, 1)), updates(0), posed(false), invalid(true), changed(0) {
+    header.res[0] = 0;
+    header.res[1] = 0;
+    header.size = 0;
+    header.width = WIDTH;
+    data.assign(this->capacity * WIDTH, 0);
+#ifndef HEADLESS
+    ssbo = 0;
+    gpuCapacity = 0;
+    persistent = false;
+    mapped = NULL;
+    regionSize = 0;
+    region = 0;
+    for (int r = 0; r < SCENE_REGIONS; r ++) {
+        written[r] = 0;
+        fences[r] = 0;
+    }
+#endif
+}
+
+SceneBuffer::~SceneBuffer() {
+#ifndef HEADLESS
+    release();
+#endif
+}
+
+void SceneBuffer::setResolution(float x, float y) {
+    header.res[0] = x;
+    header.res[1] = y;
+}
+
+void SceneBuffer::update(const vector<Shape*>& shapes) {
+    update(shapes, NULL);
+}
+
+void SceneBuffer::update(const World& world) {
+    update(world.getShapes(), &world);
+}
+
+void SceneBuffer::update(const vector<Shape*>& shapes, const World* world) {
+    int size = shapes.size();
+    int resized = capacity;
+    while (resized < size) {
+        resized *= 2;
+    }
+    while (resized / 2 >= minCapacity && size * 4 <= resized) {
+        resized /= 2;
+    }
+    if (resized != capacity) {
+        capacity = resized;
+        data.resize(capacity * WIDTH);
+    }
+
+    // a different list puts other shapes (or bodies) in the slots, so their revisions say nothing
+    // and switching between body state and render poses changes what the revisions count
+    bool all = invalid || posed != (world != NULL) || (int)this->shapes.size() != size || !equal(shapes.begin(), shapes.end(), this->shapes.begin());
+    if (all) {
+        this->shapes.assign(shapes.begin(), shapes.end());
+        revisions.assign(size, 0);
+        changedAt.assign(size, 0);
+        posed = world != NULL;
+        invalid = false;
+    }
+
+    updates++;
+    changed = 0;
+    for (int i = 0; i < size; i ++) {
+        // both revisions only grow, so their sum changes whenever either does
+        unsigned int revision = shapes[i]->getRevision() + (world ? world->getRenderRevision(shapes[i]->getBody()) : 0);
+        if (all || revision != revisions[i]) {
+            parse(i, *shapes[i], world);
+            revisions[i] = revision;
+            changedAt[i] = updates;
+            changed++;
+        }
+    }
+    header.size = size;
+}
+
+// Parses a shape into its slot
+void SceneBuffer::parse(int index, const Shape& shape, const World* world) {
+    vector<float> parsed = shape.parseData();
+    float* slot = &data[index * WIDTH];
+    // shapes parse to at most WIDTH floats, anything past that would spill into the next shape
+    int k = 0;
+    for (; k < (int)parsed.size() && k < WIDTH; k ++) {
+        slot[k] = parsed[k];
+    }
+    for (; k < WIDTH; k ++) {
+        slot[k] = 0;
+    }
+    // every shape keeps its center in columns 1 to 3 and its rotation in 4 to 7
+    if (world && WIDTH >= 8) {
+        const vec3& position = world->getRenderPosition(shape.getBody());
+        const vec4& orientation = world->getRenderOrientation(shape.getBody());
+        slot[1] = position.X();
+        slot[2] = position.Y();
+        slot[3] = position.Z();
+        slot[4] = orientation.X();
+        slot[5] = orientation.Y();
+        slot[6] = orientation.Z();
+        slot[7] = orientation.W();
+    }
+}
+
+void SceneBuffer::invalidate() {
+    invalid = true;
+}
+
+const SceneHeader& SceneBuffer::getHeader() const {
+    return header;
+}
+
+const float* SceneBuffer::getData() const {
+    return data.data();
+}
+
+int SceneBuffer::getSize() const {
+    return header.size;
+}
+
+int SceneBuffer::getCapacity() const {
+    return capacity;
+}
+
+int SceneBuffer::getChanged() const {
+    return changed;
+}
+
+#ifndef HEADLESS
+size_t SceneBuffer::upload() {
+    if (gpuCapacity != capacity) {
+        release();
+        glGenBuffers(1, &ssbo);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+        size_t bytes = sizeof(SceneHeader) + capacity * WIDTH * sizeof(float);
+
+        persistent = false;
+        if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) {
+            GLint alignment = 1;
+            glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+            alignment = max(alignment, 1);
+            regionSize = (bytes + alignment - 1) / alignment * alignment;
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_SHADER_STORAGE_BUFFER, regionSize * SCENE_REGIONS, NULL, flags);
+            mapped = (char*)glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, regionSize * SCENE_REGIONS, flags);
+            persistent = mapped != NULL;
+            if (!persistent) {
+                // buffer storage is immutable, so the fallback needs a buffer of its own
+                glDeleteBuffers(1, &ssbo);
+                glGenBuffers(1, &ssbo);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+            }
+        }
+        if (!persistent) {
+            regionSize = bytes;
+            glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, NULL, GL_DYNAMIC_DRAW);
+        }
+        gpuCapacity = capacity;
+        region = 0;
+    } else {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+        if (persistent) {
+            // the frame drawn since the last upload read the last region, the next one is free once the frame that read it is done
+            fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region = (region + 1) % SCENE_REGIONS;
+            if (fences[region]) {
+                GLenum status = GL_TIMEOUT_EXPIRED;
+                while (status == GL_TIMEOUT_EXPIRED) {
+                    status = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                }
+                glDeleteSync(fences[region]);
+                fences[region] = 0;
+            }
+        }
+    }
+
+    size_t bytes = sizeof(SceneHeader);
+    write(region, 0, &header, sizeof(SceneHeader));
+    // runs of shapes that changed since this region was last written are copied together
+    unsigned int since = written[region];
+    for (int i = 0; i < header.size;) {
+        if (changedAt[i] <= since) {
+            i ++;
+            continue;
+        }
+        int end = i + 1;
+        while (end < header.size && changedAt[end] > since) {
+            end ++;
+        }
+        size_t length = (end - i) * WIDTH * sizeof(float);
+        write(region, sizeof(SceneHeader) + i * WIDTH * sizeof(float), &data[i * WIDTH], length);
+        bytes += length;
+        i = end;
+    }
+    written[region] = updates;
+
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, SCENE_BINDING, ssbo, region * regionSize, regionSize);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return bytes;
+}
+
+void SceneBuffer::write(int region, size_t offset, const void* source, size_t bytes) {
+    if (persistent) {
+        // the mapping is coherent, so the gpu sees the copy without a flush
+        memcpy(mapped + region * regionSize + offset, source, bytes);
+    } else {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, bytes, source);
+    }
+}
+
+// Deletes the storage buffer and any fences on it (the next upload makes a new one)
+void SceneBuffer::release() {
+    for (int r = 0; r < SCENE_REGIONS; r ++) {
+        if (fences[r]) {
+            glDeleteSync(fences[r]);
+            fences[r] = 0;
+        }
+        written[r] = 0;
+    }
+    if (ssbo) {
+        if (mapped) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            mapped = NULL;
+        }
+        glDeleteBuffers(1, &ssbo);
+        ssbo = 0;
+    }
+    gpuCapacity = 0;
+}
+#endif
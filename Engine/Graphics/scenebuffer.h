@@ -0,0 +1,107 @@
+// Growable buffer of shapes in the shader_data layout, mirrored to the shader's storage buffer
+#ifndef _SCENEBUFFER_H
+#define _SCENEBUFFER_H
+
+#include "../../common.h"
+
+// binding of the shader_data block in rayTracingShaderSrc.frag
+#define SCENE_BINDING 2
+// copies of the scene in a persistently mapped storage buffer (the cpu writes one while the gpu reads the others)
+#define SCENE_REGIONS 3
+
+// fields of the shader_data block ahead of the shapes (std430 puts the shapes straight after them, at byte 16)
+struct SceneHeader {
+    float res[2];
+    int size;
+    int width;
+};
+
+class SceneBuffer {
+    public:
+        // @param capacity Number of shapes room is made for up front (the buffer never shrinks below it)
+        SceneBuffer(int capacity = DSIZE);
+        ~SceneBuffer();
+
+        void setResolution(float x, float y);
+        /**
+         * Parses the shapes into the buffer (see the parsing table in kernel.cpp), doubling its capacity until they
+         * all fit, or halving it once they take up less than a quarter of it. Only shapes whose body revision changed
+         * since the last update are parsed again, unless the list of shapes changed or invalidate was called
+         */
+        void update(const vector<Shape*>& shapes);
+        /**
+         * Parses the world's shapes at their render poses (see World::advance) instead of their body state. Shapes are
+         * parsed again when their body or render revision changed, so moving shapes are parsed every frame, even when
+         * the frame took no step
+         */
+        void update(const World& world);
+        // parses every shape on the next update (for edits that do not go through the body store)
+        void invalidate();
+
+        const SceneHeader& getHeader() const;
+        // WIDTH floats per shape, for the first getSize shapes
+        const float* getData() const;
+        int getSize() const;
+        int getCapacity() const;
+        // number of shapes the last update parsed
+        int getChanged() const;
+
+#ifndef HEADLESS
+        /**
+         * Copies the header and every shape that changed since the copy being written was last written, then binds it to SCENE_BINDING
+         * With buffer storage (GL 4.4) the buffer holds SCENE_REGIONS copies mapped persistently and coherently; each upload writes
+         * the next copy once the fence of the frame that last read it has passed, so the gpu is never written under.
+         * Otherwise the changed ranges are copied into a single copy with glBufferSubData
+         * @return number of bytes copied
+         */
+        size_t upload();
+        // deletes the storage buffer and its fences (has to happen while the context is current, the next upload makes a new one)
+        void release();
+#endif
+
+    private:
+        // the storage buffer is owned, so copying would delete it twice
+        SceneBuffer(const SceneBuffer&);
+        SceneBuffer& operator= (const SceneBuffer&);
+
+        // @param world World whose render poses the shapes are parsed at (NULL for their body state)
+        void update(const vector<Shape*>& shapes, const World* world);
+        void parse(int index, const Shape& shape, const World* world);
+
+        SceneHeader header;
+        // capacity * WIDTH floats
+        vector<float> data;
+        int capacity;
+        int minCapacity;
+
+        // shapes of the last update, with the body revisions they were parsed at and the update they last changed on
+        vector<const Shape*> shapes;
+        vector<unsigned int> revisions;
+        vector<unsigned int> changedAt;
+        unsigned int updates;
+        // whether the last update parsed render poses (its revisions are sums of body and render revisions)
+        bool posed;
+        bool invalid;
+        int changed;
+
+#ifndef HEADLESS
+        // copies a range of a region, through the mapping or with glBufferSubData
+        void write(int region, size_t offset, const void* source, size_t bytes);
+
+        GLuint ssbo;
+        // shapes the storage buffer has room for (0 until the first upload)
+        int gpuCapacity;
+        bool persistent;
+        char* mapped;
+        // bytes per region, rounded up to the storage buffer offset alignment
+        size_t regionSize;
+        int region;
+        // update each region was last written at, and the fence of the last frame that read it
+        unsigned int written[SCENE_REGIONS];
+        GLsync fences[SCENE_REGIONS];
+#endif
+};
+
+#include "scenebuffer.cpp"
+
+#endif
@@ -0,0 +1,163 @@
+#include "shader.h"
+
+ShaderProgram::ShaderProgram() : program(0), modified(0) {}
+
+ShaderProgram::~ShaderProgram() {
+    release();
+}
+
+void ShaderProgram::release() {
+    if (program) {
+        glDeleteProgram(program);
+        program = 0;
+    }
+    uniforms.clear();
+    blocks.clear();
+}
+
+/**
+ * Compiles a shader, logging its info log if it fails
+ * @param type GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+ * @param source Source of the shader
+ * @param name Name of the shader used in the log
+ */
+GLuint ShaderProgram::compile(GLenum type, const string& source, const string& name) {
+    GLuint shader = glCreateShader(type);
+    const char* text = source.c_str();
+    glShaderSource(shader, 1, &text, 0);
+    glCompileShader(shader);
+
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+        string log(max(length, 1), '\0');
+        glGetShaderInfoLog(shader, log.size(), NULL, &log[0]);
+        SDL_Log("Could not compile %s: %s", name.c_str(), log.c_str());
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool ShaderProgram::load(const string& vertexSource, const string& fragmentPath) {
+    this->vertexSource = vertexSource;
+    this->fragmentPath = fragmentPath;
+
+    // the time is taken before reading, so an edit saved while reading is picked up by the next reload
+    struct stat info;
+    modified = stat(fragmentPath.c_str(), &info) == 0 ? info.st_mtime : 0;
+    ifstream in(fragmentPath.c_str());
+    if (!in) {
+        SDL_Log("Could not read %s", fragmentPath.c_str());
+        return false;
+    }
+    stringstream text;
+    text << in.rdbuf();
+
+    GLuint vs = compile(GL_VERTEX_SHADER, vertexSource, "vertex shader");
+    GLuint ps = compile(GL_FRAGMENT_SHADER, text.str(), fragmentPath);
+    if (!vs || !ps) {
+        glDeleteShader(vs);
+        glDeleteShader(ps);
+        return false;
+    }
+
+    GLuint linked = glCreateProgram();
+    glAttachShader(linked, ps);
+    glAttachShader(linked, vs);
+    glLinkProgram(linked);
+    // the program keeps what it needs from the shaders once linked
+    glDeleteShader(vs);
+    glDeleteShader(ps);
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(linked, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint length = 0;
+        glGetProgramiv(linked, GL_INFO_LOG_LENGTH, &length);
+        string log(max(length, 1), '\0');
+        glGetProgramInfoLog(linked, log.size(), NULL, &log[0]);
+        SDL_Log("Could not link %s: %s", fragmentPath.c_str(), log.c_str());
+        glDeleteProgram(linked);
+        return false;
+    }
+
+    if (program) {
+        glDeleteProgram(program);
+    }
+    program = linked;
+    reflect();
+    for (const pair<string, GLuint>& binding : bindings) {
+        GLuint index = getBlock(binding.first);
+        if (index != GL_INVALID_INDEX) {
+            glShaderStorageBlockBinding(program, index, binding.second);
+        }
+    }
+    SDL_Log("Loaded %s (%d uniforms, %d storage blocks)", fragmentPath.c_str(), (int)uniforms.size(), (int)blocks.size());
+    return true;
+}
+
+bool ShaderProgram::reload() {
+    struct stat info;
+    if (fragmentPath.empty() || stat(fragmentPath.c_str(), &info) != 0 || info.st_mtime == modified) {
+        return false;
+    }
+    return load(vertexSource, fragmentPath);
+}
+
+void ShaderProgram::use() const {
+    glUseProgram(program);
+}
+
+void ShaderProgram::bindBlock(const string& name, GLuint binding) {
+    bindings.push_back(make_pair(name, binding));
+    GLuint index = getBlock(name);
+    if (program && index != GL_INVALID_INDEX) {
+        glShaderStorageBlockBinding(program, index, binding);
+    }
+}
+
+void ShaderProgram::reflect() {
+    uniforms.clear();
+    blocks.clear();
+    char name[256];
+
+    GLint count = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    for (GLint i = 0; i < count; i ++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, i, sizeof(name), &length, &size, &type, name);
+        string uniform(name, length);
+        // arrays are reported as name[0], but looked up by name
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0) {
+            uniform.erase(uniform.size() - 3);
+        }
+        uniforms[uniform] = glGetUniformLocation(program, uniform.c_str());
+    }
+
+    count = 0;
+    glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &count);
+    for (GLint i = 0; i < count; i ++) {
+        GLsizei length = 0;
+        glGetProgramResourceName(program, GL_SHADER_STORAGE_BLOCK, i, sizeof(name), &length, name);
+        blocks[string(name, length)] = i;
+    }
+}
+
+GLint ShaderProgram::getUniform(const string& name) const {
+    unordered_map<string, GLint>::const_iterator found = uniforms.find(name);
+    return found == uniforms.end() ? -1 : found->second;
+}
+
+GLuint ShaderProgram::getBlock(const string& name) const {
+    unordered_map<string, GLuint>::const_iterator found = blocks.find(name);
+    return found == blocks.end() ? GL_INVALID_INDEX : found->second;
+}
+
+GLuint ShaderProgram::getProgram() const {
+    return program;
+}
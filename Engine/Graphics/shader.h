@@ -0,0 +1,56 @@
+// Shader program with its uniform and buffer block locations looked up once per link
+#ifndef _SHADER_H
+#define _SHADER_H
+
+#include "../../common.h"
+
+class ShaderProgram {
+    public:
+        ShaderProgram();
+        ~ShaderProgram();
+
+        /**
+         * Compiles a vertex shader source and a fragment shader file and links them
+         * @return whether or not the program linked (compile and link errors are logged, and any previous program is kept)
+         */
+        bool load(const string& vertexSource, const string& fragmentPath);
+        // loads the fragment shader file again if it changed since it was last loaded
+        // @return whether or not a new program was linked
+        bool reload();
+        void use() const;
+        // deletes the program (has to happen while the context is current, the next load links a new one)
+        void release();
+
+        // binds a shader storage block to a binding point, in this program and every program reloaded after it
+        void bindBlock(const string& name, GLuint binding);
+
+        // location of an active uniform (-1 if there is none, which glUniform calls ignore)
+        GLint getUniform(const string& name) const;
+        // index of an active shader storage block (GL_INVALID_INDEX if there is none)
+        GLuint getBlock(const string& name) const;
+        GLuint getProgram() const;
+
+    private:
+        // the program is owned, so copying would delete it twice
+        ShaderProgram(const ShaderProgram&);
+        ShaderProgram& operator= (const ShaderProgram&);
+
+        // @return the compiled shader, or 0 if it did not compile
+        static GLuint compile(GLenum type, const string& source, const string& name);
+        // reads the active uniforms and shader storage blocks of the program
+        void reflect();
+
+        GLuint program;
+        string vertexSource;
+        string fragmentPath;
+        // modification time of the fragment shader file when it was last read
+        time_t modified;
+
+        unordered_map<string, GLint> uniforms;
+        unordered_map<string, GLuint> blocks;
+        vector<pair<string, GLuint>> bindings;
+};
+
+#include "shader.cpp"
+
+#endif
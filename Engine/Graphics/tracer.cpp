@@ -0,0 +1,746 @@
+#include "tracer.h"
+
+/**
+ * Tracer constructor
+ * @param width Width of the image in pixels
+ * @param height Height of the image in pixels
+ */
+Tracer::Tracer(int width, int height) : size(0), width(WIDTH), cameraPos(0), cameraRot(0, 0, 1), samples(TRACER_SAMPLES), bounces(TRACER_BOUNCES), tileSize(16), threads(max((int)std::thread::hardware_concurrency(), 1)), packets(true), path(Simd_detectPath()) {
+    resolution[0] = max(width, 1);
+    resolution[1] = max(height, 1);
+    image.assign(resolution[0] * resolution[1], vec3(0));
+}
+
+/**
+ * Sets the scene from data in the shader_data layout
+ * @param data Parsed shapes, width floats per shape
+ * @param size Number of shapes
+ * @param width Number of floats per shape
+ */
+void Tracer::setData(const float* data, int size, int width) {
+    this->data.assign(data, data + size * width);
+    this->size = size;
+    this->width = width;
+    Packet_prepare(this->data.data(), size, width, packetShapes);
+
+    // the layout has no room for triangles, so meshes are skipped as in the shader
+    meshes.assign(size, NULL);
+    meshIndices.clear();
+}
+
+/**
+ * Sets the scene from a set of shapes (parsed by a SceneBuffer, as Kernel::update does)
+ * @param shapes Shapes to render
+ */
+void Tracer::setScene(const vector<Shape*>& shapes) {
+    SceneBuffer scene(shapes.size());
+    scene.update(shapes);
+    size = scene.getSize();
+    width = WIDTH;
+    data.assign(scene.getData(), scene.getData() + size * width);
+    meshes.assign(size, NULL);
+    meshIndices.clear();
+    for (int i = 0; i < size; i ++) {
+        if (shapes[i]->type == SHAPE_MESH) {
+            meshes[i] = &static_cast<const Mesh*>(shapes[i])->getBVH();
+            meshIndices.push_back(i);
+        }
+    }
+    Packet_prepare(data.data(), size, width, packetShapes);
+}
+
+void Tracer::setCamera(const vec3& pos, const vec3& rot) {
+    cameraPos = pos;
+    cameraRot = rot;
+}
+
+void Tracer::setSamples(int samples) {
+    this->samples = max(samples, 1);
+}
+
+int Tracer::getSamples() const {
+    return samples;
+}
+
+void Tracer::setBounces(int bounces) {
+    this->bounces = max(bounces, 1);
+}
+
+int Tracer::getBounces() const {
+    return bounces;
+}
+
+void Tracer::setThreads(int threads) {
+    this->threads = max(threads, 1);
+}
+
+int Tracer::getThreads() const {
+    return threads;
+}
+
+void Tracer::setTileSize(int tileSize) {
+    this->tileSize = max(tileSize, 1);
+}
+
+void Tracer::setPackets(bool packets) {
+    this->packets = packets;
+}
+
+bool Tracer::usesPackets() const {
+    return packets;
+}
+
+void Tracer::setPath(SimdPath path) {
+    SimdPath supported = Simd_detectPath();
+    this->path = path > supported ? supported : path;
+}
+
+SimdPath Tracer::getPath() const {
+    return path;
+}
+
+/**
+ * Renders the image, tiles being dealt out to the job system's per thread queues
+ * @return time taken in seconds
+ */
+double Tracer::render() {
+    std::chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    int tiles = ((resolution[0] + tileSize - 1) / tileSize) * ((resolution[1] + tileSize - 1) / tileSize);
+    if (threads > 1 && tiles > 1) {
+        if (!jobs || jobs->getThreads() != threads) {
+            jobs.reset(new JobSystem(threads));
+        }
+        jobs->parallelFor(tiles, [this](int tile) {
+            renderTile(tile);
+        });
+    } else {
+        for (int tile = 0; tile < tiles; tile ++) {
+            renderTile(tile);
+        }
+    }
+
+    std::chrono::duration<double> diff = chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+/**
+ * Casts one primary ray per pixel, without shading (used to measure and compare intersection throughput)
+ * @param hits Index of the shape hit through each pixel, row by row from the top of the image
+ * @return time taken to intersect the rays in seconds (generating them is not timed)
+ */
+double Tracer::castPrimary(vector<int>& hits) {
+    int count = resolution[0] * resolution[1];
+    vector<Ray> rays(count);
+    for (int i = 0; i < count; i ++) {
+        float u, v;
+        unsigned int seed;
+        startPixel(i % resolution[0], i / resolution[0], u, v, seed);
+        setSeed(seed, randInt(seed));
+        detRay(u, v, rays[i], seed);
+    }
+    hits.assign(count, -1);
+
+    std::chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (packets) {
+        // packets never span two rows, matching render
+        RayPacket packet;
+        for (int py = 0; py < resolution[1]; py ++) {
+            for (int x0 = 0; x0 < resolution[0]; x0 += PACKET_SIZE) {
+                int first = py*resolution[0] + x0;
+                int lanes = min(PACKET_SIZE, resolution[0] - x0);
+
+                Packet_clear(packet, TRACER_MAXT);
+                for (int i = 0; i < lanes; i ++) {
+                    Packet_addRay(packet, rays[first+i].ro, rays[first+i].rd);
+                }
+                Packet_intersect(packet, packetShapes, TRACER_MINT, path);
+                for (int i = 0; i < lanes; i ++) {
+                    hits[first+i] = packet.obi[i];
+                }
+                if (!meshIndices.empty()) {
+                    for (int i = 0; i < lanes; i ++) {
+                        Hit hit;
+                        hit.t = packet.t[i];
+                        hit.obi = packet.obi[i];
+                        collideMeshes(rays[first+i], hit);
+                        hits[first+i] = hit.obi;
+                    }
+                }
+            }
+        }
+    } else {
+        for (int i = 0; i < count; i ++) {
+            Hit hit;
+            hit.t = TRACER_MAXT;
+            hit.obi = -1;
+            processCol(rays[i], hit);
+            hits[i] = hit.obi;
+        }
+    }
+
+    std::chrono::duration<double> diff = chrono::steady_clock::now() - start;
+    return diff.count();
+}
+
+const vector<vec3>& Tracer::getImage() const {
+    return image;
+}
+
+/**
+ * Writes the image as an uncompressed 24 bit bitmap
+ * @param file Path of the bitmap
+ * @return whether the file was written
+ */
+bool Tracer::save(const char* file) const {
+    ofstream out(file, ios::binary);
+    if (!out) {
+        return false;
+    }
+
+    // rows are padded to 4 bytes
+    int row = (resolution[0] * 3 + 3) & ~3;
+    uint32_t fileSize = 54 + row * resolution[1];
+    uint8_t header[54] = {'B', 'M'};
+    uint32_t fields[] = {fileSize, 0, 54, 40, (uint32_t)resolution[0], (uint32_t)resolution[1]};
+    for (int i = 0; i < 6; i ++) {
+        for (int b = 0; b < 4; b ++) {
+            header[2 + 4*i + b] = (fields[i] >> (8*b)) & 0xFF;
+        }
+    }
+    header[26] = 1;
+    header[28] = 24;
+    out.write((const char*)header, 54);
+
+    // bitmaps are stored bottom up, in bgr order
+    vector<uint8_t> line(row, 0);
+    for (int y = resolution[1] - 1; y >= 0; y --) {
+        for (int x = 0; x < resolution[0]; x ++) {
+            const vec3& c = image[y*resolution[0]+x];
+            line[3*x+0] = (uint8_t)roundf(255.0f * max(0.0f, min(c.Z(), 1.0f)));
+            line[3*x+1] = (uint8_t)roundf(255.0f * max(0.0f, min(c.Y(), 1.0f)));
+            line[3*x+2] = (uint8_t)roundf(255.0f * max(0.0f, min(c.X(), 1.0f)));
+        }
+        out.write((const char*)line.data(), row);
+    }
+    return out.good();
+}
+
+/**
+ * Renders a single tile (tiles are numbered row by row)
+ * @param tile Index of the tile
+ */
+void Tracer::renderTile(int tile) {
+    int columns = (resolution[0] + tileSize - 1) / tileSize;
+    int x0 = (tile % columns) * tileSize;
+    int y0 = (tile / columns) * tileSize;
+    int x1 = min(x0 + tileSize, resolution[0]);
+    int y1 = min(y0 + tileSize, resolution[1]);
+
+    // rows are split into spans of neighbouring pixels, whose primary rays are coherent enough to trace as a packet
+    int span = packets ? PACKET_SIZE : 1;
+    for (int py = y0; py < y1; py ++) {
+        for (int px = x0; px < x1; px += span) {
+            renderSpan(py, px, min(px + span, x1));
+        }
+    }
+}
+
+/**
+ * Renders up to PACKET_SIZE neighbouring pixels of a row (the shader's world function, run for several pixels at once)
+ * @param py Row of the pixels
+ * @param x0 First column
+ * @param x1 Column after the last
+ */
+void Tracer::renderSpan(int py, int x0, int x1) {
+    int count = x1 - x0;
+    float u[PACKET_SIZE];
+    float v[PACKET_SIZE];
+    unsigned int seeds[PACKET_SIZE];
+    vec3 sums[PACKET_SIZE];
+    for (int i = 0; i < count; i ++) {
+        startPixel(x0 + i, py, u[i], v[i], seeds[i]);
+        sums[i] = vec3(0);
+    }
+
+    Ray rays[PACKET_SIZE];
+    RayPacket packet;
+    for (int s = 0; s < samples; s ++) {
+        Packet_clear(packet, TRACER_MAXT);
+        for (int i = 0; i < count; i ++) {
+            setSeed(seeds[i], randInt(seeds[i]));
+            detRay(u[i], v[i], rays[i], seeds[i]);
+            Packet_addRay(packet, rays[i].ro, rays[i].rd);
+        }
+
+        if (!packets) {
+            for (int i = 0; i < count; i ++) {
+                sums[i] += tracePath(rays[i], NULL, seeds[i]);
+            }
+            continue;
+        }
+
+        Packet_intersect(packet, packetShapes, TRACER_MINT, path);
+        for (int i = 0; i < count; i ++) {
+            Hit primary;
+            primary.t = TRACER_MAXT;
+            primary.obi = -1;
+            if (packet.obi[i] != -1) {
+                resolveHit(rays[i], packet.obi[i], primary);
+            }
+            collideMeshes(rays[i], primary);
+            sums[i] += tracePath(rays[i], &primary, seeds[i]);
+        }
+    }
+
+    for (int i = 0; i < count; i ++) {
+        image[py*resolution[0]+x0+i] = sums[i] / samples;
+    }
+}
+
+/**
+ * Finds the screen position of a pixel and seeds its random numbers
+ * @param px Column of the pixel
+ * @param py Row of the pixel, from the top of the image
+ */
+void Tracer::startPixel(int px, int py, float& u, float& v, unsigned int& seed) const {
+    // fragment coordinates between -1 and 1, with y pointing up as in gl
+    float x = (px + 0.5f) / resolution[0] * 2 - 1;
+    float y = (resolution[1] - py - 0.5f) / resolution[1] * 2 - 1;
+    u = x/2 + 0.5f;
+    v = y/2 + 0.5f;
+
+    seed = 1;
+    setSeed(seed, (unsigned int)(hash12(u, v) * (y+1) * resolution[0] * resolution[0] + hash12(u, v) * x));
+    setSeed(seed, randInt(seed) + 20000u);
+}
+
+/**
+ * Follows the path of one sample through the scene
+ * @param curRay Primary ray of the sample
+ * @param primary Closest hit of the primary ray, or NULL to find it
+ * @param seed Random state of the pixel
+ * @return the sample's contribution to the pixel
+ */
+vec3 Tracer::tracePath(Ray curRay, const Hit* primary, unsigned int& seed) const {
+    vec3 curColor = vec3(0);
+    vec3 attenuation = vec3(2);
+
+    int bounceCount = 0;
+
+    for (int j = 0; j < bounces; j ++) {
+        bounceCount ++;
+
+        Hit col;
+        if (j == 0 && primary) {
+            col = *primary;
+        } else {
+            col.t = TRACER_MAXT;
+            col.obi = -1;
+            processCol(curRay, col);
+        }
+
+        // flew into the void
+        if (col.obi == -1) {
+            float t = curRay.rd.Y();
+            curColor = attenuation * (vec3(0.25f, 0.75f, 1.0f)*(1.0f-t) + vec3(0.25f, 0.5f, 0.75f)*t);
+            break;
+        }
+        int switcher = (int)get(col.obi, 11);
+
+        // light
+        if (switcher == 3) {
+            curColor = attenuation * getColor(col.obi) * 5;
+            break;
+        }
+
+        switch (switcher) {
+            case 0: { // lambertian
+                curRay.ro = col.p;
+                curRay.rd = vec3::norm(col.n + randInUnitSphere(seed)*0.9f);
+                if (col.obi == 0) { // world floor
+                    attenuation *= shade(col.p.X(), col.p.Z(), getColor(col.obi), vec3(2, 2, 2))*0.5f;
+                } else {
+                    attenuation *= getColor(col.obi)*0.5f;
+                }
+                break;
+            }
+            case 1: { // metal
+                vec3 diff = randInUnitSphere(seed);
+                curRay.ro = col.p;
+                vec3 rdT = reflect(vec3::norm(curRay.rd), col.n);
+                if (col.obi == 0) { // world floor
+                    float fuzz = 0.1f;
+                    curRay.rd = (rdT*(1.0f-fuzz) + diff*fuzz) + (col.n + diff)*fuzz;
+                    attenuation *= shade(col.p.X(), col.p.Z(), getColor(col.obi), vec3(2, 2, 2))*0.5f;
+                } else {
+                    curRay.rd = (rdT*(1.0f-TRACER_FUZZ) + diff*TRACER_FUZZ) + (col.n + diff)*TRACER_FUZZ;
+                    attenuation *= getColor(col.obi);
+                }
+                break;
+            }
+            case 2: { // glass
+                vec3 reflected = reflect(vec3::norm(curRay.rd), col.n);
+                vec3 outwardNormal;
+                float niOverNt;
+                vec3 refracted = vec3(0);
+                float reflectProb = 1.0f;
+                float csn;
+                float il = 1.0f/vec3::mag(curRay.rd);
+                float drdnor = vec3::dot(curRay.rd, col.n);
+                float idx = get(col.obi, 12);
+                if (drdnor > 0.0f) {
+                    outwardNormal = col.n * -1;
+                    niOverNt = idx;
+                    csn = niOverNt * drdnor * il;
+                } else {
+                    outwardNormal = col.n;
+                    niOverNt = 1.0f/idx;
+                    csn = -niOverNt * drdnor * il;
+                }
+                if (refract(curRay.rd, outwardNormal, niOverNt, refracted)) {
+                    reflectProb = schlick(csn, idx);
+                }
+                curRay.ro = col.p;
+                curRay.rd = randFloat(seed) < reflectProb ? reflected : refracted;
+                break;
+            }
+        }
+    }
+
+    return vec3::callFunc_f1(curColor, sqrtf) / bounceCount;
+}
+
+/**
+ * Generates a camera ray through a point on the screen, jittered within the pixel and across the lens
+ */
+void Tracer::detRay(float u, float v, Ray& ray, unsigned int& seed) const {
+    float aspect = 1.0f;
+
+    float VFOV = 35.0f;
+    float lensRadius = TRACER_APERTURE * 0.5f;
+    float theta = 3.1415f * VFOV / 180;
+
+    float halfHeight = tan(theta*0.5f);
+    float halfWidth = aspect * halfHeight;
+    vec3 origin = vec3(-cameraPos.X(), cameraPos.Y(), -cameraPos.Z());
+    vec3 w = vec3::norm(vec3(cameraRot.X(), -cameraRot.Y(), cameraRot.Z()));
+    vec3 cu = vec3::norm(vec3::cross(vec3(0, 1, 0), w));
+    vec3 cv = vec3::cross(w, cu);
+    vec3 lowerLeftCorner = origin - cu*(halfWidth*TRACER_FOCUS) - cv*(halfHeight*TRACER_FOCUS) - w*TRACER_FOCUS;
+    vec3 horizontal = cu * (2 * halfWidth * TRACER_FOCUS);
+    vec3 vertical = cv * (2 * halfHeight * TRACER_FOCUS);
+
+    float su = u + randFloat(seed)/resolution[0];
+    float sv = v + randFloat(seed)/resolution[1];
+    vec3 rd = randInUnitDisk(seed) * lensRadius;
+    vec3 offset = cu*rd.X() + cv*rd.Y();
+
+    ray.ro = origin + offset;
+    ray.rd = vec3::norm(lowerLeftCorner + horizontal*su + vertical*sv - origin - offset);
+}
+
+/**
+ * Finds the closest shape hit by a ray
+ * @param ray Ray to trace
+ * @param hit Closest hit so far, updated if a closer shape is hit
+ */
+void Tracer::processCol(const Ray& ray, Hit& hit) const {
+    for (int k = 0; k < size; k ++) {
+        collideShape(ray, k, hit);
+    }
+}
+
+/**
+ * Completes the hit of a packet's ray, whose closest shape is already known
+ * @param ray Ray that hit the shape
+ * @param index Index of the shape
+ * @param hit Result (a miss, if the ray does not hit anything)
+ */
+void Tracer::resolveHit(const Ray& ray, int index, Hit& hit) const {
+    hit.t = TRACER_MAXT;
+    hit.obi = -1;
+    collideShape(ray, index, hit);
+
+    // the packet kernels round differently, so rays grazing the shape may miss it here
+    if (hit.obi == -1) {
+        processCol(ray, hit);
+    }
+}
+
+void Tracer::collideShape(const Ray& ray, int index, Hit& hit) const {
+    switch ((int)get(index, 0)) {
+        case 0: // sphere
+            collideSphere(ray, getPos(index), get(index, 8), index, hit);
+            break;
+        case 1: // box
+            collideBox(ray, getPos(index), vec3(get(index, 8), get(index, 9), get(index, 10)), getRot(index), index, hit);
+            break;
+        case 2: // capsule
+            collideCapsule(ray, getPos(index), get(index, 8), get(index, 9), getRot(index), index, hit);
+            break;
+        case 3: // mesh
+            collideMesh(ray, index, hit);
+            break;
+    }
+}
+
+void Tracer::collideMeshes(const Ray& ray, Hit& hit) const {
+    for (int i = 0; i < (int)meshIndices.size(); i ++) {
+        collideMesh(ray, meshIndices[i], hit);
+    }
+}
+
+/**
+ * Intersects a ray with a mesh by moving the ray into the mesh's frame and walking its BVH
+ * @param ray Ray to trace
+ * @param index Index of the mesh
+ * @param hit Closest hit so far, updated if the mesh is hit closer
+ */
+void Tracer::collideMesh(const Ray& ray, int index, Hit& hit) const {
+    const MeshBVH* bvh = meshes[index];
+    if (bvh == NULL) {
+        return;
+    }
+
+    vec3 pos = getPos(index);
+    vec4 q = vec4::norm(getRot(index));
+    vec4 conj = vec4(q.X(), -q.Y(), -q.Z(), -q.W());
+
+    float t;
+    int triangle;
+    if (bvh->raycast(vec3::rotate(ray.ro - pos, conj), vec3::rotate(ray.rd, conj), TRACER_MINT, hit.t, t, triangle)) {
+        hit.t = t;
+        hit.p = ray.ro + ray.rd*t;
+        hit.n = vec3::rotate(bvh->getNormal(triangle), q);
+        hit.obc = pos;
+        hit.obi = index;
+    }
+}
+
+float Tracer::get(int index, int offset) const {
+    return data[index*width+offset];
+}
+
+vec3 Tracer::getPos(int index) const {
+    return vec3(get(index, 1), get(index, 2), get(index, 3));
+}
+
+vec4 Tracer::getRot(int index) const {
+    return vec4(get(index, 4), get(index, 5), get(index, 6), get(index, 7));
+}
+
+vec3 Tracer::getColor(int index) const {
+    return vec3(get(index, 13), get(index, 14), get(index, 15));
+}
+
+void Tracer::collideSphere(const Ray& ray, const vec3& pos, float r, int index, Hit& hit) {
+    float a = vec3::dot(ray.rd, ray.rd);
+    float b = -2.0f*vec3::dot(ray.rd, pos-ray.ro);
+    float c = pow(vec3::mag(pos-ray.ro), 2.0f) - pow(r, 2.0f);
+
+    float disc = b*b - 4.0f*a*c;
+    if (disc >= 0.0f) {
+        float t1 = (-b + sqrt(disc))/(2.0f*a);
+        float t2 = (-b - sqrt(disc))/(2.0f*a);
+
+        bool coll = false;
+        float t = 0;
+        if (t1 < TRACER_MINT) {
+            if (t2 >= TRACER_MINT) {
+                coll = true;
+                t = t2;
+            }
+        } else {
+            coll = true;
+            t = t2 < TRACER_MINT ? t1 : min(t1, t2);
+        }
+
+        if (coll && t < hit.t) {
+            hit.t = t;
+            hit.p = ray.ro + ray.rd*t;
+            hit.n = vec3::norm(hit.p-pos) * (r > 0 ? 1.0f : (r < 0 ? -1.0f : 0.0f));
+            hit.obc = pos;
+            hit.obi = index;
+        }
+    }
+}
+
+void Tracer::collideBoundedPlane(const Ray& ray, const vec3& p, const vec3& u, const vec3& v, const vec3& n, int index, Hit& hit) {
+    // if parallel approx 0 (for error < 0.001)
+    if (abs(vec3::dot(n, ray.rd)) > 0.001f) {
+        float tempT = vec3::dot(p-ray.ro, n)/vec3::dot(ray.rd, n);
+        vec3 tempP = ray.ro + ray.rd*tempT;
+
+        vec3 a = tempP - p;
+        float vv = vec3::dot(v, v);
+        float uu = vec3::dot(u, u);
+        float av = vec3::dot(a, v);
+        float au = vec3::dot(a, u);
+
+        if (tempT < hit.t && tempT > TRACER_MINT && av < vv && au < uu && -av < vv && -au < uu) {
+            hit.t = tempT;
+            hit.p = tempP;
+            hit.n = n;
+            hit.obc = p;
+            hit.obi = index;
+        }
+    }
+}
+
+void Tracer::collideBox(const Ray& ray, const vec3& pos, const vec3& b, const vec4& rot, int index, Hit& hit) {
+    vec3 rotL = vec3::rotate(vec3(1, 0, 0), rot)*b.X();
+    vec3 rotU = vec3::rotate(vec3(0, 1, 0), rot)*b.Y();
+    vec3 rotV = vec3::rotate(vec3(0, 0, 1), rot)*b.Z();
+
+    vec3 negL = rotL * -1;
+    vec3 negU = rotU * -1;
+    vec3 negV = rotV * -1;
+
+    collideBoundedPlane(ray, pos+rotV, rotL, rotU, rotV, index, hit);
+    collideBoundedPlane(ray, pos+rotU, rotL, rotV, rotU, index, hit);
+    collideBoundedPlane(ray, pos+rotL, rotU, rotV, rotL, index, hit);
+
+    collideBoundedPlane(ray, pos+negV, negL, negU, negV, index, hit);
+    collideBoundedPlane(ray, pos+negU, negL, negV, negU, index, hit);
+    collideBoundedPlane(ray, pos+negL, negU, negV, negL, index, hit);
+}
+
+void Tracer::collideCapsule(const Ray& ray, const vec3& pos, float l, float r, const vec4& rot, int index, Hit& hit) {
+    vec3 pa = pos + vec3::rotate(vec3(0, l, 0), rot);
+    vec3 pb = pos + vec3::rotate(vec3(0, -l, 0), rot);
+
+    const vec3& ro = ray.ro;
+    const vec3& rd = ray.rd;
+
+    vec3 ba = pb - pa;
+    vec3 oa = ro - pa;
+
+    float baba = vec3::dot(ba, ba);
+    float bard = vec3::dot(ba, rd);
+    float baoa = vec3::dot(ba, oa);
+    float rdoa = vec3::dot(rd, oa);
+    float oaoa = vec3::dot(oa, oa);
+
+    float a = baba      - bard*bard;
+    float b = baba*rdoa - baoa*bard;
+    float c = baba*oaoa - baoa*baoa - r*r*baba;
+    float h = b*b - a*c;
+    if (h >= 0) {
+        float t = (-b-sqrt(h))/a;
+        float y = baoa + t*bard;
+        // body
+        if (y > 0.0f && y < baba && t < hit.t && t > TRACER_MINT) {
+            pa = ro + rd*t - pa;
+            h = max(0.0f, min(vec3::dot(pa, ba)/vec3::dot(ba, ba), 1.0f));
+
+            hit.t = t;
+            hit.p = ro + rd*t;
+            hit.n = (pa - ba*h)/r;
+            hit.obc = pos;
+            hit.obi = index;
+        }
+
+        // caps
+        vec3 oc = (y <= 0.0f) ? oa : ro - pb;
+        b = vec3::dot(rd, oc);
+        c = vec3::dot(oc, oc) - r*r;
+        h = b*b - c;
+        t = -b - sqrt(h);
+        if (h > 0 && t < hit.t && t > TRACER_MINT) {
+            pa = ro + rd*t - pa;
+            h = max(0.0f, min(vec3::dot(pa, ba)/vec3::dot(ba, ba), 1.0f));
+
+            hit.t = t;
+            hit.p = ro + rd*t;
+            hit.n = (pa - ba*h)/r;
+            hit.obc = pos;
+            hit.obi = index;
+        }
+    }
+}
+
+unsigned int Tracer::randInt(unsigned int& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+void Tracer::setSeed(unsigned int& seed, unsigned int value) {
+    seed = value;
+    randInt(seed); randInt(seed); randInt(seed);
+}
+
+float Tracer::randFloat(unsigned int& seed) {
+    randInt(seed); randInt(seed); randInt(seed);
+    // the shader divides by float(1<<32 - 5), which is 1<<27
+    float f = (float)randInt(seed) / (float)(1 << 27);
+    return f - floor(f);
+}
+
+vec3 Tracer::randDir(unsigned int& seed) {
+    float u = randFloat(seed);
+    float v = randFloat(seed);
+
+    float theta = 2.0f*3.1415f*u;
+    float phi = acos(2.0f*v-1.0f);
+
+    return vec3(sin(phi)*cos(theta), sin(phi)*sin(theta), cos(phi));
+}
+
+vec3 Tracer::randInUnitSphere(unsigned int& seed) {
+    vec3 d = randDir(seed);
+    float m = randFloat(seed);
+
+    return d*m;
+}
+
+vec3 Tracer::randInUnitDisk(unsigned int& seed) {
+    float x = randFloat(seed);
+    float y = randFloat(seed);
+    vec3 p = vec3(2*x - 1, 2*y - 1, 0);
+    while (vec3::dot(p, p) > 1) {
+        x = randFloat(seed);
+        y = randFloat(seed);
+        p = vec3(2*x - 1, 2*y - 1, 0);
+    }
+    return p;
+}
+
+float Tracer::hash12(float x, float y) {
+    vec3 p3 = vec3::fract(vec3(x, y, x) * 0.1031f);
+    p3 += vec3::dot(p3, vec3(p3.Y(), p3.Z(), p3.X()) + 33.33f);
+    float f = (p3.X() + p3.Y()) * p3.Z();
+    return f - floor(f);
+}
+
+vec3 Tracer::reflect(const vec3& d, const vec3& n) {
+    return d - n*(2.0f*vec3::dot(n, d));
+}
+
+bool Tracer::refract(const vec3& v, const vec3& n, float niOverNt, vec3& refracted) {
+    vec3 uv = vec3::norm(v);
+    float dt = vec3::dot(uv, n);
+    float disc = 1.0f - niOverNt * niOverNt * (1.0f-dt*dt);
+    if (disc > 0.0f) {
+        refracted = (uv - n*dt)*niOverNt - n*sqrt(disc);
+        return true;
+    }
+    return false;
+}
+
+float Tracer::schlick(float csn, float idx) {
+    float r0 = (1.0f-idx) / (1.0f+idx);
+    r0 = r0*r0;
+    return r0 + (1.0f-r0)*pow(1.0f-csn, 5.0f);
+}
+
+// checkerboard used on the world floor
+vec3 Tracer::shade(float a, float b, const vec3& c1, const vec3& c2) {
+    float fa = a*0.5f;
+    float fb = b*0.5f;
+    bool wu = fa - floor(fa) > 0.5f;
+    bool wv = fb - floor(fb) > 0.5f;
+    return wu != wv ? c1 : c2;
+}
\ No newline at end of file
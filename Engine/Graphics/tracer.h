@@ -0,0 +1,134 @@
+// CPU path tracer (reference implementation of rayTracingShaderSrc.frag)
+#ifndef _TRACER_H
+#define _TRACER_H
+
+#include "../../common.h"
+
+// constants shared with rayTracingShaderSrc.frag
+#define TRACER_MAXT 100.0f
+#define TRACER_MINT 0.001f
+#define TRACER_BOUNCES 3
+#define TRACER_SAMPLES 1000
+#define TRACER_FUZZ 0.001f
+#define TRACER_FOCUS 18.0f
+#define TRACER_APERTURE 0.10f
+
+class Tracer {
+    public:
+        // renders width by height images of a scene in the shader_data layout (see the parsing table in kernel.cpp)
+        Tracer(int width, int height);
+
+        // copies size shapes of width floats each, exactly as uploaded to the shader
+        void setData(const float* data, int size, int width);
+        // packs the shapes' parsed data into the same layout (meshes are traced through their BVH, so they must outlive any render)
+        void setScene(const vector<Shape*>& shapes);
+        // camera position and direction, as passed to the cPos and cRot uniforms
+        void setCamera(const vec3& pos, const vec3& rot);
+
+        void setSamples(int samples);
+        int getSamples() const;
+        void setBounces(int bounces);
+        int getBounces() const;
+        // number of threads tiles are rendered on (each thread owns a queue of tiles and steals from the others when it runs dry)
+        void setThreads(int threads);
+        int getThreads() const;
+        void setTileSize(int tileSize);
+        // trace primary rays in SIMD packets (otherwise every ray is traced on its own, exactly as the shader does)
+        void setPackets(bool packets);
+        bool usesPackets() const;
+        // packet kernels to use (falls back to the widest path the cpu supports)
+        void setPath(SimdPath path);
+        SimdPath getPath() const;
+
+        // renders every tile, returning the time taken in seconds
+        double render();
+        // casts the first sample's primary ray of every pixel on the calling thread, recording the index of the shape
+        // each ray hits (-1 for none), and returns the time taken in seconds
+        double castPrimary(vector<int>& hits);
+
+        // rendered colors, row by row from the top of the image
+        const vector<vec3>& getImage() const;
+        // writes the image as a 24 bit bitmap
+        bool save(const char* file) const;
+
+    private:
+        struct Ray {
+            vec3 ro;
+            vec3 rd;
+        };
+
+        struct Hit {
+            float t;
+            vec3 p;
+            vec3 n;
+            vec3 obc;
+            int obi;
+        };
+
+        void renderTile(int tile);
+        void renderSpan(int py, int x0, int x1);
+        // screen position and seed of a pixel, seeded as the shader's main function does
+        void startPixel(int px, int py, float& u, float& v, unsigned int& seed) const;
+        // follows one sample's path, starting from its primary hit if that is already known
+        vec3 tracePath(Ray ray, const Hit* primary, unsigned int& seed) const;
+        void detRay(float u, float v, Ray& ray, unsigned int& seed) const;
+        void processCol(const Ray& ray, Hit& hit) const;
+        // fills in a hit on a known shape (found by a packet), falling back to every shape if the shape is missed
+        void resolveHit(const Ray& ray, int index, Hit& hit) const;
+        void collideShape(const Ray& ray, int index, Hit& hit) const;
+        // intersects the ray with every mesh (the packet kernels only handle spheres, boxes and capsules)
+        void collideMeshes(const Ray& ray, Hit& hit) const;
+        void collideMesh(const Ray& ray, int index, Hit& hit) const;
+
+        float get(int index, int offset) const;
+        vec3 getPos(int index) const;
+        vec4 getRot(int index) const;
+        vec3 getColor(int index) const;
+
+        // intersection routines, mirroring their shader counterparts
+        static void collideSphere(const Ray& ray, const vec3& pos, float r, int index, Hit& hit);
+        static void collideBoundedPlane(const Ray& ray, const vec3& p, const vec3& u, const vec3& v, const vec3& n, int index, Hit& hit);
+        static void collideBox(const Ray& ray, const vec3& pos, const vec3& b, const vec4& rot, int index, Hit& hit);
+        static void collideCapsule(const Ray& ray, const vec3& pos, float l, float r, const vec4& rot, int index, Hit& hit);
+
+        // xorshift generator seeded per pixel, so images do not depend on how tiles are scheduled
+        static unsigned int randInt(unsigned int& seed);
+        static void setSeed(unsigned int& seed, unsigned int value);
+        static float randFloat(unsigned int& seed);
+        static vec3 randDir(unsigned int& seed);
+        static vec3 randInUnitSphere(unsigned int& seed);
+        static vec3 randInUnitDisk(unsigned int& seed);
+        static float hash12(float x, float y);
+
+        static vec3 reflect(const vec3& d, const vec3& n);
+        static bool refract(const vec3& v, const vec3& n, float niOverNt, vec3& refracted);
+        static float schlick(float csn, float idx);
+        static vec3 shade(float a, float b, const vec3& c1, const vec3& c2);
+
+        int resolution[2];
+        vector<float> data;
+        int size;
+        int width;
+        // the scene as the packet kernels read it
+        vector<PacketShape> packetShapes;
+        // triangle tree of each shape (NULL unless it is a mesh set through setScene) and the indices of the meshes
+        vector<const MeshBVH*> meshes;
+        vector<int> meshIndices;
+
+        vec3 cameraPos;
+        vec3 cameraRot;
+
+        int samples;
+        int bounces;
+        int tileSize;
+        int threads;
+        unique_ptr<JobSystem> jobs;
+        bool packets;
+        SimdPath path;
+
+        vector<vec3> image;
+};
+
+#include "tracer.cpp"
+
+#endif
\ No newline at end of file
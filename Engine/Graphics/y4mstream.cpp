@@ -0,0 +1,85 @@
+#include "y4mstream.h"
+
+// the encoder writes frames in order, so a couple of buffers keep capture from waiting on it
+Y4mStream::Y4mStream(int threads) : FrameSink(3), file(NULL), jobs(threads > 0 ? threads : max((int)std::thread::hardware_concurrency(), 1)) {}
+
+Y4mStream::~Y4mStream() {
+    close();
+}
+
+bool Y4mStream::open(const string& path, int width, int height, int fps) {
+    close();
+    file = path == "-" ? stdout : fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", width, height, max(fps, 1));
+    planes.resize((size_t)width * height + 2 * (size_t)((width + 1) / 2) * ((height + 1) / 2));
+    start(width, height);
+    return true;
+}
+
+bool Y4mStream::close() {
+    if (!file) {
+        return false;
+    }
+    bool written = finish();
+    if (file == stdout) {
+        written = fflush(file) == 0 && written;
+    } else {
+        written = fclose(file) == 0 && written;
+    }
+    file = NULL;
+    return written;
+}
+
+bool Y4mStream::encode(const vector<const uint8_t*>& frames, int) {
+    bool written = true;
+    int chromaHeight = (height + 1) / 2;
+    int bands = min(chromaHeight, jobs.getThreads() * 4);
+    for (const uint8_t* frame : frames) {
+        jobs.parallelFor(bands, [&](int band) {
+            convert(frame, width, height, planes.data(), chromaHeight * band / bands, chromaHeight * (band + 1) / bands);
+        });
+        written = fputs("FRAME\n", file) >= 0 && fwrite(planes.data(), 1, planes.size(), file) == planes.size() && written;
+    }
+    return written;
+}
+
+void Y4mStream::convert(const uint8_t* rgba, int width, int height, uint8_t* planes, int begin, int end) {
+    int chromaWidth = (width + 1) / 2;
+    int chromaHeight = (height + 1) / 2;
+    uint8_t* yPlane = planes;
+    uint8_t* uPlane = planes + (size_t)width * height;
+    uint8_t* vPlane = uPlane + (size_t)chromaWidth * chromaHeight;
+
+    if (end < 0) {
+        end = chromaHeight;
+    }
+
+    // rows of pixels are converted in pairs, so bands of chroma rows never share a byte
+    for (int cy = begin; cy < end; cy ++) {
+        for (int cx = 0; cx < chromaWidth; cx ++) {
+            int r = 0, g = 0, b = 0, count = 0;
+            for (int y = 2 * cy; y < min(2 * cy + 2, height); y ++) {
+                // the output is top down
+                const uint8_t* row = rgba + (size_t)(height - 1 - y) * width * 4;
+                for (int x = 2 * cx; x < min(2 * cx + 2, width); x ++) {
+                    const uint8_t* pixel = row + 4 * x;
+                    // fixed point weights scaled by 256
+                    yPlane[(size_t)y * width + x] = (77 * pixel[0] + 150 * pixel[1] + 29 * pixel[2] + 128) >> 8;
+                    r += pixel[0];
+                    g += pixel[1];
+                    b += pixel[2];
+                    count ++;
+                }
+            }
+            r = (r + count / 2) / count;
+            g = (g + count / 2) / count;
+            b = (b + count / 2) / count;
+            // offset by 128 before the shift, so it never shifts a negative number
+            uPlane[(size_t)cy * chromaWidth + cx] = min((-43 * r - 85 * g + 128 * b + 32896) >> 8, 255);
+            vPlane[(size_t)cy * chromaWidth + cx] = min((128 * r - 107 * g - 21 * b + 32896) >> 8, 255);
+        }
+    }
+}
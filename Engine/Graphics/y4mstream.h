@@ -0,0 +1,38 @@
+// Streams frames as raw YUV4MPEG2 video, for piping into an external encoder
+#ifndef _Y4MSTREAM_H
+#define _Y4MSTREAM_H
+
+#include "../../common.h"
+
+class Y4mStream : public FrameSink {
+    public:
+        // @param threads Number of threads each frame is converted to YUV on (0 for one per core)
+        Y4mStream(int threads = 0);
+        ~Y4mStream();
+
+        /**
+         * Writes the stream header (full range 4:2:0, which ffmpeg and x264 read as is)
+         * @param path File to write, or "-" for standard output (e.g. `| ffmpeg -i - out.mp4`)
+         */
+        bool open(const string& path, int width, int height, int fps);
+        bool close();
+
+        /**
+         * Converts a frame (RGBA, bottom row first) to Y, U and V planes with BT.601 weights, averaging chroma over 2 by 2 pixels
+         * @param begin First row of chroma (every chroma row covers two rows of pixels) to convert
+         * @param end Row of chroma after the last one to convert (-1 for the last row)
+         */
+        static void convert(const uint8_t* rgba, int width, int height, uint8_t* planes, int begin = 0, int end = -1);
+
+    private:
+        bool encode(const vector<const uint8_t*>& frames, int first);
+
+        FILE* file;
+        JobSystem jobs;
+        // planes of the frame being written
+        vector<uint8_t> planes;
+};
+
+#include "y4mstream.cpp"
+
+#endif
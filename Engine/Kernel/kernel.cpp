@@ -18,20 +18,24 @@
  * ...
  */
 
-bool gifs = true;
-
-struct shader_data_t {
-    float res[2];
-    int size;
-    int width;
-    float data[DSIZE*WIDTH]; // has a maximum size of 16 MB (16,000,000 bytes, or 4,000,000 floats)
-} shader_data;
+// passes the screen position of each vertex on to the ray tracing shader
+const char* vertexShaderSrc =
+    "varying float x, y, z;"
+    "void main() {"
+    "	gl_Position = ftransform();"
+    "	x = gl_Position.x; y = gl_Position.y; z = gl_Position.z;"
+    "}";
 
 /**
  * Initialize and run the lifecycle of the open gl context
  * @return an int indicating the exit status of the program
  */
 int Kernel::start(const char* windowTitle, int rx, int ry) {
+#ifndef NDEBUG
+    // traced messages are echoed to stderr as they are written (otherwise they only reach the ring buffer)
+    Trace::setConsole(true);
+#endif
+
     // Check SDL configuration
     initSDL();
 
@@ -54,8 +58,8 @@ int Kernel::start(const char* windowTitle, int rx, int ry) {
     // Set shaders
     setShader();
  
-    // Define shapes array
-    vector<Shape*> shapes;
+    // Define physics world (fixed timestep)
+    World physics = World(0.01, AABB_TREE);
     BBox world = BBox(
         vec3(100, 1, 100),
         1.0f,
@@ -136,7 +140,6 @@ int Kernel::start(const char* windowTitle, int rx, int ry) {
     );
     /*Mesh mesh = Mesh(
         0,
-        5.0f,
         0,
         "../../Meshes/books_and_mugs.obj",
         1.0f,
@@ -226,48 +229,41 @@ int Kernel::start(const char* windowTitle, int rx, int ry) {
         1.5f
     );
 
-    sphere.linv = sphere.com * -1;
-    sphere1.linv = sphere1.com * -1;
-    sphere2.linv = sphere2.com * -1;
-    box2.linv = vec3(0, 10, 0);
-
-    shapes.push_back(&world);
-    shapes.push_back(&sphere);
-    //shapes.push_back(&sphere1);
-    //shapes.push_back(&sphere2);
-    //shapes.push_back(&box5);
-    //shapes.push_back(&box6);
-    //shapes.push_back(&box7);
-    //shapes.push_back(&box8);
-    //shapes.push_back(&box9);
-    //shapes.push_back(&box1);
-    shapes.push_back(&box2);
-    //shapes.push_back(&box3);
-    //shapes.push_back(&box4);
+    sphere.linv() = sphere.com() * -1;
+    sphere1.linv() = sphere1.com() * -1;
+    sphere2.linv() = sphere2.com() * -1;
+    box2.linv() = vec3(0, 10, 0);
+
+    physics.addShape(&world);
+    physics.addShape(&sphere);
+    //physics.addShape(&sphere1);
+    //physics.addShape(&sphere2);
+    //physics.addShape(&box5);
+    //physics.addShape(&box6);
+    //physics.addShape(&box7);
+    //physics.addShape(&box8);
+    //physics.addShape(&box9);
+    //physics.addShape(&box1);
+    physics.addShape(&box2);
+    //physics.addShape(&box3);
+    //physics.addShape(&box4);
     
-    //shapes.push_back(&capsule);
+    //physics.addShape(&capsule);
     
     // Update shader data parameters
-    shader_data.res[0] = rx;
-    shader_data.res[1] = ry;
+    scene.setResolution(rx, ry);
 
-    shader_data.size = DSIZE;
-    shader_data.width = WIDTH;
+    // Frames are read back a few frames behind the one being rendered
+    frameReader.setSize(resolution[0], resolution[1]);
+    screenshots.setSize(resolution[0], resolution[1]);
 
-    // Initialize GIF
-    vector<uint8_t> gifimage;
-    GifWriter writer;
-    
-    if (gifs) {
-        cout << "size1: " << gifimage.max_size();
-        cout << "res[0]*res[1]: " << resolution[0] * resolution[1] * 4;
-        gifimage.assign(resolution[0] * resolution[1] * 4, (uint8_t)0);
-        cout << "size2: " << gifimage.size();
-        //cin.ignore();
-        initGif("output/boxgif.gif", gifimage, writer);
+    // Open the recording
+    if (recording) {
+        recording = openOutput();
     }
 
-    cout << "Setup Complete" << "\n";
+    // status goes to stderr, as standard output may be carrying the y4m stream (see setOutput)
+    cerr << "Setup Complete" << "\n";
 
     isRunning = true;
 
@@ -282,7 +278,7 @@ int Kernel::start(const char* windowTitle, int rx, int ry) {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         
         // Update
-        update(shapes);
+        update(physics);
 
         // Draw
         render(window);
@@ -293,23 +289,22 @@ int Kernel::start(const char* windowTitle, int rx, int ry) {
         //cin.ignore();
         /*isRunning = false;
         string fname = "output/" + to_string(i) + ".bmp";
-        if (saveImage(window, renderer, fname.c_str())) {
-            cout << "Saved image\n";
+        if (saveImage(fname.c_str())) {
+            cerr << "Queued image\n";
         }*/
         //cin.ignore();
 
-        if (gifs) {
-            if (updateGif(window, renderer, gifimage, writer)) {
-                cout << "\nUpdated current gif frame\n";
-            }
+        if (recording) {
+            updateOutput();
         }
+        writeImages(false);
         //cin.ignore();
 
         i ++;
     }
-    // Save gif to file
-    if (gifs) {
-        GifEnd(&writer);
+    // Finish the recording
+    if (recording) {
+        closeOutput();
     }
 
     // Free resources
@@ -334,42 +329,22 @@ int Kernel::initSDL() {
 }
 
 void Kernel::setShader() {
-    string line, text;
-    ifstream in("rayTracingShaderSrc.frag");
-    while(getline(in, line))
-    {
-        text += line + "\n";
+    iFrame = iTime = cPos = cRot = -1;
+    // the scene buffer is bound to SCENE_BINDING, whatever binding the source declares
+    shader.bindBlock("shader_data", SCENE_BINDING);
+    if (shader.load(vertexShaderSrc, "rayTracingShaderSrc.frag")) {
+        useShader();
     }
-    const char *f = text.c_str();
-
-	const char *v =
-		"varying float x, y, z;"
-		"void main() {"
-		"	gl_Position = ftransform();"
-		"	x = gl_Position.x; y = gl_Position.y; z = gl_Position.z;"
-		"}";
- 
-	vs = glCreateShader(GL_VERTEX_SHADER);
-	ps = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(ps, 1, &f, 0);
-	glShaderSource(vs, 1, &v, 0);
- 
-	glCompileShader(vs);
-	glCompileShader(ps);
- 
-	prog = glCreateProgram();
-	glAttachShader(prog, ps);
-	glAttachShader(prog, vs);
- 
-	glLinkProgram(prog);
-	glUseProgram(prog);
+}
 
-    
-    glGenBuffers(1, &ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(shader_data), &shader_data, GL_DYNAMIC_COPY);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, ssbo);
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+// Switches to the shader's current program and looks up its uniforms (once per link rather than every frame)
+void Kernel::useShader() {
+    shader.use();
+
+    iFrame = shader.getUniform("iFrame");
+    iTime = shader.getUniform("iTime");
+    cPos = shader.getUniform("cPos");
+    cRot = shader.getUniform("cRot");
 }
 
 /**
@@ -494,9 +469,9 @@ void Kernel::events(SDL_Window* window) {
         setPos(0, -moveC, 0);
     }
     if (enDown) {
-        cout << "\ncPos: " << cameraPos[0] << " " << cameraPos[1] << " " << cameraPos[2];
-        cout << "\ncRot: " << curTheta << " " << curPhi;
-        cout << "\n";
+        cerr << "\ncPos: " << cameraPos[0] << " " << cameraPos[1] << " " << cameraPos[2];
+        cerr << "\ncRot: " << curTheta << " " << curPhi;
+        cerr << "\n";
     }
 
 }
@@ -570,78 +545,43 @@ void Kernel::setDir(float theta, float phi) {
     cameraRot[1] = cos(phi);
 }
 
-void Kernel::update(vector<Shape*>& shapes) {
+void Kernel::update(World& physics) {
     frame += 1;
     
     std::chrono::steady_clock::time_point cur = chrono::steady_clock::now();
-    std::chrono::duration<float> diff = cur - initT;
-    float dt = diff.count() - curtime;
+    std::chrono::duration<double> diff = cur - initT;
+    double dt = diff.count() - curtime;
     curtime = diff.count();
 
-    // system information
-    cout << "\rFrame: " << frame << "\tTime: " << curtime << "\tdT: " << dt << "\tFPS: " << 1/dt;
-
-    int i = 0;
-    for (Shape* shape : shapes) {
-        shape->updateLoop(0.01);//dt/2);
-        
-        for (Shape* s1 : shapes) {
-            if (shape != s1) {
-                shape->collideWith(s1, 0.01);//dt/2);
-            }
-        }
+    // system information (written every frame, so only traced at debug level, like the lines below)
+    TRACE_DEBUG("Frame: " << frame << "\tTime: " << curtime << "\tdT: " << dt << "\tFPS: " << 1/dt);
 
-        vector<float> parsedData;
-        vector<float> parsedVertices;
-        parsedData = shape->parseData();
-        parsedVertices = shape->getVertices();
-        int k = 0;
+    // physics takes as many fixed steps as the frame covers, whatever the frame rate (recordings advance one output frame
+    // per frame, so they play back at the speed of the simulation however long frames took to render and encode)
+    physics.advance(recording ? 1.0 / OUTPUT_FPS : dt);
+    TRACE_DEBUG("Steps: " << physics.getSteps() << "\tAlpha: " << physics.getAlpha() << "\tDropped: " << physics.getDropped());
 
-        for (float j : parsedData) {
-            //cout << j << " ";
-            shader_data.data[i*WIDTH+k] = j;
-            k ++;
-        }
-
-        // too tired to think clearly so I will write out what I think I can do
-        // there's no need to pass this much mesh data every frame
-        // find a way (maybe using glBufferData? GL_ARRAY_BUFFER?) to send data once at the beginning of the program
-        // after shapes are created, and make sure that the ray tracer has random access to said array
-        // it feels unnecessary to update this every frame
-        // it also might be a speed bonus to change the ssbo to a ubo because we dont need all that space to update every frame
-        // (this would theoretically be faster)
-        // ultimately, find a way to offload the passage of mesh data to the gpu without having to constantly update the realtime ssbo
-        /*k = 0;
-        if (parsedVertices.size() > 0) {
-            for (float j : parsedVertices) {
-                cout << j << " ";
-                shader_data.data[WIDTH*DSIZE+k] = j;
-                k++;
-                if (k % 3 == 0) { cout << "\n" << k << " "; }
-            }
-        }*/
-
-        i ++;
-    }
+    // shapes are drawn between the last two steps, and mesh triangles are not uploaded yet (the shader skips meshes),
+    // only their rows of the parsing table
+    scene.update(physics);
     
+    // pick up edits to the shader file (a shader that fails to compile leaves the last one running)
+    if (shader.reload()) {
+        useShader();
+    }
+
     // update shader uniform variables
     glClear(GL_COLOR_BUFFER_BIT);
-	glUniform1i(iFrame, frame);
+    glUniform1i(iFrame, frame);
     glUniform1f(iTime, curtime);
-    glUniform3f(glGetUniformLocation(prog, "cPos"), cameraPos[0], cameraPos[1], cameraPos[2]);
-    glUniform3f(glGetUniformLocation(prog, "cRot"), cameraRot[0], cameraRot[1], cameraRot[2]);
-
-    // setup and update ssbo (shader storage buffer object)
-    GLint prog = 0;
-    glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
-    
-    GLuint block_index = 0;
-    block_index = glGetProgramResourceIndex(prog, GL_SHADER_STORAGE_BLOCK, "shader_data");
-
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo);
-    GLvoid* p = glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_WRITE_ONLY);
-    memcpy(p, &shader_data, sizeof(shader_data));
-    glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+    glUniform3f(cPos, cameraPos[0], cameraPos[1], cameraPos[2]);
+    glUniform3f(cRot, cameraRot[0], cameraRot[1], cameraRot[2]);
+
+    // only shapes whose bodies moved are parsed and copied (anchored shapes are copied once)
+    size_t uploaded = scene.upload();
+    TRACE_DEBUG("Shapes changed: " << scene.getChanged() << "/" << scene.getSize() << "\tBytes uploaded: " << uploaded);
+    // the trace above is compiled out below debug level
+    (void)uploaded;
 }
 
 void Kernel::render(SDL_Window* window) {
@@ -658,144 +598,114 @@ void Kernel::render(SDL_Window* window) {
     SDL_GL_SwapWindow(window);
 }
 
-void flipSurface(SDL_Surface* surface) {
-    SDL_LockSurface(surface);
-    
-    int pitch = surface->pitch; // row size
-    char* temp = new char[pitch]; // intermediate buffer
-    char* pixels = (char*) surface->pixels;
-    
-    for(int i = 0; i < surface->h / 2; ++i) {
-        // get pointers to the two rows to swap
-        char* row1 = pixels + i * pitch;
-        char* row2 = pixels + (surface->h - i - 1) * pitch;
-        
-        // swap rows
-        memcpy(temp, row1, pitch);
-        memcpy(row1, row2, pitch);
-        memcpy(row2, temp, pitch);
+/**
+ * Queues a read of what is currently on screen, to be saved as a bitmap once the read finishes (see writeImages)
+ * @return whether or not the read was queued
+ */
+bool Kernel::saveImage(const char* file) {
+    if (screenshots.getPending() == screenshots.getBuffers()) {
+        writeImages(true);
     }
-    
-    delete[] temp;
-
-    SDL_UnlockSurface(surface);
+    if (!screenshots.read(GL_FRONT)) {
+        return false;
+    }
+    screenshotFiles.push_back(file);
+    return true;
 }
 
-Uint32 getpixel(SDL_Surface *surface, int x, int y)
-{
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to retrieve */
-    Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
-
-    switch (bpp) {
-        case 1:
-            return *p;
-            break;
-
-        case 2:
-            return *(Uint16 *)p;
-            break;
-
-        case 3:
-            if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-                return p[0] << 16 | p[1] << 8 | p[2];
-            else
-                return p[0] | p[1] << 8 | p[2] << 16;
-                break;
-
-        case 4:
-            return *(Uint32 *)p;
-            break;
+/**
+ * Saves the screenshots whose reads have finished
+ * @param wait Whether to wait for every pending read
+ */
+void Kernel::writeImages(bool wait) {
+    int w = screenshots.getWidth();
+    int h = screenshots.getHeight();
+    vector<uint8_t> frame;
+    while (screenshots.getPending() > 0 && (wait || screenshots.ready())) {
+        frame.resize((size_t)w * h * 4);
+        bool read = screenshots.collect(frame.data(), true);
+        string file = screenshotFiles.front();
+        screenshotFiles.pop_front();
+        if (!read) {
+            continue;
+        }
 
-        default:
-            return 0;       /* shouldn't happen, but avoids warnings */
+        SDL_Surface* image = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+        SDL_LockSurface(image);
+        // the surface is tightly packed at 32 bits a pixel, so rows line up with the frame's
+        FrameSink::flip(frame.data(), (uint8_t*)image->pixels, w, h);
+        SDL_UnlockSurface(image);
+        SDL_SaveBMP(image, file.c_str());
+        SDL_FreeSurface(image);
     }
 }
 
-bool Kernel::saveImage(SDL_Window* window, SDL_Renderer* renderer, const char* file) {
-    int w,h;
-    SDL_GetRendererOutputSize(renderer, &w, &h);
-
-    SDL_Surface* image = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0);
-
-    glReadBuffer(GL_FRONT);
-    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, image->pixels);
-
-    SDL_Color rgb;
-    Uint32 data = getpixel(image, 200, 200);
-    SDL_GetRGB(data, image->format, &rgb.r, &rgb.g, &rgb.b);
-    
-    cout << "\ncolor: " << (int)rgb.r << " " << (int)rgb.g << " " << (int)rgb.b;
-    cout << "\nitime: " << (int)curtime << "\n";
-
-    flipSurface(image);
-
-    SDL_SaveBMP(image, file);
-    SDL_FreeSurface(image);
+/**
+ * Selects where recorded frames go
+ * @param type gif, png, ppm or y4m (see FrameSinkType), or none to record nothing
+ * @param path File to write (the prefix of every file for png and ppm, or "-" to stream y4m to standard output)
+ * @return whether or not the type is known
+ */
+bool Kernel::setOutput(const string& type, const string& path) {
+    recording = type != "none";
+    outputPath = path;
+    return !recording || FrameSink::parseType(type, outputType);
 }
 
 /**
- * Sets the pixel of a given image (given rgb int values between 0 and 256)
+ * Opens the selected output at the window's resolution
  */
-void SetPixel(int x, int y, int width, uint8_t red, uint8_t grn, uint8_t blu, vector<uint8_t>& image) {
-    int ind = (y*width+x)*4;
-    image.at(ind+0) = red;
-    image.at(ind+1) = blu;
-    image.at(ind+2) = grn;
-    image.at(ind+3) = 255;
+bool Kernel::openOutput() {
+    droppedFrames = 0;
+    output.reset(FrameSink::create(outputType));
+    if (!output->open(outputPath, resolution[0], resolution[1], OUTPUT_FPS)) {
+        cerr << "Could not open " << outputPath << "\n";
+        output.reset();
+        return false;
+    }
+    return true;
 }
 
 /**
- * Sets the pixel of a given image (given rgb float values between 0 and 1)
+ * Queues what is currently on screen as the next recorded frame
+ * Reads go through pixel buffer objects and are handed to the output (which encodes them on its own threads) once the
+ * gpu has finished them, so the render loop only waits when every buffer is still in flight
  */
-void SetPixelFloat(int x, int y, int width, float fred, float fgrn, float fblu, vector<uint8_t>& image) {
-    uint8_t red = (uint8_t)roundf( 255.0f * fred );
-    uint8_t grn = (uint8_t)roundf( 255.0f * fgrn );
-    uint8_t blu = (uint8_t)roundf( 255.0f * fblu );
-    
-    SetPixel(x, y, width, red, grn, blu, image);
+void Kernel::updateOutput() {
+    while (frameReader.ready() || frameReader.getPending() == frameReader.getBuffers()) {
+        collectOutput();
+    }
+    frameReader.read(GL_FRONT);
 }
 
 /**
- * Initializes the gif writer and filename
+ * Hands the oldest frame being read to the output
+ * A read that could not be mapped is skipped rather than recorded as a stale frame (the acquired buffer is left for the
+ * next frame) and counted, so closeOutput can report it
  */
-bool Kernel::initGif(const char* file, vector<uint8_t>& gifimage, GifWriter& writer) {
-    //image = vector<uint8_t>(resolution[0] * resolution[1] * 4, 0);
-    // initializes the image to a black screen
-    gifimage.assign(resolution[0] * resolution[1] * 4, 0);
-    cout << "\nAssigned";
-	return GifBegin(&writer, file, resolution[0], resolution[1], 2, 8, true);
+void Kernel::collectOutput() {
+    if (frameReader.collect(output->acquire(), true)) {
+        output->submit();
+    } else {
+        droppedFrames ++;
+    }
 }
 
 /**
- * Updates a single frame of the gif based on what is currently in the renderer window
+ * Hands the frames still being read to the output and closes it
+ * @return whether or not every frame was read and written
  */
-bool Kernel::updateGif(SDL_Window* window, SDL_Renderer* renderer, vector<uint8_t>& gifimage, GifWriter& writer) {
-    int w,h;
-    SDL_GetRendererOutputSize(renderer, &w, &h);
-
-    SDL_Surface* surface = SDL_CreateRGBSurface(SDL_SWSURFACE, w, h, 24, 0x000000FF, 0x0000FF00, 0x00FF0000, 0);
-
-    glReadBuffer(GL_FRONT);
-    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, surface->pixels);
-
-    flipSurface(surface);
-
-    for (int i = 0; i < resolution[0]; i ++) {
-        for (int j = 0; j < resolution[1]; j ++) {
-            SDL_Color rgb;
-            Uint32 data = getpixel(surface, i, j);
-            SDL_GetRGB(data, surface->format, &rgb.r, &rgb.g, &rgb.b);
-
-            SetPixel(i, j, resolution[0], rgb.r, rgb.b, rgb.g, gifimage);
-        }
+bool Kernel::closeOutput() {
+    while (frameReader.getPending() > 0) {
+        collectOutput();
     }
-
-    SDL_FreeSurface(surface);
-
-    return GifWriteFrame(&writer, gifimage.data(), resolution[0], resolution[1], 2, 8, true);
+    bool written = output->close();
+    output.reset();
+    if (droppedFrames > 0) {
+        cerr << "Could not read back " << droppedFrames << " frames of " << outputPath << "\n";
+    }
+    return written && droppedFrames == 0;
 }
-    
 
 /**
  * Cleans up gl context and deletes the SDL window pane
@@ -804,6 +714,11 @@ bool Kernel::updateGif(SDL_Window* window, SDL_Renderer* renderer, vector<uint8_
  */
 void Kernel::cleanUp(SDL_Window* window, SDL_GLContext &glContext) {
     // Clean up resources
+    writeImages(true);
+    frameReader.release();
+    screenshots.release();
+    scene.release();
+    shader.release();
    SDL_GL_DeleteContext(glContext);
    SDL_DestroyWindow(window); 
 }
\ No newline at end of file
@@ -5,24 +5,31 @@
 
 #include "../../common.h"
 
+// frame rate recordings play back at (a gif delay of 2 hundredths of a second)
+#define OUTPUT_FPS 50
+
 class Kernel {
     public:
         int start(const char* windowTitle, int rx, int ry);
+        bool setOutput(const string& type, const string& path);
     private:
         bool isRunning = true;
 
         int initSDL();
         SDL_Window* createWindow(const char* windowTitle, int width, int height);
         SDL_Renderer* createRenderer(SDL_Window* window);
-        void update(vector<Shape*>& shapes);
+        void update(World& physics);
         void render(SDL_Window* window);
         void cleanUp(SDL_Window* window, SDL_GLContext &glContext);
         void events(SDL_Window* window);
-        bool saveImage(SDL_Window* window, SDL_Renderer* renderer, const char* file);
-        bool saveImage(SDL_Surface* surface, const char* file);
-        bool initGif(const char* file, vector<uint8_t>& gifimage, GifWriter& writer);
-        bool updateGif(SDL_Window* window, SDL_Renderer* renderer, vector<uint8_t>& gifimage, GifWriter& writer);
+        bool saveImage(const char* file);
+        void writeImages(bool wait);
+        bool openOutput();
+        void updateOutput();
+        void collectOutput();
+        bool closeOutput();
         void setShader();
+        void useShader();
         void setPos(float x, float y, float z);
         void setDir(float theta, float phi);
 
@@ -42,10 +49,22 @@ class Kernel {
 
         std::chrono::steady_clock::time_point initT;
 
-        float frame, curtime = 0;
-        GLuint ps, vs, prog, iFrame, iTime;
-        GLint cPos, cRot;
-        GLuint ssbo = 0;
+        float frame;
+        double curtime = 0;
+        ShaderProgram shader;
+        GLint iFrame, iTime, cPos, cRot;
+        SceneBuffer scene;
+        // recorded frames go to an animated gif unless setOutput picks another sink
+        bool recording = true;
+        FrameSinkType outputType = GIF_SINK;
+        string outputPath = "output/boxgif.gif";
+        unique_ptr<FrameSink> output;
+        // frames whose reads failed, so were left out of the recording
+        int droppedFrames = 0;
+        FrameReader frameReader;
+        FrameReader screenshots;
+        // files of the screenshots still being read, in the order they were taken
+        deque<string> screenshotFiles;
         SDL_Surface* sumSurface;
         int resolution[2];
 };
@@ -0,0 +1,327 @@
+#include "aabbtree.h"
+
+/**
+ * AABB tree constructor
+ * @param margin Distance each leaf box is grown by when (re)inserted
+ */
+AABBTree::AABBTree(float margin) : root(-1), freeList(-1), margin(margin) {}
+
+/**
+ * Takes a node from the free list (or grows the pool)
+ */
+int AABBTree::allocateNode() {
+    int node;
+    if (freeList != -1) {
+        node = freeList;
+        freeList = nodes[node].parent;
+    } else {
+        node = nodes.size();
+        nodes.push_back(Node());
+    }
+    nodes[node].shape = NULL;
+    nodes[node].parent = -1;
+    nodes[node].left = -1;
+    nodes[node].right = -1;
+    nodes[node].height = 0;
+    return node;
+}
+
+/**
+ * Returns a node to the free list
+ */
+void AABBTree::freeNode(int node) {
+    nodes[node].shape = NULL;
+    nodes[node].parent = freeList;
+    freeList = node;
+}
+
+/**
+ * Inserts a shape with a given (tight) box
+ * @param shape Shape to insert
+ * @param box Bounding box of the shape
+ */
+void AABBTree::insert(Shape* shape, const AABB& box) {
+    int leaf = allocateNode();
+    nodes[leaf].box = AABB::fatten(box, margin);
+    nodes[leaf].shape = shape;
+    leaves[shape] = leaf;
+    insertLeaf(leaf);
+}
+
+/**
+ * Removes a shape from the tree
+ * @param shape Shape to remove
+ */
+void AABBTree::remove(Shape* shape) {
+    unordered_map<Shape*, int>::iterator it = leaves.find(shape);
+    if (it == leaves.end()) {
+        return;
+    }
+    removeLeaf(it->second);
+    freeNode(it->second);
+    leaves.erase(it);
+}
+
+/**
+ * Updates the box of a shape already in the tree
+ * @param shape Shape that moved
+ * @param box New (tight) bounding box of the shape
+ * @return whether or not the shape had to be reinserted
+ */
+bool AABBTree::move(Shape* shape, const AABB& box) {
+    int leaf = leaves.at(shape);
+    if (AABB::contains(nodes[leaf].box, box)) {
+        return false;
+    }
+
+    removeLeaf(leaf);
+    nodes[leaf].box = AABB::fatten(box, margin);
+    insertLeaf(leaf);
+    return true;
+}
+
+/**
+ * Links a leaf into the tree, choosing the sibling that increases the total surface area the least
+ */
+void AABBTree::insertLeaf(int leaf) {
+    if (root == -1) {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // descend to the best sibling
+    AABB box = nodes[leaf].box;
+    int index = root;
+    while (nodes[index].left != -1) {
+        int left = nodes[index].left;
+        int right = nodes[index].right;
+
+        float area = AABB::area(nodes[index].box);
+        float combined = AABB::area(AABB::merge(nodes[index].box, box));
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2 * combined;
+        // minimum cost of pushing the leaf further down
+        float inheritance = 2 * (combined - area);
+
+        float costLeft = AABB::area(AABB::merge(nodes[left].box, box)) + inheritance;
+        if (nodes[left].left != -1) {
+            costLeft -= AABB::area(nodes[left].box);
+        }
+        float costRight = AABB::area(AABB::merge(nodes[right].box, box)) + inheritance;
+        if (nodes[right].left != -1) {
+            costRight -= AABB::area(nodes[right].box);
+        }
+
+        if (cost < costLeft && cost < costRight) {
+            break;
+        }
+        index = costLeft < costRight ? left : right;
+    }
+
+    // create a new parent for the sibling and the leaf
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].box = AABB::merge(box, nodes[sibling].box);
+    nodes[newParent].left = sibling;
+    nodes[newParent].right = leaf;
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == -1) {
+        root = newParent;
+    } else if (nodes[oldParent].left == sibling) {
+        nodes[oldParent].left = newParent;
+    } else {
+        nodes[oldParent].right = newParent;
+    }
+
+    refitUp(newParent);
+}
+
+/**
+ * Unlinks a leaf from the tree (the leaf node itself is kept)
+ */
+void AABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = -1;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    if (grandParent == -1) {
+        root = sibling;
+        nodes[sibling].parent = -1;
+    } else {
+        // replace the parent with the sibling
+        if (nodes[grandParent].left == parent) {
+            nodes[grandParent].left = sibling;
+        } else {
+            nodes[grandParent].right = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        refitUp(grandParent);
+    }
+    freeNode(parent);
+    nodes[leaf].parent = -1;
+}
+
+/**
+ * Refits the boxes and heights of a node and its ancestors, rotating any whose children differ in height by more than one
+ * (so sorted or clustered inserts cannot grow the tree into a list, and every path stays O(log n) long)
+ */
+void AABBTree::refitUp(int index) {
+    while (index != -1) {
+        index = balance(index);
+        refit(index);
+        index = nodes[index].parent;
+    }
+}
+
+/**
+ * Rotates the taller child of a node above it if the node is unbalanced
+ * The child takes the node's place and keeps its own taller child, handing the other one to the node
+ * @return the node now at the top of the subtree
+ */
+int AABBTree::balance(int node) {
+    int left = nodes[node].left;
+    int right = nodes[node].right;
+    if (left == -1) {
+        return node;
+    }
+    int difference = nodes[right].height - nodes[left].height;
+    if (difference >= -1 && difference <= 1) {
+        return node;
+    }
+
+    // the taller child is at least two high, so it has children of its own
+    int up = difference > 0 ? right : left;
+    int keep = nodes[nodes[up].left].height > nodes[nodes[up].right].height ? nodes[up].left : nodes[up].right;
+    int give = keep == nodes[up].left ? nodes[up].right : nodes[up].left;
+
+    int parent = nodes[node].parent;
+    nodes[up].parent = parent;
+    if (parent == -1) {
+        root = up;
+    } else if (nodes[parent].left == node) {
+        nodes[parent].left = up;
+    } else {
+        nodes[parent].right = up;
+    }
+
+    if (up == right) {
+        nodes[node].right = give;
+    } else {
+        nodes[node].left = give;
+    }
+    nodes[give].parent = node;
+    nodes[up].left = node;
+    nodes[up].right = keep;
+    nodes[node].parent = up;
+
+    refit(node);
+    refit(up);
+    return up;
+}
+
+// recomputes an interior node's box and height from its children
+void AABBTree::refit(int node) {
+    int left = nodes[node].left;
+    int right = nodes[node].right;
+    nodes[node].box = AABB::merge(nodes[left].box, nodes[right].box);
+    nodes[node].height = 1 + max(nodes[left].height, nodes[right].height);
+}
+
+/**
+ * Finds all shapes whose boxes overlap a given box
+ * @param box Box to test against
+ * @param result Shapes found are appended to this vector
+ */
+void AABBTree::overlap(const AABB& box, vector<Shape*>& result) const {
+    if (root == -1) {
+        return;
+    }
+    // each query has its own stack, so concurrent queries share nothing they write
+    int stack[AABBTREE_STACK];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!AABB::overlaps(node.box, box)) {
+            continue;
+        }
+        if (node.left == -1) {
+            result.push_back(node.shape);
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+/**
+ * Slab test of a ray against a box
+ * @param ro Ray origin
+ * @param invRd Component-wise inverse of the ray direction
+ * @param maxT Maximum distance along the ray
+ * @param box Box to test against
+ */
+bool AABBTree::rayHitsAABB(const vec3& ro, const vec3& invRd, float maxT, const AABB& box) {
+    vec3 t1 = (box.lower - ro) * invRd;
+    vec3 t2 = (box.upper - ro) * invRd;
+    vec3 tmin = vec3::vmin(t1, t2);
+    vec3 tmax = vec3::vmax(t1, t2);
+
+    float tenter = fmax(fmax(tmin.X(), tmin.Y()), fmax(tmin.Z(), 0.0f));
+    float texit = fmin(fmin(tmax.X(), tmax.Y()), fmin(tmax.Z(), maxT));
+    return tenter <= texit;
+}
+
+/**
+ * Finds all shapes whose boxes are hit by a ray
+ * @param ro Ray origin
+ * @param rd Ray direction
+ * @param maxT Maximum distance along the ray (in multiples of rd)
+ * @param result Shapes found are appended to this vector
+ */
+void AABBTree::raycast(const vec3& ro, const vec3& rd, float maxT, vector<Shape*>& result) const {
+    if (root == -1) {
+        return;
+    }
+    vec3 invRd = vec3::invert(rd);
+
+    int stack[AABBTREE_STACK];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!rayHitsAABB(ro, invRd, maxT, node.box)) {
+            continue;
+        }
+        if (node.left == -1) {
+            result.push_back(node.shape);
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+bool AABBTree::contains(Shape* shape) const {
+    return leaves.find(shape) != leaves.end();
+}
+
+int AABBTree::size() const {
+    return leaves.size();
+}
+
+int AABBTree::getHeight() const {
+    return root == -1 ? -1 : nodes[root].height;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+// Dynamic bounding volume tree over shapes
+#ifndef _AABBTREE_H
+#define _AABBTREE_H
+
+#include "../../common.h"
+
+// deepest tree the query stacks can hold (trees are kept balanced, so this covers far more shapes than fit in memory)
+#define AABBTREE_STACK 64
+
+class AABBTree {
+    public:
+        // margin is how much each leaf box is fattened by, so small movements do not require reinsertion
+        AABBTree(float margin);
+
+        void insert(Shape* shape, const AABB& box);
+        void remove(Shape* shape);
+        // updates the box of a shape, reinserting it only if it has left its fattened box
+        // @return whether or not the shape was reinserted
+        bool move(Shape* shape, const AABB& box);
+
+        // finds all shapes whose (fattened) boxes overlap the given box (queries write nothing, so threads may run them at once)
+        void overlap(const AABB& box, vector<Shape*>& result) const;
+        // finds all shapes whose (fattened) boxes are hit by the ray ro + t*rd for 0 <= t <= maxT
+        void raycast(const vec3& ro, const vec3& rd, float maxT, vector<Shape*>& result) const;
+
+        bool contains(Shape* shape) const;
+        int size() const;
+        // number of nodes on the longest path from the root to a leaf, minus one (-1 when empty)
+        int getHeight() const;
+
+        static bool rayHitsAABB(const vec3& ro, const vec3& invRd, float maxT, const AABB& box);
+
+    private:
+        struct Node {
+            AABB box;
+            Shape* shape;
+            int parent;
+            int left;
+            int right;
+            // 0 for leaves, one more than the taller child for interior nodes
+            int height;
+        };
+
+        int allocateNode();
+        void freeNode(int node);
+        void insertLeaf(int leaf);
+        void removeLeaf(int leaf);
+        // refits and rebalances every node from index up to the root
+        void refitUp(int index);
+        int balance(int node);
+        void refit(int node);
+
+        // nodes are pooled in a single array (unused nodes are chained through parent)
+        vector<Node> nodes;
+        int root;
+        int freeList;
+        float margin;
+
+        unordered_map<Shape*, int> leaves;
+};
+
+#include "aabbtree.cpp"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "bodystore.h"
+
+RigidBodyStore::RigidBodyStore() {}
+
+/**
+ * Adds a body to the store
+ * @param com Initial center of mass
+ * @param orientation Initial orientation quaternion
+ * @param mass Mass of the body
+ * @param anchor Whether or not the body is immobilized
+ * @return index of the body
+ */
+int RigidBodyStore::create(const vec3& com, const vec4& orientation, float mass, bool anchor) {
+    int body;
+    if (!freeSlots.empty()) {
+        body = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        body = position.size();
+        position.push_back(vec3(0));
+        linearVelocity.push_back(vec3(0));
+        angularVelocity.push_back(vec3(0));
+        this->orientation.push_back(vec4(0));
+        force.push_back(vec3(0));
+        torque.push_back(vec3(0));
+        invMass.push_back(0);
+        invInertia.push_back(vec3(0));
+        dynamic.push_back(0);
+        revision.push_back(0);
+        used.push_back(0);
+    }
+
+    position[body] = com;
+    linearVelocity[body] = vec3(0);
+    angularVelocity[body] = vec3(0);
+    this->orientation[body] = orientation;
+    force[body] = vec3(0);
+    torque[body] = vec3(0);
+    invMass[body] = 1/mass;
+    invInertia[body] = vec3(0);
+    dynamic[body] = !anchor;
+    // reused slots keep counting, so the new body never shows the revision of the old one
+    revision[body]++;
+    used[body] = 1;
+    return body;
+}
+
+/**
+ * Frees a body's slot (released bodies are skipped by integrate)
+ * @param body Index of the body
+ */
+void RigidBodyStore::release(int body) {
+    used[body] = 0;
+    dynamic[body] = 0;
+    freeSlots.push_back(body);
+}
+
+/**
+ * Moves a body from another store into this one
+ * @param from Store currently holding the body
+ * @param body Index of the body in that store
+ * @return index of the body in this store
+ */
+int RigidBodyStore::transfer(RigidBodyStore& from, int body) {
+    int moved = create(from.position[body], from.orientation[body], 1, !from.dynamic[body]);
+    linearVelocity[moved] = from.linearVelocity[body];
+    angularVelocity[moved] = from.angularVelocity[body];
+    force[moved] = from.force[body];
+    torque[moved] = from.torque[body];
+    invMass[moved] = from.invMass[body];
+    invInertia[moved] = from.invInertia[body];
+    from.release(body);
+    return moved;
+}
+
+/**
+ * Sets the moment of inertia of a body
+ * @param body Index of the body
+ * @param moment Diagonal of the body frame inertia tensor
+ */
+void RigidBodyStore::setInertia(int body, const vec3& moment) {
+    invInertia[body] = vec3::invert(moment);
+}
+
+/**
+ * Integrates every dynamic body, streaming through each array in order
+ * @param dT time difference from previous update
+ */
+void RigidBodyStore::integrate(float dT) {
+    int count = position.size();
+    for (int i = 0; i < count; i ++) {
+        if (dynamic[i]) {
+            integrate(i, dT);
+        }
+    }
+}
+
+/**
+ * Standard body update (gravity, damping, explicit euler position and orientation update)
+ * @param body Index of the body
+ * @param dT time difference from previous update
+ */
+void RigidBodyStore::integrate(int body, float dT) {
+    integrateVelocity(body, dT);
+    integratePosition(body, dT);
+}
+
+/**
+ * Velocity half of the body update (forces, gravity and damping)
+ * @param body Index of the body
+ * @param dT time difference from previous update
+ */
+void RigidBodyStore::integrateVelocity(int body, float dT) {
+    if (!dynamic[body]) {
+        return;
+    }
+
+    // update velocity (with gravity)
+    linearVelocity[body] += (force[body] * invMass[body] + vec3(0, G, 0)) * dT;
+
+    // dampen velocity
+    linearVelocity[body] *= DAMPEN;
+
+    // update angular velocity
+    angularVelocity[body] += invInertia[body] * torque[body] * dT;
+
+    // dampen angular velocity
+    angularVelocity[body] *= DAMPEN;
+
+    // reset sum of forces
+    force[body] = vec3(0);
+    torque[body] = vec3(0);
+}
+
+/**
+ * Position half of the body update (explicit euler position and orientation update)
+ * @param body Index of the body
+ * @param dT time difference from previous update
+ */
+void RigidBodyStore::integratePosition(int body, float dT) {
+    if (!dynamic[body]) {
+        return;
+    }
+
+    // update position
+    position[body] += linearVelocity[body] * dT;
+
+    // update orientation
+    vec3 temp = angularVelocity[body] * dT * 0.5;
+    orientation[body] += orientation[body] * vec4(0, temp.X(), temp.Y(), temp.Z());
+
+    // normalize orientation
+    orientation[body] = vec4::norm(orientation[body]);
+
+    revision[body]++;
+}
+
+int RigidBodyStore::size() const {
+    return position.size();
+}
+
+// store used by shapes that have not been added to a World
+RigidBodyStore defaultBodyStore;
\ No newline at end of file
@@ -0,0 +1,57 @@
+// Structure of arrays rigid body storage
+#ifndef _BODYSTORE_H
+#define _BODYSTORE_H
+
+#include "../../common.h"
+
+class RigidBodyStore {
+    public:
+        RigidBodyStore();
+
+        // adds a body and returns its index
+        int create(const vec3& com, const vec4& orientation, float mass, bool anchor);
+        // frees a body's slot for reuse
+        void release(int body);
+        // moves a body from another store into this one and returns its new index
+        int transfer(RigidBodyStore& from, int body);
+
+        // sets the (diagonal, body frame) moment of inertia of a body
+        void setInertia(int body, const vec3& moment);
+
+        // integrates every dynamic body in the store
+        void integrate(float dT);
+        // integrates a single body (its velocities, then its position)
+        void integrate(int body, float dT);
+        /**
+         * The two halves of integrate, so contacts can be solved between them: velocities take forces, gravity and damping
+         * (and the sums of forces are reset), positions and orientations then move by the velocities
+         */
+        void integrateVelocity(int body, float dT);
+        void integratePosition(int body, float dT);
+
+        // number of slots (including released ones)
+        int size() const;
+
+        // body state, one entry per body
+        vector<vec3> position;
+        vector<vec3> linearVelocity;
+        vector<vec3> angularVelocity;
+        vector<vec4> orientation;
+        vector<vec3> force;
+        vector<vec3> torque;
+        vector<float> invMass;
+        // inverse of the diagonal of the body frame inertia tensor
+        vector<vec3> invInertia;
+        // 1 for bodies that are in use and not anchored
+        vector<unsigned char> dynamic;
+        // bumped whenever a body is created or moved by integrate, so renderers can tell which bodies changed since they last looked
+        vector<unsigned int> revision;
+
+    private:
+        vector<int> freeSlots;
+        vector<unsigned char> used;
+};
+
+#include "bodystore.cpp"
+
+#endif
\ No newline at end of file
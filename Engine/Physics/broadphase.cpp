@@ -0,0 +1,358 @@
+#include "broadphase.h"
+
+// distance moving shapes' tree boxes are fattened by
+#define TREE_MARGIN 0.1
+
+/**
+ * Broadphase constructor
+ * @param type Acceleration structure used to find overlapping pairs
+ */
+Broadphase::Broadphase(BroadphaseType type) : type(type), nextId(0), rebuild(false), dynamicTree(TREE_MARGIN), staticTree(0) {}
+
+/**
+ * Adds a shape to the broadphase
+ * @param shape Shape to track
+ */
+void Broadphase::add(Shape* shape) {
+    Proxy proxy;
+    proxy.shape = shape;
+    proxy.box = shape->getAABB();
+    proxy.id = nextId ++;
+    proxies.push_back(proxy);
+
+    if (type == AABB_TREE) {
+        proxyIndex[shape] = proxies.size() - 1;
+        if (shape->anchor) {
+            staticTree.insert(shape, proxy.box);
+        } else {
+            dynamicTree.insert(shape, proxy.box);
+        }
+    } else {
+        rebuild = true;
+    }
+}
+
+/**
+ * Stops tracking a shape (pairs containing it are dropped on the next update)
+ * @param shape Shape to remove
+ */
+void Broadphase::remove(Shape* shape) {
+    int removed = -1;
+    for (size_t i = 0; i < proxies.size(); i ++) {
+        if (proxies[i].shape == shape) {
+            proxies.erase(proxies.begin() + i);
+            removed = i;
+            break;
+        }
+    }
+    if (type == SWEEP_AND_PRUNE && removed != -1) {
+        // the shape's ends are dropped and the proxies after it move down one
+        for (int axis = 0; axis < 3; axis ++) {
+            vector<SweepEndpoint>& ends = endpoints[axis];
+            size_t kept = 0;
+            for (size_t i = 0; i < ends.size(); i ++) {
+                int proxy = ends[i].data >> 1;
+                if (proxy != removed) {
+                    ends[kept] = ends[i];
+                    ends[kept].data -= proxy > removed ? 2 : 0;
+                    kept ++;
+                }
+            }
+            ends.resize(kept);
+        }
+        for (unordered_map<unsigned long long, BroadphasePair>::iterator it = overlapping.begin(); it != overlapping.end(); ) {
+            it = it->second.a == shape || it->second.b == shape ? overlapping.erase(it) : ++ it;
+        }
+    }
+    if (type == AABB_TREE) {
+        staticTree.remove(shape);
+        dynamicTree.remove(shape);
+
+        proxyIndex.clear();
+        for (size_t i = 0; i < proxies.size(); i ++) {
+            proxyIndex[proxies[i].shape] = i;
+        }
+    }
+}
+
+/**
+ * Key of an unordered pair of proxy ids
+ */
+unsigned long long Broadphase::pairKey(int id1, int id2) {
+    if (id1 > id2) {
+        swap(id1, id2);
+    }
+    return ((unsigned long long)id1 << 32) | (unsigned int)id2;
+}
+
+/**
+ * Records an overlapping pair, carrying over its age from the previous update
+ */
+void Broadphase::addPair(const Proxy& p1, const Proxy& p2) {
+    unsigned long long key = pairKey(p1.id, p2.id);
+    unordered_map<unsigned long long, int>::iterator it = cache.find(key);
+    int age = (it == cache.end()) ? 0 : it->second + 1;
+    nextCache[key] = age;
+
+    BroadphasePair pair;
+    if (p1.id < p2.id) {
+        pair.a = p1.shape;
+        pair.b = p2.shape;
+    } else {
+        pair.a = p2.shape;
+        pair.b = p1.shape;
+    }
+    pair.key = key;
+    pair.age = age;
+    pairs.push_back(pair);
+}
+
+/**
+ * Refreshes every moving proxy's bounding box and finds all overlapping pairs
+ */
+void Broadphase::update() {
+    pairs.clear();
+
+    if (type == AABB_TREE) {
+        nextCache.clear();
+        updateTree();
+        // pairs that stopped overlapping fall out of the cache
+        cache.swap(nextCache);
+    } else {
+        updateSweep();
+    }
+
+    // resolve pairs in the order shapes were added, independent of traversal order
+    sort(pairs.begin(), pairs.end(), [](const BroadphasePair& p1, const BroadphasePair& p2) {
+        return p1.key < p2.key;
+    });
+}
+
+// coordinate of a point along an axis
+static float Broadphase_axis(const vec3& v, int axis) {
+    return axis == 0 ? v.X() : axis == 1 ? v.Y() : v.Z();
+}
+
+// whether an end sorts before another (lower ends go first on ties, as touching boxes overlap)
+static bool Broadphase_before(const SweepEndpoint& a, const SweepEndpoint& b) {
+    return a.value < b.value || (a.value == b.value && !(a.data & 1) && (b.data & 1));
+}
+
+/**
+ * Incremental sweep and prune
+ * Box ends stay sorted along every axis between updates, so after shapes move the insertion sort only swaps ends that
+ * passed each other, and only those swaps can start or end an overlap. An update therefore costs O(n + swaps) rather
+ * than a sweep over every shape, however the shapes are clustered
+ */
+void Broadphase::updateSweep() {
+    for (Proxy& proxy : proxies) {
+        proxy.box = proxy.shape->getAABB();
+    }
+
+    if (rebuild) {
+        rebuildSweep();
+    } else {
+        for (int axis = 0; axis < 3; axis ++) {
+            for (SweepEndpoint& end : endpoints[axis]) {
+                const AABB& box = proxies[end.data >> 1].box;
+                end.value = Broadphase_axis((end.data & 1) ? box.upper : box.lower, axis);
+            }
+            sortAxis(axis);
+        }
+    }
+
+    // every pair found by this update or an earlier one that has not separated since
+    pairs.reserve(overlapping.size());
+    for (unordered_map<unsigned long long, BroadphasePair>::iterator it = overlapping.begin(); it != overlapping.end(); ++ it) {
+        pairs.push_back(it->second);
+        it->second.age ++;
+    }
+}
+
+/**
+ * Sorts every axis' ends from scratch, then finds every overlapping pair by sweeping along the axis the shapes are most
+ * spread out on (the one with the greatest variance of box centers, where the fewest boxes overlap)
+ * Pairs that were already overlapping keep their age
+ */
+void Broadphase::rebuildSweep() {
+    int count = proxies.size();
+    double mean[3] = {0, 0, 0};
+    double square[3] = {0, 0, 0};
+    for (int axis = 0; axis < 3; axis ++) {
+        vector<SweepEndpoint>& ends = endpoints[axis];
+        ends.resize(2 * count);
+        for (int i = 0; i < count; i ++) {
+            float lower = Broadphase_axis(proxies[i].box.lower, axis);
+            float upper = Broadphase_axis(proxies[i].box.upper, axis);
+            ends[2*i].value = lower;
+            ends[2*i].data = 2 * i;
+            ends[2*i+1].value = upper;
+            ends[2*i+1].data = 2 * i + 1;
+            double center = 0.5 * ((double)lower + upper);
+            mean[axis] += center;
+            square[axis] += center * center;
+        }
+        sort(ends.begin(), ends.end(), Broadphase_before);
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; k ++) {
+        if (square[k] - mean[k] * mean[k] / max(count, 1) > square[axis] - mean[axis] * mean[axis] / max(count, 1)) {
+            axis = k;
+        }
+    }
+
+    unordered_map<unsigned long long, BroadphasePair> previous;
+    previous.swap(overlapping);
+    // proxies whose interval along the axis is open at the current end, and where each one is in that list
+    vector<int> open;
+    vector<int> slot(count, -1);
+    for (const SweepEndpoint& end : endpoints[axis]) {
+        int proxy = end.data >> 1;
+        if (end.data & 1) {
+            int last = open.back();
+            open[slot[proxy]] = last;
+            slot[last] = slot[proxy];
+            open.pop_back();
+            continue;
+        }
+        for (int other : open) {
+            addOverlap(proxy, other);
+        }
+        slot[proxy] = open.size();
+        open.push_back(proxy);
+    }
+
+    for (unordered_map<unsigned long long, BroadphasePair>::iterator it = overlapping.begin(); it != overlapping.end(); ++ it) {
+        unordered_map<unsigned long long, BroadphasePair>::const_iterator found = previous.find(it->first);
+        if (found != previous.end()) {
+            it->second.age = found->second.age;
+        }
+    }
+    rebuild = false;
+}
+
+/**
+ * Insertion sorts one axis' ends, which were sorted by the values of the last update
+ * Ends only move down, so a lower end passing an upper end means two boxes now overlap along the axis (they overlap if
+ * they do on the other axes too) and an upper end passing a lower end means they no longer do
+ */
+void Broadphase::sortAxis(int axis) {
+    vector<SweepEndpoint>& ends = endpoints[axis];
+    for (size_t i = 1; i < ends.size(); i ++) {
+        SweepEndpoint end = ends[i];
+        size_t j = i;
+        while (j > 0 && Broadphase_before(end, ends[j-1])) {
+            const SweepEndpoint& passed = ends[j-1];
+            if (!(end.data & 1) && (passed.data & 1)) {
+                addOverlap(end.data >> 1, passed.data >> 1);
+            } else if ((end.data & 1) && !(passed.data & 1)) {
+                removeOverlap(end.data >> 1, passed.data >> 1);
+            }
+            ends[j] = passed;
+            j --;
+        }
+        ends[j] = end;
+    }
+}
+
+/**
+ * Records a pair if the two proxies' boxes overlap on every axis (anchored shapes never collide with each other)
+ */
+void Broadphase::addOverlap(int p1, int p2) {
+    const Proxy& first = proxies[p1];
+    const Proxy& second = proxies[p2];
+    if ((first.shape->anchor && second.shape->anchor) || !AABB::overlaps(first.box, second.box)) {
+        return;
+    }
+    unsigned long long key = pairKey(first.id, second.id);
+    if (overlapping.count(key)) {
+        return;
+    }
+
+    BroadphasePair pair;
+    pair.a = first.id < second.id ? first.shape : second.shape;
+    pair.b = first.id < second.id ? second.shape : first.shape;
+    pair.key = key;
+    pair.age = 0;
+    overlapping[key] = pair;
+}
+
+void Broadphase::removeOverlap(int p1, int p2) {
+    overlapping.erase(pairKey(proxies[p1].id, proxies[p2].id));
+}
+
+/**
+ * Refits the dynamic tree and queries each moving shape against both trees
+ */
+void Broadphase::updateTree() {
+    // only moving shapes are refit (the static tree is never rebuilt)
+    for (Proxy& proxy : proxies) {
+        if (!proxy.shape->anchor) {
+            proxy.box = proxy.shape->getAABB();
+            dynamicTree.move(proxy.shape, proxy.box);
+        }
+    }
+
+    for (const Proxy& proxy : proxies) {
+        if (proxy.shape->anchor) {
+            continue;
+        }
+
+        candidates.clear();
+        dynamicTree.overlap(proxy.box, candidates);
+        for (Shape* shape : candidates) {
+            const Proxy& other = proxies[proxyIndex.at(shape)];
+            // each moving pair is found from both sides, so only keep one of them
+            if (other.id > proxy.id && AABB::overlaps(proxy.box, other.box)) {
+                addPair(proxy, other);
+            }
+        }
+
+        candidates.clear();
+        staticTree.overlap(proxy.box, candidates);
+        for (Shape* shape : candidates) {
+            addPair(proxy, proxies[proxyIndex.at(shape)]);
+        }
+    }
+}
+
+const vector<BroadphasePair>& Broadphase::getPairs() const {
+    return pairs;
+}
+
+/**
+ * Finds all shapes whose bounding boxes overlap a given box
+ */
+void Broadphase::overlap(const AABB& box, vector<Shape*>& result) const {
+    if (type == AABB_TREE) {
+        staticTree.overlap(box, result);
+        dynamicTree.overlap(box, result);
+        return;
+    }
+    for (const Proxy& proxy : proxies) {
+        if (AABB::overlaps(proxy.box, box)) {
+            result.push_back(proxy.shape);
+        }
+    }
+}
+
+/**
+ * Finds all shapes whose bounding boxes are hit by the ray ro + t*rd for 0 <= t <= maxT
+ */
+void Broadphase::raycast(const vec3& ro, const vec3& rd, float maxT, vector<Shape*>& result) const {
+    if (type == AABB_TREE) {
+        staticTree.raycast(ro, rd, maxT, result);
+        dynamicTree.raycast(ro, rd, maxT, result);
+        return;
+    }
+    vec3 invRd = vec3::invert(rd);
+    for (const Proxy& proxy : proxies) {
+        if (AABBTree::rayHitsAABB(ro, invRd, maxT, proxy.box)) {
+            result.push_back(proxy.shape);
+        }
+    }
+}
+
+BroadphaseType Broadphase::getType() const {
+    return type;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+// Broadphase (sweep and prune or AABB trees)
+#ifndef _BROADPHASE_H
+#define _BROADPHASE_H
+
+#include "../../common.h"
+
+// a candidate pair of shapes whose bounding boxes overlap
+struct BroadphasePair {
+    Shape* a;
+    Shape* b;
+    // key identifying the pair across updates
+    unsigned long long key;
+    // number of consecutive updates the pair has been overlapping (0 for a new pair)
+    int age;
+};
+
+// an end of a shape's bounding box along one axis (see Broadphase::sortAxis)
+struct SweepEndpoint {
+    float value;
+    // index of the shape's proxy times two, plus one for the upper end
+    int data;
+};
+
+enum BroadphaseType {
+    // box ends kept sorted along every axis between updates, with pairs changing only where ends swap
+    SWEEP_AND_PRUNE,
+    // dynamic tree for moving shapes and a static tree (never rebuilt) for anchored shapes
+    AABB_TREE
+};
+
+class Broadphase {
+    public:
+        Broadphase(BroadphaseType type);
+
+        void add(Shape* shape);
+        void remove(Shape* shape);
+
+        // recompute bounding boxes and refresh the pair cache
+        void update();
+
+        // overlapping pairs found by the last update (a was added before b)
+        const vector<BroadphasePair>& getPairs() const;
+
+        // scene queries (candidates are tested against bounding boxes only)
+        void overlap(const AABB& box, vector<Shape*>& result) const;
+        void raycast(const vec3& ro, const vec3& rd, float maxT, vector<Shape*>& result) const;
+
+        BroadphaseType getType() const;
+
+    private:
+        struct Proxy {
+            Shape* shape;
+            AABB box;
+            int id;
+        };
+
+        static unsigned long long pairKey(int id1, int id2);
+
+        void updateSweep();
+        void rebuildSweep();
+        void sortAxis(int axis);
+        void addOverlap(int p1, int p2);
+        void removeOverlap(int p1, int p2);
+        void updateTree();
+        void addPair(const Proxy& p1, const Proxy& p2);
+
+        BroadphaseType type;
+
+        vector<Proxy> proxies;
+        // index of each shape's proxy (only maintained in AABB tree mode)
+        unordered_map<Shape*, int> proxyIndex;
+        int nextId;
+
+        // sweep and prune keeps each axis' box ends sorted between updates, so the insertion sort is close to linear
+        vector<SweepEndpoint> endpoints[3];
+        // pairs whose boxes overlap, kept between updates (ages count the updates since each pair started overlapping)
+        unordered_map<unsigned long long, BroadphasePair> overlapping;
+        // shapes were added since the last update, so the ends are sorted and swept from scratch
+        bool rebuild;
+
+        AABBTree dynamicTree;
+        AABBTree staticTree;
+        vector<Shape*> candidates;
+
+        vector<BroadphasePair> pairs;
+        // persistent pair cache of the tree mode, mapping pair keys to their age
+        unordered_map<unsigned long long, int> cache;
+        unordered_map<unsigned long long, int> nextCache;
+};
+
+#include "broadphase.cpp"
+
+#endif
\ No newline at end of file
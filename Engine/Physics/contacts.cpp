@@ -0,0 +1,314 @@
+#include "contacts.h"
+
+ContactManifold::ContactManifold() : a(NULL), b(NULL), key(0), restitution(0), friction(0) {}
+
+/**
+ * Contact solver constructor (10 iterations, warm starting enabled)
+ */
+ContactSolver::ContactSolver() : iterations(10), warmStarting(true) {}
+
+/**
+ * Multiplies a world space vector by the inverse inertia tensor of a shape (rotated into world space)
+ * Anchored shapes have an infinite inertia
+ */
+static vec3 invInertiaWorld(const Shape& shape, const vec3& v) {
+    if (shape.anchor) {
+        return vec3(0);
+    }
+    vec4 q = shape.rot();
+    vec4 conj = vec4(q.X(), -q.Y(), -q.Z(), -q.W());
+    return vec3::rotate(shape.invInertia() * vec3::rotate(v, conj), q);
+}
+
+static float invMassOf(const Shape& shape) {
+    return shape.anchor ? 0 : shape.invMass();
+}
+
+static vec4 conjugate(const vec4& q) {
+    return vec4(q.X(), -q.Y(), -q.Z(), -q.W());
+}
+
+// turns an orientation by a small rotation vector, as RigidBodyStore::integratePosition does
+static void turn(vec4& q, const vec3& theta) {
+    vec3 half = theta * 0.5f;
+    q += q * vec4(0, half.X(), half.Y(), half.Z());
+    q = vec4::norm(q);
+}
+
+/**
+ * Prepares the solver for a new step
+ * @param pairs This step's broadphase pairs
+ */
+void ContactSolver::begin(const vector<BroadphasePair>& pairs) {
+    previous.swap(manifolds);
+    previousIndex.clear();
+    for (int i = 0; i < (int)previous.size(); i ++) {
+        if (!previous[i].points.empty()) {
+            previousIndex[previous[i].key] = i;
+        }
+    }
+    manifolds.assign(pairs.size(), ContactManifold());
+}
+
+/**
+ * Finds, prepares and solves the contacts of a set of pairs
+ * @param pairs This step's broadphase pairs (as passed to begin)
+ * @param indices Indices of the pairs to solve
+ * @param count Number of indices
+ */
+void ContactSolver::solve(const vector<BroadphasePair>& pairs, const int* indices, int count) {
+    for (int i = 0; i < count; i ++) {
+        ContactManifold& manifold = manifolds[indices[i]];
+        if (collide(pairs[indices[i]], manifold)) {
+            prepare(manifold);
+        }
+    }
+
+    // every manifold is prepared before any impulse is carried over, so approach velocities are measured undisturbed
+    for (int i = 0; i < count; i ++) {
+        ContactManifold& manifold = manifolds[indices[i]];
+        if (!manifold.points.empty()) {
+            warmStart(manifold);
+        }
+    }
+
+    for (int j = 0; j < iterations; j ++) {
+        for (int i = 0; i < count; i ++) {
+            ContactManifold& manifold = manifolds[indices[i]];
+            if (!manifold.points.empty()) {
+                solveVelocities(manifold);
+            }
+        }
+    }
+}
+
+/**
+ * Runs the narrowphase for a pair
+ * @param pair Pair to check
+ * @param manifold Manifold to fill
+ * @return whether or not the pair is touching
+ */
+bool ContactSolver::collide(const BroadphasePair& pair, ContactManifold& manifold) const {
+    // routines exist for one order of each pair of shape types
+    Shape* a = pair.a;
+    Shape* b = pair.b;
+    CollisionFunc narrowphase = collisionTable[a->type][b->type];
+    if (narrowphase == NULL) {
+        swap(a, b);
+        narrowphase = collisionTable[a->type][b->type];
+        if (narrowphase == NULL) {
+            return false;
+        }
+    }
+
+    Collision res;
+    narrowphase(&res, *a, *b);
+    if (!res.col || res.man.empty()) {
+        return false;
+    }
+
+    manifold.a = a;
+    manifold.b = b;
+    manifold.key = pair.key;
+    manifold.normal = vec3::norm(res.n);
+    manifold.restitution = a->e * b->e;
+    manifold.friction = FRICTION;
+
+    // any two directions orthogonal to the normal span the friction plane
+    vec3 n = manifold.normal;
+    if (abs(n.X()) >= 0.57735f) {
+        manifold.tangent[0] = vec3::norm(vec3(n.Y(), -n.X(), 0));
+    } else {
+        manifold.tangent[0] = vec3::norm(vec3(0, n.Z(), -n.Y()));
+    }
+    manifold.tangent[1] = vec3::cross(n, manifold.tangent[0]);
+
+    const ContactManifold* old = NULL;
+    if (warmStarting) {
+        unordered_map<unsigned long long, int>::const_iterator it = previousIndex.find(pair.key);
+        if (it != previousIndex.end() && previous[it->second].a == a) {
+            old = &previous[it->second];
+        }
+    }
+
+    manifold.points.clear();
+    for (int i = 0; i < (int)res.man.size(); i ++) {
+        ContactPoint point;
+        point.position = res.man[i];
+        point.depth = i < (int)res.depths.size() ? res.depths[i] : res.pen;
+        point.id = i < (int)res.ids.size() ? res.ids[i] : i;
+
+        if (old != NULL) {
+            for (const ContactPoint& match : old->points) {
+                if (match.id == point.id) {
+                    point.normalImpulse = match.normalImpulse;
+                    point.tangentImpulse[0] = match.tangentImpulse[0];
+                    point.tangentImpulse[1] = match.tangentImpulse[1];
+                    break;
+                }
+            }
+        }
+        manifold.points.push_back(point);
+    }
+    return true;
+}
+
+/**
+ * Computes the effective masses and target normal velocity of each point
+ * @param manifold Manifold to prepare
+ */
+void ContactSolver::prepare(ContactManifold& manifold) const {
+    const Shape& a = *manifold.a;
+    const Shape& b = *manifold.b;
+    float invMass = invMassOf(a) + invMassOf(b);
+
+    for (ContactPoint& point : manifold.points) {
+        point.ra = point.position - a.com();
+        point.rb = point.position - b.com();
+        point.localA = vec3::rotate(point.ra, conjugate(a.rot()));
+        point.localB = vec3::rotate(point.rb, conjugate(b.rot()));
+
+        vec3 n = manifold.normal;
+        float kn = invMass +
+            vec3::dot(n, vec3::cross(invInertiaWorld(a, vec3::cross(point.ra, n)), point.ra)) +
+            vec3::dot(n, vec3::cross(invInertiaWorld(b, vec3::cross(point.rb, n)), point.rb));
+        point.normalMass = kn > 0 ? 1 / kn : 0;
+
+        for (int i = 0; i < 2; i ++) {
+            vec3 t = manifold.tangent[i];
+            float kt = invMass +
+                vec3::dot(t, vec3::cross(invInertiaWorld(a, vec3::cross(point.ra, t)), point.ra)) +
+                vec3::dot(t, vec3::cross(invInertiaWorld(b, vec3::cross(point.rb, t)), point.rb));
+            point.tangentMass[i] = kt > 0 ? 1 / kt : 0;
+        }
+
+        // only fast approaching points bounce, penetration is left to solvePositions
+        vec3 dv = a.linv() + vec3::cross(a.angv(), point.ra) - b.linv() - vec3::cross(b.angv(), point.rb);
+        float vn = vec3::dot(dv, n);
+        point.bias = vn < -RESTITUTION_THRESHOLD ? -manifold.restitution * vn : 0;
+    }
+}
+
+/**
+ * Applies the impulses carried over from the last step (or resets them if warm starting is disabled)
+ * @param manifold Manifold to warm start
+ */
+void ContactSolver::warmStart(ContactManifold& manifold) const {
+    for (ContactPoint& point : manifold.points) {
+        if (warmStarting) {
+            vec3 P = manifold.normal * point.normalImpulse + manifold.tangent[0] * point.tangentImpulse[0] + manifold.tangent[1] * point.tangentImpulse[1];
+            applyImpulse(manifold, point, P);
+        } else {
+            point.normalImpulse = 0;
+            point.tangentImpulse[0] = 0;
+            point.tangentImpulse[1] = 0;
+        }
+    }
+}
+
+/**
+ * One sequential impulse iteration over a manifold's points (normal impulses, then friction)
+ * @param manifold Manifold to solve
+ */
+void ContactSolver::solveVelocities(ContactManifold& manifold) const {
+    const Shape& a = *manifold.a;
+    const Shape& b = *manifold.b;
+
+    for (ContactPoint& point : manifold.points) {
+        // accumulated normal impulse must stay non negative (contacts can only push)
+        vec3 dv = a.linv() + vec3::cross(a.angv(), point.ra) - b.linv() - vec3::cross(b.angv(), point.rb);
+        float dPn = point.normalMass * (point.bias - vec3::dot(dv, manifold.normal));
+        float Pn = max(point.normalImpulse + dPn, 0.0f);
+        dPn = Pn - point.normalImpulse;
+        point.normalImpulse = Pn;
+        applyImpulse(manifold, point, manifold.normal * dPn);
+
+        // friction is bounded by the normal impulse
+        float maxPt = manifold.friction * point.normalImpulse;
+        for (int i = 0; i < 2; i ++) {
+            vec3 t = manifold.tangent[i];
+            dv = a.linv() + vec3::cross(a.angv(), point.ra) - b.linv() - vec3::cross(b.angv(), point.rb);
+            float dPt = -point.tangentMass[i] * vec3::dot(dv, t);
+            float Pt = max(-maxPt, min(point.tangentImpulse[i] + dPt, maxPt));
+            dPt = Pt - point.tangentImpulse[i];
+            point.tangentImpulse[i] = Pt;
+            applyImpulse(manifold, point, t * dPt);
+        }
+    }
+}
+
+void ContactSolver::solvePositions(const int* indices, int count) {
+    for (int j = 0; j < CONTACT_POSITION_ITERATIONS; j ++) {
+        for (int i = 0; i < count; i ++) {
+            ContactManifold& manifold = manifolds[indices[i]];
+            if (manifold.points.empty()) {
+                continue;
+            }
+            Shape& a = *manifold.a;
+            Shape& b = *manifold.b;
+            vec3 n = manifold.normal;
+            float invMass = invMassOf(a) + invMassOf(b);
+
+            for (const ContactPoint& point : manifold.points) {
+                // the contact points follow their bodies, so the penetration is what the moves since prepare left of it
+                vec3 ra = vec3::rotate(point.localA, a.rot());
+                vec3 rb = vec3::rotate(point.localB, b.rot());
+                float depth = point.depth - vec3::dot(a.com() + ra - b.com() - rb, n);
+
+                // points shallower than SLOP are allowed to sink, so resting contacts do not flicker in and out of existence
+                float correction = min(max((float)BAUMGARTE * (depth - (float)SLOP), 0.0f), (float)CONTACT_MAX_CORRECTION);
+                if (correction <= 0) {
+                    continue;
+                }
+                float k = invMass +
+                    vec3::dot(n, vec3::cross(invInertiaWorld(a, vec3::cross(ra, n)), ra)) +
+                    vec3::dot(n, vec3::cross(invInertiaWorld(b, vec3::cross(rb, n)), rb));
+                if (k <= 0) {
+                    continue;
+                }
+
+                vec3 P = n * (correction / k);
+                if (!a.anchor) {
+                    a.com() += P * a.invMass();
+                    turn(a.rot(), invInertiaWorld(a, vec3::cross(ra, P)));
+                }
+                if (!b.anchor) {
+                    b.com() -= P * b.invMass();
+                    turn(b.rot(), invInertiaWorld(b, vec3::cross(rb, P)) * -1);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Applies an impulse at a contact point, to a and opposite to b (anchored shapes are never written)
+ */
+void ContactSolver::applyImpulse(ContactManifold& manifold, const ContactPoint& point, const vec3& P) {
+    Shape& a = *manifold.a;
+    Shape& b = *manifold.b;
+    if (!a.anchor) {
+        a.linv() += P * a.invMass();
+        a.angv() += invInertiaWorld(a, vec3::cross(point.ra, P));
+    }
+    if (!b.anchor) {
+        b.linv() -= P * b.invMass();
+        b.angv() -= invInertiaWorld(b, vec3::cross(point.rb, P));
+    }
+}
+
+void ContactSolver::setIterations(int iterations) {
+    this->iterations = max(iterations, 1);
+}
+
+int ContactSolver::getIterations() const {
+    return iterations;
+}
+
+void ContactSolver::setWarmStarting(bool warmStarting) {
+    this->warmStarting = warmStarting;
+}
+
+bool ContactSolver::isWarmStarting() const {
+    return warmStarting;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+// Persistent contact manifolds and the sequential impulse contact solver
+#ifndef _CONTACTS_H
+#define _CONTACTS_H
+
+#include "../../common.h"
+
+// passes of the position solver per step (each pushes every point a fraction BAUMGARTE of its penetration apart)
+#define CONTACT_POSITION_ITERATIONS 3
+// largest correction a point takes per pass, so deep penetrations are resolved over several steps instead of launching bodies
+#define CONTACT_MAX_CORRECTION 0.2
+
+struct ContactPoint {
+    vec3 position;
+    // offsets of the contact from each body's center of mass
+    vec3 ra;
+    vec3 rb;
+    // the same offsets in each body's frame, which the position solver follows the bodies by
+    vec3 localA;
+    vec3 localB;
+    float depth = 0;
+    // feature id (see Collision::ids), used to match the point across frames
+    int id = 0;
+
+    // impulses accumulated over the solver iterations (and carried over to the next frame)
+    float normalImpulse = 0;
+    float tangentImpulse[2] = {0, 0};
+
+    // effective masses and target normal velocity (restitution), computed once per step
+    float normalMass = 0;
+    float tangentMass[2] = {0, 0};
+    float bias = 0;
+};
+
+class ContactManifold {
+    public:
+        ContactManifold();
+
+        // the normal points from b towards a
+        Shape* a;
+        Shape* b;
+        unsigned long long key;
+
+        vec3 normal;
+        vec3 tangent[2];
+        float restitution;
+        float friction;
+
+        vector<ContactPoint> points;
+};
+
+class ContactSolver {
+    public:
+        ContactSolver();
+
+        // swaps this step's manifolds into the cache and makes room for one manifold per pair
+        void begin(const vector<BroadphasePair>& pairs);
+        // runs the narrowphase for a set of pairs and iteratively solves their contact velocities
+        // (pairs in different calls must not share non anchored bodies, so calls can run concurrently)
+        void solve(const vector<BroadphasePair>& pairs, const int* indices, int count);
+        /**
+         * Pushes the bodies of a set of pairs apart where their contacts still penetrate by more than SLOP, moving positions and
+         * orientations directly (called once bodies have moved by their solved velocities, with the indices passed to solve).
+         * Penetration is never corrected through velocities, so the correction is never carried over by warm starting
+         */
+        void solvePositions(const int* indices, int count);
+
+        void setIterations(int iterations);
+        int getIterations() const;
+        void setWarmStarting(bool warmStarting);
+        bool isWarmStarting() const;
+
+    private:
+        // fills a manifold for a pair, copying accumulated impulses from last step's points with the same feature id
+        bool collide(const BroadphasePair& pair, ContactManifold& manifold) const;
+        void prepare(ContactManifold& manifold) const;
+        void warmStart(ContactManifold& manifold) const;
+        void solveVelocities(ContactManifold& manifold) const;
+
+        static void applyImpulse(ContactManifold& manifold, const ContactPoint& point, const vec3& P);
+
+        int iterations;
+        bool warmStarting;
+
+        // manifolds of the current step (indexed like the pairs) and of the previous step (looked up by pair key)
+        vector<ContactManifold> manifolds;
+        vector<ContactManifold> previous;
+        unordered_map<unsigned long long, int> previousIndex;
+};
+
+#include "contacts.cpp"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,455 @@
+#include "integrator.h"
+
+/**
+ * Batch integrator constructor (uses the widest path the cpu supports, in deterministic mode)
+ */
+BatchIntegrator::BatchIntegrator() : path(Simd_detectPath()), deterministic(true) {}
+
+void BatchIntegrator::setPath(SimdPath path) {
+    SimdPath supported = Simd_detectPath();
+    this->path = path > supported ? supported : path;
+}
+
+SimdPath BatchIntegrator::getPath() const {
+    return path;
+}
+
+void BatchIntegrator::setDeterministic(bool deterministic) {
+    this->deterministic = deterministic;
+}
+
+bool BatchIntegrator::isDeterministic() const {
+    return deterministic;
+}
+
+#ifdef SIMD_X86
+
+// the SIMD kernels read vec3/vec4 arrays as packed floats
+static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 must be three packed floats");
+static_assert(sizeof(vec4) == 4 * sizeof(float), "vec4 must be four packed floats");
+
+/**
+ * Loads 4 consecutive vec3's (x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3) as one register per component
+ */
+SSE_TARGET static inline void loadVec3x4(const float* p, __m128& x, __m128& y, __m128& z) {
+    __m128 a = _mm_loadu_ps(p);
+    __m128 b = _mm_loadu_ps(p + 4);
+    __m128 c = _mm_loadu_ps(p + 8);
+
+    __m128 t1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2)); // b2 b3 c0 c1
+    __m128 t2 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 3, 2)); // a2 a3 b0 b1
+    __m128 t3 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)); // a1 a1 b0 b0
+    __m128 t4 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)); // b3 b3 c2 c2
+
+    x = _mm_shuffle_ps(a, t1, _MM_SHUFFLE(3, 0, 3, 0));
+    y = _mm_shuffle_ps(t3, t4, _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(t2, c, _MM_SHUFFLE(3, 0, 3, 0));
+}
+
+/**
+ * Inverse of loadVec3x4
+ */
+SSE_TARGET static inline void storeVec3x4(float* p, __m128 x, __m128 y, __m128 z) {
+    __m128 a = _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 b = _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)), _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 c = _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+
+    _mm_storeu_ps(p, a);
+    _mm_storeu_ps(p + 4, b);
+    _mm_storeu_ps(p + 8, c);
+}
+
+/**
+ * Loads 4 consecutive vec4's as one register per component
+ */
+SSE_TARGET static inline void loadVec4x4(const float* p, __m128& x, __m128& y, __m128& z, __m128& w) {
+    x = _mm_loadu_ps(p);
+    y = _mm_loadu_ps(p + 4);
+    z = _mm_loadu_ps(p + 8);
+    w = _mm_loadu_ps(p + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+}
+
+/**
+ * Inverse of loadVec4x4
+ */
+SSE_TARGET static inline void storeVec4x4(float* p, __m128 x, __m128 y, __m128 z, __m128 w) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(p, x);
+    _mm_storeu_ps(p + 4, y);
+    _mm_storeu_ps(p + 8, z);
+    _mm_storeu_ps(p + 12, w);
+}
+
+/**
+ * Lane mask (all bits set) for the dynamic bodies among 4 consecutive flags
+ */
+SSE_TARGET static inline __m128 loadMask4(const unsigned char* d) {
+    __m128i flags = _mm_set_epi32(d[3], d[2], d[1], d[0]);
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(flags, _mm_setzero_si128()));
+}
+
+// selects a where the mask is set and b elsewhere
+SSE_TARGET static inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/**
+ * Integrates the velocities of bodies 4 at a time, mirroring the operation order of RigidBodyStore::integrateVelocity exactly
+ * @return index of the first body that was not integrated
+ */
+SSE_TARGET static int integrateVelocitiesSSE(RigidBodyStore& bodies, float dT) {
+    int count = bodies.size();
+
+    float* lin = (float*)bodies.linearVelocity.data();
+    float* ang = (float*)bodies.angularVelocity.data();
+    float* frc = (float*)bodies.force.data();
+    float* trq = (float*)bodies.torque.data();
+    const float* im = bodies.invMass.data();
+    const float* ii = (const float*)bodies.invInertia.data();
+    const unsigned char* dyn = bodies.dynamic.data();
+
+    const __m128 vdT = _mm_set1_ps(dT);
+    const __m128 damp = _mm_set1_ps((float)DAMPEN);
+    const __m128 grav = _mm_set1_ps((float)G);
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 mask = loadMask4(dyn + i);
+        if (_mm_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        __m128 fx, fy, fz, tx, ty, tz, lx, ly, lz, ax, ay, az, ix, iy, iz;
+        loadVec3x4(frc + 3*i, fx, fy, fz);
+        loadVec3x4(trq + 3*i, tx, ty, tz);
+        loadVec3x4(lin + 3*i, lx, ly, lz);
+        loadVec3x4(ang + 3*i, ax, ay, az);
+        loadVec3x4(ii + 3*i, ix, iy, iz);
+        __m128 m = _mm_loadu_ps(im + i);
+
+        // update velocity (with gravity) and dampen
+        __m128 nlx = _mm_mul_ps(_mm_add_ps(lx, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fx, m), zero), vdT)), damp);
+        __m128 nly = _mm_mul_ps(_mm_add_ps(ly, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fy, m), grav), vdT)), damp);
+        __m128 nlz = _mm_mul_ps(_mm_add_ps(lz, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(fz, m), zero), vdT)), damp);
+
+        // update angular velocity and dampen
+        __m128 nax = _mm_mul_ps(_mm_add_ps(ax, _mm_mul_ps(_mm_mul_ps(ix, tx), vdT)), damp);
+        __m128 nay = _mm_mul_ps(_mm_add_ps(ay, _mm_mul_ps(_mm_mul_ps(iy, ty), vdT)), damp);
+        __m128 naz = _mm_mul_ps(_mm_add_ps(az, _mm_mul_ps(_mm_mul_ps(iz, tz), vdT)), damp);
+
+        // write back (anchored and released bodies keep their state)
+        storeVec3x4(lin + 3*i, select4(mask, nlx, lx), select4(mask, nly, ly), select4(mask, nlz, lz));
+        storeVec3x4(ang + 3*i, select4(mask, nax, ax), select4(mask, nay, ay), select4(mask, naz, az));
+
+        // reset sum of forces
+        storeVec3x4(frc + 3*i, _mm_andnot_ps(mask, fx), _mm_andnot_ps(mask, fy), _mm_andnot_ps(mask, fz));
+        storeVec3x4(trq + 3*i, _mm_andnot_ps(mask, tx), _mm_andnot_ps(mask, ty), _mm_andnot_ps(mask, tz));
+    }
+    return i;
+}
+
+/**
+ * Integrates the positions and orientations of bodies 4 at a time, mirroring the operation order of
+ * RigidBodyStore::integratePosition exactly
+ * @return index of the first body that was not integrated
+ */
+SSE_TARGET static int integratePositionsSSE(RigidBodyStore& bodies, float dT, bool deterministic) {
+    int count = bodies.size();
+
+    float* pos = (float*)bodies.position.data();
+    const float* lin = (const float*)bodies.linearVelocity.data();
+    const float* ang = (const float*)bodies.angularVelocity.data();
+    float* rot = (float*)bodies.orientation.data();
+    const unsigned char* dyn = bodies.dynamic.data();
+
+    const __m128 vdT = _mm_set1_ps(dT);
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 mask = loadMask4(dyn + i);
+        if (_mm_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        __m128 lx, ly, lz, ax, ay, az, px, py, pz;
+        __m128 qa, qb, qc, qd;
+        loadVec3x4(lin + 3*i, lx, ly, lz);
+        loadVec3x4(ang + 3*i, ax, ay, az);
+        loadVec3x4(pos + 3*i, px, py, pz);
+        loadVec4x4(rot + 4*i, qa, qb, qc, qd);
+
+        // update position
+        __m128 npx = _mm_add_ps(px, _mm_mul_ps(lx, vdT));
+        __m128 npy = _mm_add_ps(py, _mm_mul_ps(ly, vdT));
+        __m128 npz = _mm_add_ps(pz, _mm_mul_ps(lz, vdT));
+
+        // update orientation (q += q * (0, w*dT/2))
+        __m128 hx = _mm_mul_ps(_mm_mul_ps(ax, vdT), half);
+        __m128 hy = _mm_mul_ps(_mm_mul_ps(ay, vdT), half);
+        __m128 hz = _mm_mul_ps(_mm_mul_ps(az, vdT), half);
+
+        __m128 ra = _mm_sub_ps(_mm_sub_ps(_mm_sub_ps(_mm_mul_ps(qa, zero), _mm_mul_ps(qb, hx)), _mm_mul_ps(qc, hy)), _mm_mul_ps(qd, hz));
+        __m128 rb = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(qa, hx), _mm_mul_ps(qb, zero)), _mm_mul_ps(qc, hz)), _mm_mul_ps(qd, hy));
+        __m128 rc = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(qa, hy), _mm_mul_ps(qb, hz)), _mm_mul_ps(qc, zero)), _mm_mul_ps(qd, hx));
+        __m128 rd = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(qa, hz), _mm_mul_ps(qb, hy)), _mm_mul_ps(qc, hx)), _mm_mul_ps(qd, zero));
+
+        __m128 nqa = _mm_add_ps(qa, ra);
+        __m128 nqb = _mm_add_ps(qb, rb);
+        __m128 nqc = _mm_add_ps(qc, rc);
+        __m128 nqd = _mm_add_ps(qd, rd);
+
+        // normalize orientation
+        __m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nqa, nqa), _mm_mul_ps(nqb, nqb)), _mm_mul_ps(nqc, nqc)), _mm_mul_ps(nqd, nqd));
+        if (deterministic) {
+            __m128 mag = _mm_sqrt_ps(dot);
+            nqa = _mm_div_ps(nqa, mag);
+            nqb = _mm_div_ps(nqb, mag);
+            nqc = _mm_div_ps(nqc, mag);
+            nqd = _mm_div_ps(nqd, mag);
+        } else {
+            // one newton iteration on the approximate reciprocal square root
+            __m128 r = _mm_rsqrt_ps(dot);
+            r = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(_mm_mul_ps(half, dot), _mm_mul_ps(r, r))));
+            nqa = _mm_mul_ps(nqa, r);
+            nqb = _mm_mul_ps(nqb, r);
+            nqc = _mm_mul_ps(nqc, r);
+            nqd = _mm_mul_ps(nqd, r);
+        }
+
+        // write back (anchored and released bodies keep their state)
+        storeVec3x4(pos + 3*i, select4(mask, npx, px), select4(mask, npy, py), select4(mask, npz, pz));
+        storeVec4x4(rot + 4*i, select4(mask, nqa, qa), select4(mask, nqb, qb), select4(mask, nqc, qc), select4(mask, nqd, qd));
+    }
+    return i;
+}
+
+// joins two 4 wide registers into one 8 wide register
+AVX2_TARGET static inline __m256 join8(__m128 lo, __m128 hi) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+}
+
+AVX2_TARGET static inline void loadVec3x8(const float* p, __m256& x, __m256& y, __m256& z) {
+    __m128 x0, y0, z0, x1, y1, z1;
+    loadVec3x4(p, x0, y0, z0);
+    loadVec3x4(p + 12, x1, y1, z1);
+    x = join8(x0, x1);
+    y = join8(y0, y1);
+    z = join8(z0, z1);
+}
+
+AVX2_TARGET static inline void storeVec3x8(float* p, __m256 x, __m256 y, __m256 z) {
+    storeVec3x4(p, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+    storeVec3x4(p + 12, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+}
+
+AVX2_TARGET static inline void loadVec4x8(const float* p, __m256& x, __m256& y, __m256& z, __m256& w) {
+    __m128 x0, y0, z0, w0, x1, y1, z1, w1;
+    loadVec4x4(p, x0, y0, z0, w0);
+    loadVec4x4(p + 16, x1, y1, z1, w1);
+    x = join8(x0, x1);
+    y = join8(y0, y1);
+    z = join8(z0, z1);
+    w = join8(w0, w1);
+}
+
+AVX2_TARGET static inline void storeVec4x8(float* p, __m256 x, __m256 y, __m256 z, __m256 w) {
+    storeVec4x4(p, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), _mm256_castps256_ps128(w));
+    storeVec4x4(p + 16, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1));
+}
+
+AVX2_TARGET static inline __m256 select8(__m256 mask, __m256 a, __m256 b) {
+    return _mm256_blendv_ps(b, a, mask);
+}
+
+/**
+ * Integrates the velocities of bodies 8 at a time, mirroring the operation order of RigidBodyStore::integrateVelocity exactly
+ * @return index of the first body that was not integrated
+ */
+AVX2_TARGET static int integrateVelocitiesAVX2(RigidBodyStore& bodies, float dT) {
+    int count = bodies.size();
+
+    float* lin = (float*)bodies.linearVelocity.data();
+    float* ang = (float*)bodies.angularVelocity.data();
+    float* frc = (float*)bodies.force.data();
+    float* trq = (float*)bodies.torque.data();
+    const float* im = bodies.invMass.data();
+    const float* ii = (const float*)bodies.invInertia.data();
+    const unsigned char* dyn = bodies.dynamic.data();
+
+    const __m256 vdT = _mm256_set1_ps(dT);
+    const __m256 damp = _mm256_set1_ps((float)DAMPEN);
+    const __m256 grav = _mm256_set1_ps((float)G);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 mask = join8(loadMask4(dyn + i), loadMask4(dyn + i + 4));
+        if (_mm256_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        __m256 fx, fy, fz, tx, ty, tz, lx, ly, lz, ax, ay, az, ix, iy, iz;
+        loadVec3x8(frc + 3*i, fx, fy, fz);
+        loadVec3x8(trq + 3*i, tx, ty, tz);
+        loadVec3x8(lin + 3*i, lx, ly, lz);
+        loadVec3x8(ang + 3*i, ax, ay, az);
+        loadVec3x8(ii + 3*i, ix, iy, iz);
+        __m256 m = _mm256_loadu_ps(im + i);
+
+        // update velocity (with gravity) and dampen
+        __m256 nlx = _mm256_mul_ps(_mm256_add_ps(lx, _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fx, m), zero), vdT)), damp);
+        __m256 nly = _mm256_mul_ps(_mm256_add_ps(ly, _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fy, m), grav), vdT)), damp);
+        __m256 nlz = _mm256_mul_ps(_mm256_add_ps(lz, _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(fz, m), zero), vdT)), damp);
+
+        // update angular velocity and dampen
+        __m256 nax = _mm256_mul_ps(_mm256_add_ps(ax, _mm256_mul_ps(_mm256_mul_ps(ix, tx), vdT)), damp);
+        __m256 nay = _mm256_mul_ps(_mm256_add_ps(ay, _mm256_mul_ps(_mm256_mul_ps(iy, ty), vdT)), damp);
+        __m256 naz = _mm256_mul_ps(_mm256_add_ps(az, _mm256_mul_ps(_mm256_mul_ps(iz, tz), vdT)), damp);
+
+        // write back (anchored and released bodies keep their state)
+        storeVec3x8(lin + 3*i, select8(mask, nlx, lx), select8(mask, nly, ly), select8(mask, nlz, lz));
+        storeVec3x8(ang + 3*i, select8(mask, nax, ax), select8(mask, nay, ay), select8(mask, naz, az));
+
+        // reset sum of forces
+        storeVec3x8(frc + 3*i, _mm256_andnot_ps(mask, fx), _mm256_andnot_ps(mask, fy), _mm256_andnot_ps(mask, fz));
+        storeVec3x8(trq + 3*i, _mm256_andnot_ps(mask, tx), _mm256_andnot_ps(mask, ty), _mm256_andnot_ps(mask, tz));
+    }
+    return i;
+}
+
+/**
+ * Integrates the positions and orientations of bodies 8 at a time, mirroring the operation order of
+ * RigidBodyStore::integratePosition exactly
+ * @return index of the first body that was not integrated
+ */
+AVX2_TARGET static int integratePositionsAVX2(RigidBodyStore& bodies, float dT, bool deterministic) {
+    int count = bodies.size();
+
+    float* pos = (float*)bodies.position.data();
+    const float* lin = (const float*)bodies.linearVelocity.data();
+    const float* ang = (const float*)bodies.angularVelocity.data();
+    float* rot = (float*)bodies.orientation.data();
+    const unsigned char* dyn = bodies.dynamic.data();
+
+    const __m256 vdT = _mm256_set1_ps(dT);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 mask = join8(loadMask4(dyn + i), loadMask4(dyn + i + 4));
+        if (_mm256_movemask_ps(mask) == 0) {
+            continue;
+        }
+
+        __m256 lx, ly, lz, ax, ay, az, px, py, pz;
+        __m256 qa, qb, qc, qd;
+        loadVec3x8(lin + 3*i, lx, ly, lz);
+        loadVec3x8(ang + 3*i, ax, ay, az);
+        loadVec3x8(pos + 3*i, px, py, pz);
+        loadVec4x8(rot + 4*i, qa, qb, qc, qd);
+
+        // update position
+        __m256 npx = _mm256_add_ps(px, _mm256_mul_ps(lx, vdT));
+        __m256 npy = _mm256_add_ps(py, _mm256_mul_ps(ly, vdT));
+        __m256 npz = _mm256_add_ps(pz, _mm256_mul_ps(lz, vdT));
+
+        // update orientation (q += q * (0, w*dT/2))
+        __m256 hx = _mm256_mul_ps(_mm256_mul_ps(ax, vdT), half);
+        __m256 hy = _mm256_mul_ps(_mm256_mul_ps(ay, vdT), half);
+        __m256 hz = _mm256_mul_ps(_mm256_mul_ps(az, vdT), half);
+
+        __m256 ra = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(qa, zero), _mm256_mul_ps(qb, hx)), _mm256_mul_ps(qc, hy)), _mm256_mul_ps(qd, hz));
+        __m256 rb = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qa, hx), _mm256_mul_ps(qb, zero)), _mm256_mul_ps(qc, hz)), _mm256_mul_ps(qd, hy));
+        __m256 rc = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(qa, hy), _mm256_mul_ps(qb, hz)), _mm256_mul_ps(qc, zero)), _mm256_mul_ps(qd, hx));
+        __m256 rd = _mm256_add_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(qa, hz), _mm256_mul_ps(qb, hy)), _mm256_mul_ps(qc, hx)), _mm256_mul_ps(qd, zero));
+
+        __m256 nqa = _mm256_add_ps(qa, ra);
+        __m256 nqb = _mm256_add_ps(qb, rb);
+        __m256 nqc = _mm256_add_ps(qc, rc);
+        __m256 nqd = _mm256_add_ps(qd, rd);
+
+        // normalize orientation
+        __m256 dot = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nqa, nqa), _mm256_mul_ps(nqb, nqb)), _mm256_mul_ps(nqc, nqc)), _mm256_mul_ps(nqd, nqd));
+        if (deterministic) {
+            __m256 mag = _mm256_sqrt_ps(dot);
+            nqa = _mm256_div_ps(nqa, mag);
+            nqb = _mm256_div_ps(nqb, mag);
+            nqc = _mm256_div_ps(nqc, mag);
+            nqd = _mm256_div_ps(nqd, mag);
+        } else {
+            // one newton iteration on the approximate reciprocal square root
+            __m256 r = _mm256_rsqrt_ps(dot);
+            r = _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(_mm256_mul_ps(half, dot), _mm256_mul_ps(r, r))));
+            nqa = _mm256_mul_ps(nqa, r);
+            nqb = _mm256_mul_ps(nqb, r);
+            nqc = _mm256_mul_ps(nqc, r);
+            nqd = _mm256_mul_ps(nqd, r);
+        }
+
+        // write back (anchored and released bodies keep their state)
+        storeVec3x8(pos + 3*i, select8(mask, npx, px), select8(mask, npy, py), select8(mask, npz, pz));
+        storeVec4x8(rot + 4*i, select8(mask, nqa, qa), select8(mask, nqb, qb), select8(mask, nqc, qc), select8(mask, nqd, qd));
+    }
+    return i;
+}
+
+#endif
+
+/**
+ * Integrates every dynamic body in a store using the selected path (leftover bodies use the scalar path)
+ * @param bodies Store to integrate
+ * @param dT time difference from previous update
+ */
+void BatchIntegrator::integrate(RigidBodyStore& bodies, float dT) {
+    integrateVelocities(bodies, dT);
+    integratePositions(bodies, dT);
+}
+
+/**
+ * Updates the velocities of every dynamic body in a store using the selected path
+ * @param bodies Store to integrate
+ * @param dT time difference from previous update
+ */
+void BatchIntegrator::integrateVelocities(RigidBodyStore& bodies, float dT) {
+    int i = 0;
+#ifdef SIMD_X86
+    if (path == SIMD_AVX2) {
+        i = integrateVelocitiesAVX2(bodies, dT);
+    } else if (path == SIMD_SSE) {
+        i = integrateVelocitiesSSE(bodies, dT);
+    }
+#endif
+    int count = bodies.size();
+    for (; i < count; i ++) {
+        bodies.integrateVelocity(i, dT);
+    }
+}
+
+/**
+ * Moves every dynamic body in a store by its velocities using the selected path
+ * @param bodies Store to integrate
+ * @param dT time difference from previous update
+ */
+void BatchIntegrator::integratePositions(RigidBodyStore& bodies, float dT) {
+    int i = 0;
+#ifdef SIMD_X86
+    if (path == SIMD_AVX2) {
+        i = integratePositionsAVX2(bodies, dT, deterministic);
+    } else if (path == SIMD_SSE) {
+        i = integratePositionsSSE(bodies, dT, deterministic);
+    }
+    // the SIMD paths only write body state, so the revisions of the bodies they moved are bumped here
+    for (int j = 0; j < i; j ++) {
+        bodies.revision[j] += bodies.dynamic[j];
+    }
+#endif
+    int count = bodies.size();
+    for (; i < count; i ++) {
+        bodies.integratePosition(i, dT);
+    }
+}
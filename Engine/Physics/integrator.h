@@ -0,0 +1,35 @@
+// Batch (SIMD) rigid body integrator
+#ifndef _INTEGRATOR_H
+#define _INTEGRATOR_H
+
+#include "../../common.h"
+
+class BatchIntegrator {
+    public:
+        // selects the widest path supported by the running cpu
+        BatchIntegrator();
+
+        // integrates every dynamic body in a store
+        void integrate(RigidBodyStore& bodies, float dT);
+        // the halves of integrate (see RigidBodyStore::integrateVelocity), so contacts can be solved between them
+        void integrateVelocities(RigidBodyStore& bodies, float dT);
+        void integratePositions(RigidBodyStore& bodies, float dT);
+
+        // forces a path (falls back to the widest supported path if unsupported): SIMD_SCALAR integrates one body at a
+        // time (RigidBodyStore::integrate), SIMD_SSE 4 bodies per iteration and SIMD_AVX2 8
+        void setPath(SimdPath path);
+        SimdPath getPath() const;
+
+        // in deterministic mode every path produces results bit-identical to the scalar path,
+        // otherwise orientations are normalized with an approximate reciprocal square root
+        void setDeterministic(bool deterministic);
+        bool isDeterministic() const;
+
+    private:
+        SimdPath path;
+        bool deterministic;
+};
+
+#include "integrator.cpp"
+
+#endif
\ No newline at end of file
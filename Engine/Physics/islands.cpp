@@ -0,0 +1,85 @@
+#include "islands.h"
+
+Islands::Islands() {
+    start.push_back(0);
+}
+
+/**
+ * Builds the islands for a set of pairs
+ * @param pairs Candidate collision pairs (pairs of two anchored shapes are expected to be excluded)
+ * @param bodies Number of bodies in the store the shapes belong to
+ */
+void Islands::build(const vector<BroadphasePair>& pairs, int bodies) {
+    parent.resize(bodies);
+    rank.assign(bodies, 0);
+    for (int i = 0; i < bodies; i ++) {
+        parent[i] = i;
+    }
+
+    for (const BroadphasePair& pair : pairs) {
+        if (!pair.a->anchor && !pair.b->anchor) {
+            unite(pair.a->getBody(), pair.b->getBody());
+        }
+    }
+
+    // number islands by first appearance, then bucket the pairs (counting sort keeps their order)
+    vector<int> island(bodies, -1);
+    vector<int> pairIsland(pairs.size());
+    start.assign(1, 0);
+    for (int i = 0; i < (int)pairs.size(); i ++) {
+        const BroadphasePair& pair = pairs[i];
+        int root = find(pair.a->anchor ? pair.b->getBody() : pair.a->getBody());
+        if (island[root] < 0) {
+            island[root] = start.size() - 1;
+            start.push_back(0);
+        }
+        pairIsland[i] = island[root];
+        start[island[root] + 1] ++;
+    }
+    for (int i = 1; i < (int)start.size(); i ++) {
+        start[i] += start[i - 1];
+    }
+
+    order.resize(pairs.size());
+    vector<int> cursor(start.begin(), start.end() - 1);
+    for (int i = 0; i < (int)pairs.size(); i ++) {
+        order[cursor[pairIsland[i]] ++] = i;
+    }
+}
+
+int Islands::size() const {
+    return start.size() - 1;
+}
+
+const int* Islands::getPairs(int island) const {
+    return order.data() + start[island];
+}
+
+int Islands::getPairCount(int island) const {
+    return start[island + 1] - start[island];
+}
+
+// finds the root of a body's set (with path halving)
+int Islands::find(int body) {
+    while (parent[body] != body) {
+        parent[body] = parent[parent[body]];
+        body = parent[body];
+    }
+    return body;
+}
+
+// merges the sets of two bodies (by rank)
+void Islands::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return;
+    }
+    if (rank[a] < rank[b]) {
+        swap(a, b);
+    }
+    parent[b] = a;
+    if (rank[a] == rank[b]) {
+        rank[a] ++;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+// Contact islands (groups of pairs that share non anchored bodies)
+#ifndef _ISLANDS_H
+#define _ISLANDS_H
+
+#include "../../common.h"
+
+class Islands {
+    public:
+        Islands();
+
+        // groups pairs with union find over the bodies they touch
+        // anchored bodies are never written during collision response, so they do not join islands together
+        void build(const vector<BroadphasePair>& pairs, int bodies);
+
+        int size() const;
+        // indices (into the pairs passed to build) of the pairs in an island, in their original order
+        const int* getPairs(int island) const;
+        int getPairCount(int island) const;
+
+    private:
+        int find(int body);
+        void unite(int a, int b);
+
+        // union find forest over body indices
+        vector<int> parent;
+        vector<int> rank;
+
+        // pairs grouped by island, with island i spanning [start[i], start[i + 1])
+        vector<int> order;
+        vector<int> start;
+};
+
+#include "islands.cpp"
+
+#endif
\ No newline at end of file
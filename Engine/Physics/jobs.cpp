@@ -0,0 +1,126 @@
+#include "jobs.h"
+
+/**
+ * Job system constructor
+ * @param threads Total number of threads to run jobs on (including the calling thread)
+ */
+JobSystem::JobSystem(int threads) : job(NULL), remaining(0), generation(0), stopping(false) {
+    threads = max(threads, 1);
+    for (int i = 0; i < threads; i ++) {
+        queues.push_back(unique_ptr<Queue>(new Queue()));
+    }
+    for (int i = 1; i < threads; i ++) {
+        workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Runs a batch of jobs, with the calling thread working alongside the pool
+ * @param count Number of jobs
+ * @param job Function called with the index of each job
+ */
+void JobSystem::parallelFor(int count, const function<void(int)>& job) {
+    if (count <= 0) {
+        return;
+    }
+
+    // no workers (or nothing to share), run inline
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; i ++) {
+            job(i);
+        }
+        return;
+    }
+
+    this->job = &job;
+    remaining = count;
+
+    // deal jobs out round robin, so neighbouring (similarly sized) jobs start on different workers
+    int threads = queues.size();
+    for (int i = 0; i < threads; i ++) {
+        std::lock_guard<std::mutex> guard(queues[i]->lock);
+        for (int j = i; j < count; j += threads) {
+            queues[i]->jobs.push_back(j);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(wakeLock);
+        generation ++;
+    }
+    wake.notify_all();
+
+    while (runJob(0)) {}
+
+    std::unique_lock<std::mutex> lock(doneLock);
+    done.wait(lock, [this] { return remaining == 0; });
+    this->job = NULL;
+}
+
+int JobSystem::getThreads() const {
+    return queues.size();
+}
+
+/**
+ * Main loop of a pool thread (sleeps until a batch is submitted, then works until every queue is empty)
+ * @param worker Index of the worker's queue
+ */
+void JobSystem::workerLoop(int worker) {
+    int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeLock);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        while (runJob(worker)) {}
+    }
+}
+
+bool JobSystem::runJob(int worker) {
+    int index = -1;
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.jobs.empty()) {
+            index = own.jobs.back();
+            own.jobs.pop_back();
+        }
+    }
+
+    // steal from the other queues, starting with the next worker
+    int threads = queues.size();
+    for (int i = 1; i < threads && index < 0; i ++) {
+        Queue& victim = *queues[(worker + i) % threads];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.jobs.empty()) {
+            index = victim.jobs.front();
+            victim.jobs.pop_front();
+        }
+    }
+
+    if (index < 0) {
+        return false;
+    }
+
+    (*job)(index);
+    if (--remaining == 0) {
+        std::lock_guard<std::mutex> guard(doneLock);
+        done.notify_all();
+    }
+    return true;
+}
\ No newline at end of file
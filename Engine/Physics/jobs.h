@@ -0,0 +1,48 @@
+// Work stealing job system
+#ifndef _JOBS_H
+#define _JOBS_H
+
+#include "../../common.h"
+
+class JobSystem {
+    public:
+        // starts threads - 1 workers (the thread calling parallelFor is the remaining worker)
+        JobSystem(int threads);
+        ~JobSystem();
+
+        // runs job(i) for every i in [0, count) across all workers, returning once every job has finished
+        void parallelFor(int count, const function<void(int)>& job);
+
+        int getThreads() const;
+
+    private:
+        // each worker owns a queue, popping jobs from its back while idle workers steal from its front
+        struct Queue {
+            std::mutex lock;
+            deque<int> jobs;
+        };
+
+        void workerLoop(int worker);
+        // runs one job from the worker's own queue, or stolen from another queue
+        // @return false if every queue was empty
+        bool runJob(int worker);
+
+        vector<std::thread> workers;
+        vector<unique_ptr<Queue>> queues;
+
+        const function<void(int)>* job;
+        std::atomic<int> remaining;
+
+        // workers sleep between batches, waking when the generation changes
+        std::mutex wakeLock;
+        std::condition_variable wake;
+        int generation;
+        bool stopping;
+
+        std::mutex doneLock;
+        std::condition_variable done;
+};
+
+#include "jobs.cpp"
+
+#endif
\ No newline at end of file
@@ -0,0 +1,268 @@
+#include "world.h"
+
+/**
+ * World constructor
+ * @param dT Fixed timestep used for every call to step
+ * @param type Broadphase used to find candidate collision pairs
+ */
+World::World(float dT, BroadphaseType type) : broadphase(type), threads(max((int)std::thread::hardware_concurrency(), 1)), dT(dT), substeps(1),
+    accumulator(0), maxSteps(WORLD_MAX_STEPS), dropped(0), steps(0), elapsed(0) {}
+
+/**
+ * Adds a shape to the simulation (the caller retains ownership of the shape, while its body moves into the world's store)
+ * @param shape Shape to add
+ */
+void World::addShape(Shape* shape) {
+    shape->attach(&bodies);
+    shapes.push_back(shape);
+    broadphase.add(shape);
+}
+
+/**
+ * Returns the shapes currently being simulated
+ */
+vector<Shape*>& World::getShapes() {
+    return shapes;
+}
+
+const vector<Shape*>& World::getShapes() const {
+    return shapes;
+}
+
+/**
+ * Returns the store holding the body state of every shape in the world
+ */
+RigidBodyStore& World::getBodies() {
+    return bodies;
+}
+
+BatchIntegrator& World::getIntegrator() {
+    return integrator;
+}
+
+const Broadphase& World::getBroadphase() const {
+    return broadphase;
+}
+
+/**
+ * Returns the shapes whose bounding boxes overlap a given box
+ * @param box Box to test against
+ */
+vector<Shape*> World::overlap(const AABB& box) const {
+    vector<Shape*> result;
+    broadphase.overlap(box, result);
+    return result;
+}
+
+/**
+ * Returns the shapes whose bounding boxes are hit by a ray
+ * @param ro Ray origin
+ * @param rd Ray direction
+ * @param maxT Maximum distance along the ray (in multiples of rd)
+ */
+vector<Shape*> World::raycast(const vec3& ro, const vec3& rd, float maxT) const {
+    vector<Shape*> result;
+    broadphase.raycast(ro, rd, maxT, result);
+    return result;
+}
+
+/**
+ * Advances every shape by a single fixed timestep and resolves collisions between them
+ */
+void World::step() {
+    std::chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // the state the step starts from is what advance blends render poses from
+    previousPosition = bodies.position;
+    previousOrientation = bodies.orientation;
+
+    float h = dT / substeps;
+    for (int i = 0; i < substeps; i ++) {
+        substep(h);
+    }
+
+    std::chrono::duration<double> diff = chrono::steady_clock::now() - start;
+    elapsed += diff.count();
+    steps ++;
+}
+
+/**
+ * Integrates every body and resolves collisions over part of a step (velocities, then contacts, then positions)
+ * @param h Time to advance by
+ */
+void World::substep(float h) {
+    // velocities take gravity and forces first, so contacts are solved against the velocities bodies are about to move by
+    integrator.integrateVelocities(bodies, h);
+
+    // only pairs with overlapping bounding boxes reach the narrowphase
+    broadphase.update();
+    const vector<BroadphasePair>& pairs = broadphase.getPairs();
+
+    // islands share no non anchored bodies, so they can be solved in any order (or at once)
+    // pairs keep their order within an island, so results match solving every pair serially
+    islands.build(pairs, bodies.size());
+    solver.begin(pairs);
+    forEachIsland([this, &pairs](int island) {
+        solver.solve(pairs, islands.getPairs(island), islands.getPairCount(island));
+    });
+
+    // bodies only move once their contacts are solved, so impulses take effect in the step that found them
+    integrator.integratePositions(bodies, h);
+
+    // then whatever penetration is left is pushed out directly
+    forEachIsland([this](int island) {
+        solver.solvePositions(islands.getPairs(island), islands.getPairCount(island));
+    });
+}
+
+/**
+ * Runs a job for every island, across the job system when there is more than one thread and island
+ * @param job Job to run with the index of each island
+ */
+void World::forEachIsland(const function<void(int)>& job) {
+    if (threads > 1 && islands.size() > 1) {
+        if (!jobs || jobs->getThreads() != threads) {
+            jobs.reset(new JobSystem(threads));
+        }
+        jobs->parallelFor(islands.size(), job);
+    } else {
+        for (int i = 0; i < islands.size(); i ++) {
+            job(i);
+        }
+    }
+}
+
+/**
+ * Advances the simulation by a given number of fixed timesteps
+ * @param count Number of steps to take
+ */
+void World::run(int count) {
+    for (int i = 0; i < count; i ++) {
+        step();
+    }
+}
+
+int World::advance(double frameTime) {
+    accumulator += max(frameTime, 0.0);
+    // past the step limit the simulation falls behind real time instead of taking ever longer frames to catch up
+    if (accumulator >= (maxSteps + 1) * dT) {
+        double kept = maxSteps * (double)dT + fmod(accumulator, (double)dT);
+        dropped += accumulator - kept;
+        accumulator = kept;
+    }
+
+    int taken = 0;
+    while (accumulator >= dT && taken < maxSteps) {
+        step();
+        accumulator -= dT;
+        taken ++;
+    }
+    interpolate(getAlpha());
+    return taken;
+}
+
+void World::interpolate(float alpha) {
+    int size = bodies.size();
+    renderPosition.resize(size);
+    renderOrientation.resize(size);
+    renderRevision.resize(size, 0);
+    for (int j = 0; j < size; j ++) {
+        vec3 position = bodies.position[j];
+        vec4 orientation = bodies.orientation[j];
+        // bodies made since the last step have no earlier state to blend from
+        if (bodies.dynamic[j] && j < (int)previousPosition.size()) {
+            position = previousPosition[j] * (1 - alpha) + bodies.position[j] * alpha;
+            // q and -q are the same rotation, so the blend takes whichever is nearer
+            const vec4& from = previousOrientation[j];
+            float sign = vec4::dot(from, bodies.orientation[j]) < 0 ? -1.0f : 1.0f;
+            vec4 blended = from * (1 - alpha) + bodies.orientation[j] * (sign * alpha);
+            float length = vec4::mag(blended);
+            if (length > 0) {
+                orientation = blended / length;
+            }
+        }
+
+        const vec3& p = renderPosition[j];
+        const vec4& q = renderOrientation[j];
+        if (p.X() != position.X() || p.Y() != position.Y() || p.Z() != position.Z() ||
+            q.X() != orientation.X() || q.Y() != orientation.Y() || q.Z() != orientation.Z() || q.W() != orientation.W()) {
+            renderPosition[j] = position;
+            renderOrientation[j] = orientation;
+            renderRevision[j]++;
+        }
+    }
+}
+
+float World::getAlpha() const {
+    return (float)min(accumulator / dT, 1.0);
+}
+
+double World::getDropped() const {
+    return dropped;
+}
+
+void World::setSubsteps(int substeps) {
+    this->substeps = max(substeps, 1);
+}
+
+int World::getSubsteps() const {
+    return substeps;
+}
+
+void World::setMaxSteps(int maxSteps) {
+    this->maxSteps = max(maxSteps, 1);
+}
+
+int World::getMaxSteps() const {
+    return maxSteps;
+}
+
+// bodies made since the last advance have no render pose yet, so they are drawn where they are
+const vec3& World::getRenderPosition(int body) const {
+    return body < (int)renderPosition.size() ? renderPosition[body] : bodies.position[body];
+}
+
+const vec4& World::getRenderOrientation(int body) const {
+    return body < (int)renderOrientation.size() ? renderOrientation[body] : bodies.orientation[body];
+}
+
+unsigned int World::getRenderRevision(int body) const {
+    return body < (int)renderRevision.size() ? renderRevision[body] : 0;
+}
+
+ContactSolver& World::getSolver() {
+    return solver;
+}
+
+void World::setThreads(int threads) {
+    this->threads = max(threads, 1);
+}
+
+int World::getThreads() const {
+    return threads;
+}
+
+float World::getDT() const {
+    return dT;
+}
+
+int World::getSteps() const {
+    return steps;
+}
+
+/**
+ * Returns the total wall time (in seconds) spent inside step
+ */
+double World::getElapsed() const {
+    return elapsed;
+}
+
+/**
+ * Returns the measured physics throughput in steps per second
+ */
+double World::stepsPerSecond() const {
+    if (elapsed <= 0) {
+        return 0;
+    }
+    return steps / elapsed;
+}
\ No newline at end of file
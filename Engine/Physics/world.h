@@ -0,0 +1,111 @@
+// World class (headless physics stepping)
+#ifndef _WORLD_H
+#define _WORLD_H
+
+#include "../../common.h"
+
+// fixed steps advance takes at most per call (time past that is dropped, so a slow frame cannot make the next one slower)
+#define WORLD_MAX_STEPS 5
+
+class World {
+    public:
+        // a world steps a set of shapes at a fixed timestep, independent of any window or gl context
+        World(float dT, BroadphaseType type);
+
+        void addShape(Shape* shape);
+        vector<Shape*>& getShapes();
+        const vector<Shape*>& getShapes() const;
+        RigidBodyStore& getBodies();
+        BatchIntegrator& getIntegrator();
+
+        const Broadphase& getBroadphase() const;
+
+        // shapes whose bounding boxes overlap a box or are hit by a ray
+        vector<Shape*> overlap(const AABB& box) const;
+        vector<Shape*> raycast(const vec3& ro, const vec3& rd, float maxT) const;
+
+        // advance the simulation by one fixed timestep
+        void step();
+        // advance the simulation by a number of fixed timesteps
+        void run(int count);
+
+        /**
+         * Adds the time a frame took to the accumulator and takes every fixed step it covers, then blends the poses
+         * shapes are drawn at between the state before and after the last step (see getRenderPosition)
+         * Only WORLD_MAX_STEPS (or setMaxSteps) steps are taken per call, the rest of the time is dropped
+         * @param frameTime Real time since the last call in seconds
+         * @return number of steps taken
+         */
+        int advance(double frameTime);
+        // fraction of a step the accumulator holds past the last step, which render poses are blended by
+        float getAlpha() const;
+        // simulated time dropped by advance to keep up
+        double getDropped() const;
+
+        // number of equal substeps each fixed step is split into (each one integrates and solves contacts)
+        void setSubsteps(int substeps);
+        int getSubsteps() const;
+        void setMaxSteps(int maxSteps);
+        int getMaxSteps() const;
+
+        /**
+         * Pose of a body as of the last advance: dynamic bodies are blended between the last two steps (orientations
+         * by normalized lerp), anchored ones are where their body is. The render revision of a body is bumped whenever
+         * its pose changes, so renderers can tell which poses changed between frames that took no step
+         */
+        const vec3& getRenderPosition(int body) const;
+        const vec4& getRenderOrientation(int body) const;
+        unsigned int getRenderRevision(int body) const;
+
+        ContactSolver& getSolver();
+
+        // number of threads islands are solved on (1 solves every pair on the calling thread)
+        void setThreads(int threads);
+        int getThreads() const;
+
+        float getDT() const;
+        int getSteps() const;
+        double getElapsed() const;
+        double stepsPerSecond() const;
+
+    private:
+        void forEachIsland(const function<void(int)>& job);
+        void substep(float h);
+        // blends the render poses of every body
+        void interpolate(float alpha);
+
+        // shapes are not owned by the world (but their bodies are, so the world must outlive its shapes)
+        vector<Shape*> shapes;
+        RigidBodyStore bodies;
+        BatchIntegrator integrator;
+        Broadphase broadphase;
+
+        // independent islands are solved concurrently (the job system is started on first use)
+        Islands islands;
+        ContactSolver solver;
+        unique_ptr<JobSystem> jobs;
+        int threads;
+
+        float dT;
+        int substeps;
+
+        // real time not yet simulated, and the simulated time dropped since the world was made (doubles, since a float
+        // accumulator rounds away part of every frame time once it has run for a while)
+        double accumulator;
+        int maxSteps;
+        double dropped;
+        // body poses before the last step, and the poses shapes are drawn at
+        vector<vec3> previousPosition;
+        vector<vec4> previousOrientation;
+        vector<vec3> renderPosition;
+        vector<vec4> renderOrientation;
+        vector<unsigned int> renderRevision;
+
+        // benchmarking information
+        int steps;
+        double elapsed;
+};
+
+#include "world.cpp"
+
+#endif
\ No newline at end of file
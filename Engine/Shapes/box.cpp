@@ -6,17 +6,12 @@
  * @param et_al see Shape constructor
  */
 BBox::BBox(vec3 dim, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, vec3 color, int m, float refidx) : 
-Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), dim(dim) {
+Shape(SHAPE_BOX, mass, com, orientation, elasticity, anchor, color, m, refidx), dim(dim) {
     // dim(l, h, w)
     float Ix = mass * (dim.Y()*dim.Y() + dim.Z()*dim.Z()) / 12;
     float Iy = mass * (dim.X()*dim.X() + dim.Z()*dim.Z()) / 12;
     float Iz = mass * (dim.X()*dim.X() + dim.Y()*dim.Y()) / 12;
-    moment = mtrx3(
-        vec3(Ix, 0, 0),
-        vec3(0, Iy, 0),
-        vec3(0, 0, Iz)
-    );
-    invMoment = moment.inverse();
+    setInertia(vec3(Ix, Iy, Iz));
 }
 
 /**
@@ -24,7 +19,7 @@ Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), dim(dim) {
  */
 vector<vec3> BBox::getEdges() const {
     vector<vec3> edges;
-    vec3 rotdim = vec3::rotate(dim, rot);
+    vec3 rotdim = vec3::rotate(dim, rot());
     edges.insert(edges.end(), {
         vec3(rotdim.X(), 0, 0), 
         vec3(0, rotdim.Y(), 0), 
@@ -41,6 +36,18 @@ vec3 BBox::project(vec3 n) const {
 
 }
 
+/**
+ * Returns the world space axis aligned bounding box of the box
+ */
+AABB BBox::getAABB() const {
+    // dim holds half extents, so the extent along each world axis is the sum of the absolute rotated axes
+    vec3 w = vec3::rotate(vec3(dim.X(), 0, 0), rot());
+    vec3 l = vec3::rotate(vec3(0, dim.Y(), 0), rot());
+    vec3 h = vec3::rotate(vec3(0, 0, dim.Z()), rot());
+    vec3 ext = vec3::abs(w) + vec3::abs(l) + vec3::abs(h);
+    return AABB(com() - ext, com() + ext);
+}
+
 /**
  * Calculate collision object between box (this) on sphere (shape)
  * @param shape Sphere to collide with
@@ -60,30 +67,7 @@ void BBox::collideWith_Sphere(Collision* collision, const Shape& shape, float r)
  * @param dim Dimensions of given box
  */
 void BBox::collideWith_Box(Collision* collision, const Shape& shape, vec3 dimensions) {
-    bool col; 
-    vec3 normal; 
-    double penetration_depth; 
-    vector<vec3> manifold;
-
-    normal = SAT_boxBox(*this, shape, dim, dimensions);
-    if (vec3::dot(normal, normal) == 0) {
-        collision->col = false;
-        return;
-    }
-    //cout << "\n----WOW!----\n";
-    SAT_boxBoxCollision(collision, *this, shape, dim, dimensions);
-    //cout << "\nCollision resulted in: n: "; vec3::printv3(collision->n);
-    //cout << " pen: " << collision->pen << " manifold: "; 
-    //for (vec3 man : collision->man) {
-    //    vec3::printv3(man); cout << "; ";
-    //}
-    //collision->n = normal;
-    //collision->pen = vec3::mag(pointToBox(collision->man.at(0), com, dim, rot));
-    /*vector<vec3> tman;
-    tman.push_back(com);
-    collision->man = tman;
-    collision->col = true;
-    collision->pen = 0.1;*/
+    OBB_boxBoxCollision(collision, *this, shape, dim, dimensions);
 }
 /**
  * Calculate collision object between box (this) on capsule (shape)
@@ -114,13 +98,13 @@ void BBox::collideWith_Capsule(Collision* collision, const Shape& shape, float l
 vector<float> BBox::parseData() const {
     vector<float> returned{
         1,
-        com.X(),
-        com.Y(),
-        com.Z(),
-        rot.X(),
-        rot.Y(),
-        rot.Z(),
-        rot.W(),
+        com().X(),
+        com().Y(),
+        com().Z(),
+        rot().X(),
+        rot().Y(),
+        rot().Z(),
+        rot().W(),
         dim.X(),
         dim.Y(),
         dim.Z(),
@@ -134,7 +118,13 @@ vector<float> BBox::parseData() const {
     return returned;
 }
 
-vector<float> BBox::getVertices() const {
-    vector<float> returned;
-    return returned;
+/**
+ * Returns the dimensions of the shape as found in the table above
+ */
+vec3 BBox::getDimensions() const {
+    return dim;
+}
+
+ArrayView<float> BBox::getVertices() const {
+    return Shape::getVertices();
 }
\ No newline at end of file
@@ -7,7 +7,7 @@
  * @param et_al see Shape constructor
  */
 Capsule::Capsule(float length, float radius, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, vec3 color, int m, float refidx) : 
-Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), l(length), r(radius) {
+Shape(SHAPE_CAPSULE, mass, com, orientation, elasticity, anchor, color, m, refidx), l(length), r(radius) {
     // inertia of a cylinder/two hemispheres
     float tempmcy = l*r*r*PI;
     float tempmhs = (2/3)*r*r*r*PI;
@@ -19,12 +19,7 @@ Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), l(length),
     float Ix = mcy*(l*l/12 + r*r/4) + 2*mhs*(2*r*r/5 + l*l/2 + 3*l*r/8);
     float Iy = mcy*(r*r/2) + 2*mhs*(2*r*r/5);
     float Iz = mcy*(l*l/12 + r*r/4) + 2*mhs*(2*r*r/5 + l*l/2 + 3*l*r/8);
-    moment = mtrx3(
-        vec3(Ix, 0, 0),
-        vec3(0, Iy, 0),
-        vec3(0, 0, Iz)
-    );
-    invMoment = moment.inverse();
+    setInertia(vec3(Ix, Iy, Iz));
 }
 
 /**
@@ -42,6 +37,15 @@ vec3 Capsule::project(vec3 n) const {
 
 }
 
+/**
+ * Returns the world space axis aligned bounding box of the capsule
+ */
+AABB Capsule::getAABB() const {
+    // swept sphere around the segment between both endpoints
+    vec3 ext = vec3::abs(vec3::rotate(vec3(0, l, 0), rot())) + r;
+    return AABB(com() - ext, com() + ext);
+}
+
 /**
  * Calculate collision object between capsule (this) on sphere (shape)
  * @param shape Sphere to collide with
@@ -93,13 +97,13 @@ void Capsule::collideWith_Capsule(Collision* collision, const Shape& shape, floa
 vector<float> Capsule::parseData() const {
     vector<float> returned{
         2,
-        com.X(),
-        com.Y(),
-        com.Z(),
-        rot.X(),
-        rot.Y(),
-        rot.Z(),
-        rot.W(),
+        com().X(),
+        com().Y(),
+        com().Z(),
+        rot().X(),
+        rot().Y(),
+        rot().Z(),
+        rot().W(),
         l,
         r,
         0,
@@ -113,7 +117,13 @@ vector<float> Capsule::parseData() const {
     return returned;
 }
 
-vector<float> Capsule::getVertices() const {
-    vector<float> returned;
-    return returned;
+/**
+ * Returns the dimensions of the shape as found in the table above
+ */
+vec3 Capsule::getDimensions() const {
+    return vec3(l, r, 0);
+}
+
+ArrayView<float> Capsule::getVertices() const {
+    return Shape::getVertices();
 }
\ No newline at end of file
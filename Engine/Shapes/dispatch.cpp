@@ -0,0 +1,35 @@
+#include "dispatch.h"
+
+/** ----- DEFINING COLLISION TABLE -----
+ * A \ B        Sphere      Box         Capsule     Mesh
+ * Sphere       x           x           x           
+ * Box                      x                       
+ * Capsule                                          
+ * Mesh         x                                   
+ * Pairs left empty are resolved from the other side (e.g. box on sphere is handled as sphere on box)
+ */
+
+void collide_SphereSphere(Collision* collision, Shape& a, const Shape& b) {
+    static_cast<Sphere&>(a).Sphere::collideWith_Sphere(collision, b, b.getDimensions().X());
+}
+void collide_SphereBox(Collision* collision, Shape& a, const Shape& b) {
+    static_cast<Sphere&>(a).Sphere::collideWith_Box(collision, b, b.getDimensions());
+}
+void collide_SphereCapsule(Collision* collision, Shape& a, const Shape& b) {
+    vec3 dims = b.getDimensions();
+    static_cast<Sphere&>(a).Sphere::collideWith_Capsule(collision, b, dims.X(), dims.Y(), 0);
+}
+void collide_BoxBox(Collision* collision, Shape& a, const Shape& b) {
+    static_cast<BBox&>(a).BBox::collideWith_Box(collision, b, b.getDimensions());
+}
+void collide_MeshSphere(Collision* collision, Shape& a, const Shape& b) {
+    static_cast<Mesh&>(a).Mesh::collideWith_Sphere(collision, b, b.getDimensions().X());
+}
+
+const CollisionFunc collisionTable[SHAPE_TYPES][SHAPE_TYPES] = {
+    //  Sphere                  Box                 Capsule                 Mesh
+    {   collide_SphereSphere,   collide_SphereBox,  collide_SphereCapsule,  NULL    },  // Sphere
+    {   NULL,                   collide_BoxBox,     NULL,                   NULL    },  // Box
+    {   NULL,                   NULL,               NULL,                   NULL    },  // Capsule
+    {   collide_MeshSphere,     NULL,               NULL,                   NULL    }   // Mesh
+};
\ No newline at end of file
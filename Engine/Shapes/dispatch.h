@@ -0,0 +1,23 @@
+// Shape pair collision dispatch
+#ifndef _DISPATCH_H
+#define _DISPATCH_H
+
+#include "../../common.h"
+
+// compact shape type tag (matches the SHAPE ID column of the parsing table in "shapes.cpp")
+enum ShapeType {
+    SHAPE_SPHERE = 0,
+    SHAPE_BOX = 1,
+    SHAPE_CAPSULE = 2,
+    SHAPE_MESH = 3,
+    SHAPE_TYPES
+};
+
+// narrowphase routine for shape a (this) on shape b
+typedef void (*CollisionFunc)(Collision* collision, Shape& a, const Shape& b);
+
+// narrowphase routines indexed by (type of a, type of b), NULL where no routine exists
+// (defined in "dispatch.cpp", once every shape class is complete)
+extern const CollisionFunc collisionTable[SHAPE_TYPES][SHAPE_TYPES];
+
+#endif
\ No newline at end of file
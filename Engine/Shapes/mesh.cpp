@@ -2,8 +2,8 @@
 
 // all shapes have mass, a center of mass (the position!), orientation (the orientation!), a moment of inertia, and an elasticity value
 // graphical properties include color, material, and refraction index
-Mesh::Mesh(int meshSize, float longD, int meshIndx, string fName, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, vec3 color, int m, float refidx) : 
-Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), meshSize(meshSize), longD(longD), meshIndx(meshIndx), fName(fName) {
+Mesh::Mesh(int meshSize, int meshIndx, string fName, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, vec3 color, int m, float refidx) : 
+Shape(SHAPE_MESH, mass, com, orientation, elasticity, anchor, color, m, refidx), meshSize(meshSize), meshIndx(meshIndx), fName(fName) {
     parseFile();
 }
 
@@ -11,15 +11,15 @@ Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), meshSize(me
 vector<float> Mesh::parseData() const {
     vector<float> returned{
         3,
-        com.X(),
-        com.Y(),
-        com.Z(),
-        rot.X(),
-        rot.Y(),
-        rot.Z(),
-        rot.W(),
+        com().X(),
+        com().Y(),
+        com().Z(),
+        rot().X(),
+        rot().Y(),
+        rot().Z(),
+        rot().W(),
         (float)meshSize,
-        longD,
+        asset->getBoundR(),
         0,
         (float)m,
         refidx,
@@ -31,90 +31,119 @@ vector<float> Mesh::parseData() const {
     return returned;
 }
 
+// mesh size, largest distance (the bounding radius the AABB uses too) and mesh index
+vec3 Mesh::getDimensions() const {
+    return vec3(meshSize, asset->getBoundR(), meshIndx);
+}
+
 // Collision functions
-Collision Mesh::collideWith_Sphere(const Sphere &sphere) {
+/**
+ * Calculate collision object between mesh (this) on sphere (shape)
+ * The closest point of the mesh to the sphere's center is found through the BVH, so the cost grows with the log of
+ * the number of triangles
+ * @param shape Sphere to collide with
+ * @param r Radius of given sphere
+ */
+void Mesh::collideWith_Sphere(Collision* collision, const Shape& shape, float r) {
+    vec3 center = toLocal(shape.com());
+    vec3 closest;
+    int triangle;
+    const MeshBVH& bvh = asset->getBVH();
+    if (!bvh.closestPoint(center, r, closest, triangle)) {
+        collision->col = false;
+        return;
+    }
+
+    // normal points from the sphere's center to the mesh (falls back to the face normal if the center is on the surface)
+    vec3 dir = closest - center;
+    float dist = vec3::mag(dir);
+    vec3 normal = dist > 0 ? dir / dist : bvh.getNormal(triangle);
 
+    // contact point is middle of the mesh point and the deepest point of the sphere
+    vec3 point = (closest + (center + normal * r)) / 2;
+
+    collision->col = true;
+    collision->n = vec3::rotate(normal, vec4::norm(rot()));
+    collision->pen = r - dist;
+    collision->man = vector<vec3>(1, toWorld(point));
+    collision->ids = vector<int>(1, triangle);
 }
-Collision Mesh::collideWith_Box(const BBox &box) {
 
+// Parse saved file (name provided by constructor) to read and define mesh in memory
+void Mesh::parseFile() {
+    asset = MeshRegistry::load(fName);
+    // floats the mesh would take as a triangle soup (as the shader_data layout counts it)
+    meshSize = asset->getIndexCount() * 3;
 }
-Collision Mesh::collideWith_Capsule(const Capsule &capsule) {
 
+// geometry shared with every other instance of the file
+const MeshAsset& Mesh::getAsset() const {
+    return *asset;
 }
-Collision Mesh::collideWith_Mesh(const Mesh &mesh) {
 
+bool Mesh::saveCache(const string& path) const {
+    return asset->saveCache(path);
 }
 
-// Parse saved file (name provided by constructor) to read and define mesh in memory
-void Mesh::parseFile()
-{
-    // taken directly from https://github.com/tinyobjloader/tinyobjloader
-    tinyobj::ObjReaderConfig reader_config;
-    reader_config.mtl_search_path = "./"; // Path to material files
-
-    tinyobj::ObjReader reader;
-
-    if (!reader.ParseFromFile(fName, reader_config)) {
-        if (!reader.Error().empty()) {
-            std::cerr << "TinyObjReader: " << reader.Error();
-        }
-        exit(1);
-    }
+ArrayView<float> Mesh::getVertices() const {
+    return asset->getVertices();
+}
 
-    if (!reader.Warning().empty()) {
-        std::cout << "TinyObjReader: " << reader.Warning();
-    }
+ArrayView<float> Mesh::getNormals() const {
+    return asset->getNormals();
+}
 
-    auto &attrib = reader.GetAttrib();
-    auto &shapes = reader.GetShapes();
-    auto &materials = reader.GetMaterials();
-
-    // Loop over shapes
-    for (size_t s = 0; s < shapes.size(); s++) {
-        // Loop over faces(polygon)
-        size_t index_offset = 0;
-        for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) {
-            size_t fv = size_t(shapes[s].mesh.num_face_vertices[f]);
-
-            // Loop over vertices in the face.
-            for (size_t v = 0; v < fv; v++) {
-                // access to vertex
-                tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-                tinyobj::real_t vx = attrib.vertices[3 * size_t(idx.vertex_index) + 0];
-                tinyobj::real_t vy = attrib.vertices[3 * size_t(idx.vertex_index) + 1];
-                tinyobj::real_t vz = attrib.vertices[3 * size_t(idx.vertex_index) + 2];
-                vertices.insert(vertices.end(), {(float)vx, (float)vy, (float)vz});
-                
-                // Check if `normal_index` is zero or positive. negative = no normal data
-                if (idx.normal_index >= 0) {
-                    tinyobj::real_t nx = attrib.normals[3 * size_t(idx.normal_index) + 0];
-                    tinyobj::real_t ny = attrib.normals[3 * size_t(idx.normal_index) + 1];
-                    tinyobj::real_t nz = attrib.normals[3 * size_t(idx.normal_index) + 2];
-                }
-
-                // Check if `texcoord_index` is zero or positive. negative = no texcoord data
-                if (idx.texcoord_index >= 0) {
-                    tinyobj::real_t tx = attrib.texcoords[2 * size_t(idx.texcoord_index) + 0];
-                    tinyobj::real_t ty = attrib.texcoords[2 * size_t(idx.texcoord_index) + 1];
-                }
-
-                // Optional: vertex colors
-                // tinyobj::real_t red   = attrib.colors[3*size_t(idx.vertex_index)+0];
-                // tinyobj::real_t green = attrib.colors[3*size_t(idx.vertex_index)+1];
-                // tinyobj::real_t blue  = attrib.colors[3*size_t(idx.vertex_index)+2];
-            }
-            index_offset += fv;
-
-            // per-face material
-            shapes[s].mesh.material_ids[f];
-        }
-    }
+ArrayView<float> Mesh::getTexcoords() const {
+    return asset->getTexcoords();
+}
+
+int Mesh::getVertexCount() const {
+    return asset->getVertexCount();
+}
+
+int Mesh::getIndexCount() const {
+    return asset->getIndexCount();
+}
+
+bool Mesh::usesShortIndices() const {
+    return asset->usesShortIndices();
+}
+
+ArrayView<uint16_t> Mesh::getShortIndices() const {
+    return asset->getShortIndices();
+}
+
+ArrayView<uint32_t> Mesh::getLongIndices() const {
+    return asset->getLongIndices();
+}
+
+unsigned int Mesh::getIndex(int i) const {
+    return asset->getIndex(i);
+}
+
+vector<float> Mesh::getTriangles() const {
+    return asset->getTriangles();
+}
+
+// Bounding box of the mesh (uses the bounding radius so it need not be recomputed on rotation)
+AABB Mesh::getAABB() const {
+    return AABB(com() - asset->getBoundR(), com() + asset->getBoundR());
+}
+
+// triangle tree in the mesh's frame
+const MeshBVH& Mesh::getBVH() const {
+    return asset->getBVH();
+}
 
-    meshSize = vertices.size();
+// maps a world space point into the mesh's frame
+vec3 Mesh::toLocal(const vec3& p) const {
+    vec4 q = vec4::norm(rot());
+    return vec3::rotate(p - com(), vec4(q.X(), -q.Y(), -q.Z(), -q.W()));
 }
 
-vector<float> Mesh::getVertices() const {
-    return vertices;
+// maps a point in the mesh's frame into world space
+vec3 Mesh::toWorld(const vec3& p) const {
+    return vec3::rotate(p, vec4::norm(rot())) + com();
 }
 
 // Update shader with relevant data
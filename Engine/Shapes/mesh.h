@@ -4,11 +4,6 @@
 #include "../../common.h"
 
 // utility structs for Mesh
-struct Vertex {
-    float Position[3];
-    float Normal[3];
-    float TexCoords[2];
-};
 struct Texture {
     unsigned int id;
     string type;
@@ -18,23 +13,51 @@ class Mesh : public Shape {
     public:
         // all shapes have mass, a center of mass (the position!), orientation (the orientation!), a moment of inertia, and an elasticity value
         // graphical properties include color, material, and refraction index
-        Mesh(int meshSize, float longD, int meshIndx, string fName, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, 
+        // (the largest distance is the asset's bounding radius, see MeshAsset::getBoundR)
+        Mesh(int meshSize, int meshIndx, string fName, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, 
               vec3 color, int m, float refidx);
         
         // returns an array of width WIDTH
         vector<float> parseData() const override;
+        vec3 getDimensions() const override;
 
         // Collision functions
-        Collision collideWith_Sphere(const Sphere& sphere);
-        Collision collideWith_Box(const BBox& box);
-        Collision collideWith_Capsule(const Capsule& capsule);
-        Collision collideWith_Mesh(const Mesh& mesh);
+        void collideWith_Sphere(Collision* collision, const Shape& shape, float r) override;
         
         // Parse saved file (name provided by constructor) to read and define mesh in memory
+        // (meshes loaded from the same file share their geometry, see MeshRegistry)
         void parseFile();
 
-        // GPU friendly vertices
-        vector<float> getVertices() const override;
+        // geometry shared with every other instance of the file
+        const MeshAsset& getAsset() const;
+        // writes the mesh and its BVH as a binary cache (see MeshAsset::saveCache)
+        bool saveCache(const string& path) const;
+
+        // unique vertex positions, 3 floats per vertex (triangles index into them, see getIndex)
+        ArrayView<float> getVertices() const override;
+        // per vertex normals and texture coordinates (empty if the file has none)
+        ArrayView<float> getNormals() const;
+        ArrayView<float> getTexcoords() const;
+        int getVertexCount() const;
+
+        // 3 indices per triangle, stored in 16 bits when there are at most MESH_SHORT_INDEX_LIMIT vertices
+        int getIndexCount() const;
+        bool usesShortIndices() const;
+        ArrayView<uint16_t> getShortIndices() const;
+        ArrayView<uint32_t> getLongIndices() const;
+        unsigned int getIndex(int i) const;
+
+        // GPU friendly triangle soup, 9 floats per triangle (built on every call)
+        vector<float> getTriangles() const;
+
+        // bounding box of the mesh in any orientation
+        AABB getAABB() const override;
+
+        // triangle tree in the mesh's frame
+        const MeshBVH& getBVH() const;
+        // maps a world space point into the mesh's frame and back (the orientation is used normalized)
+        vec3 toLocal(const vec3& p) const;
+        vec3 toWorld(const vec3& p) const;
 
         //vector<Vertex> vertices;
         //vector<unsigned int> indices;
@@ -46,13 +69,12 @@ class Mesh : public Shape {
     private:
         int meshSize;
         int meshIndx;
-        float longD;
         string fName;
 
         //  render data
         unsigned int VAO, VBO, EBO;
 
-        vector<float> vertices;
+        shared_ptr<const MeshAsset> asset;
 
 };
 
@@ -0,0 +1,425 @@
+#include "meshasset.h"
+
+std::atomic<bool> MeshAsset::caching(true);
+
+std::mutex MeshRegistry::lock;
+unordered_map<string, weak_ptr<const MeshAsset>> MeshRegistry::paths;
+unordered_map<uint64_t, weak_ptr<const MeshAsset>> MeshRegistry::hashes;
+
+/**
+ * Loads a mesh file
+ * @param path Path of an obj file or mesh cache
+ */
+MeshAsset::MeshAsset(const string& path) : source(path), hash(0), boundR(0), indexCount(0) {
+    load();
+    hash = computeHash();
+}
+
+const string& MeshAsset::getPath() const {
+    return source;
+}
+
+uint64_t MeshAsset::getHash() const {
+    return hash;
+}
+
+// Loads the asset's file (an up to date cache of the file is mapped instead, if there is one)
+void MeshAsset::load() {
+    // a cache is used as long as it is at least as new as the obj file it was written from
+    string cache = getCachePath(source);
+    struct stat cacheInfo;
+    struct stat objInfo;
+    bool current = (caching || cache == source) && stat(cache.c_str(), &cacheInfo) == 0 &&
+                   (cache == source || stat(source.c_str(), &objInfo) != 0 || cacheInfo.st_mtime >= objInfo.st_mtime);
+    if (current && loadCache(cache)) {
+        return;
+    }
+    if (cache == source) {
+        std::cerr << "Mesh cache " << source << " could not be loaded\n";
+        exit(1);
+    }
+    if (current) {
+        TRACE_WARN("Mesh cache " << cache << " could not be loaded, parsing " << source);
+    }
+    parseObj();
+}
+
+// Parse an obj file, welding its vertices and building the BVH
+void MeshAsset::parseObj()
+{
+    // large files are parsed across threads, anything the parallel parser leaves to tinyobj is parsed serially
+    ObjData obj;
+    ObjParser parser;
+    if (!parser.parse(source, obj) && !ObjParser::parseSerial(source, obj)) {
+        exit(1);
+    }
+
+    cache.close();
+    parsedVertices.clear();
+    parsedNormals.clear();
+    parsedTexcoords.clear();
+    vector<uint32_t> indices;
+
+    // face corners with the same position, normal and texture coordinates are welded into one vertex
+    // (compared by value, so duplicated records in the file are welded too)
+    unordered_map<Vertex, uint32_t, VertexHash, VertexEqual> welded;
+    bool hasNormals = !obj.normals.empty();
+    bool hasTexcoords = !obj.texcoords.empty();
+
+    // faces are triangulated by the parser, so every 3 indices make a triangle
+    for (size_t c = 0; c < obj.corners.size(); c++) {
+        tinyobj::index_t idx = obj.corners[c];
+        if (idx.vertex_index < 0 || size_t(idx.vertex_index) >= obj.vertices.size() / 3 ||
+            (idx.normal_index >= 0 && size_t(idx.normal_index) >= obj.normals.size() / 3) ||
+            (idx.texcoord_index >= 0 && size_t(idx.texcoord_index) >= obj.texcoords.size() / 2)) {
+            std::cerr << "Mesh " << source << " has a face index out of bounds\n";
+            exit(1);
+        }
+
+        // adding 0 turns -0 into 0, so both weld together
+        Vertex vertex = {};
+        for (int k = 0; k < 3; k++) {
+            vertex.Position[k] = obj.vertices[3 * size_t(idx.vertex_index) + k] + 0.0f;
+        }
+        // Check if `normal_index` is zero or positive. negative = no normal data
+        if (idx.normal_index >= 0) {
+            for (int k = 0; k < 3; k++) {
+                vertex.Normal[k] = obj.normals[3 * size_t(idx.normal_index) + k] + 0.0f;
+            }
+        }
+        // Check if `texcoord_index` is zero or positive. negative = no texcoord data
+        if (idx.texcoord_index >= 0) {
+            for (int k = 0; k < 2; k++) {
+                vertex.TexCoords[k] = obj.texcoords[2 * size_t(idx.texcoord_index) + k] + 0.0f;
+            }
+        }
+
+        pair<unordered_map<Vertex, uint32_t, VertexHash, VertexEqual>::iterator, bool> found = welded.insert(make_pair(vertex, (uint32_t)welded.size()));
+        if (found.second) {
+            parsedVertices.insert(parsedVertices.end(), vertex.Position, vertex.Position + 3);
+            if (hasNormals) {
+                parsedNormals.insert(parsedNormals.end(), vertex.Normal, vertex.Normal + 3);
+            }
+            if (hasTexcoords) {
+                parsedTexcoords.insert(parsedTexcoords.end(), vertex.TexCoords, vertex.TexCoords + 2);
+            }
+        }
+        indices.push_back(found.first->second);
+    }
+
+    // 16 bit indices whenever every vertex can be addressed by one
+    indexCount = indices.size();
+    parsedShortIndices.clear();
+    parsedLongIndices.clear();
+    if (parsedVertices.size() / 3 <= MESH_SHORT_INDEX_LIMIT) {
+        parsedShortIndices.assign(indices.begin(), indices.end());
+    } else {
+        parsedLongIndices.swap(indices);
+    }
+    parsedVertices.shrink_to_fit();
+    parsedNormals.shrink_to_fit();
+    parsedTexcoords.shrink_to_fit();
+    vertices = ArrayView<float>(parsedVertices);
+    normals = ArrayView<float>(parsedNormals);
+    texcoords = ArrayView<float>(parsedTexcoords);
+    shortIndices = ArrayView<uint16_t>(parsedShortIndices);
+    longIndices = ArrayView<uint32_t>(parsedLongIndices);
+
+    // bounding radius of the mesh (rotation invariant)
+    boundR = 0;
+    for (size_t i = 0; i + 2 < vertices.size(); i += 3) {
+        float d = vec3::mag(vec3(vertices[i], vertices[i+1], vertices[i+2]));
+        if (d > boundR) {
+            boundR = d;
+        }
+    }
+
+    if (usesShortIndices()) {
+        bvh.build(vertices, shortIndices.data(), indexCount / 3);
+    } else {
+        bvh.build(vertices, longIndices.data(), indexCount / 3);
+    }
+}
+
+/**
+ * Writes the mesh as a binary cache (see MeshCacheHeader), so later runs can map it instead of parsing the obj file
+ * @param path File to write
+ * @return whether the file was written
+ */
+bool MeshAsset::saveCache(const string& path) const {
+    ofstream out(path.c_str(), ios::binary);
+    if (!out) {
+        return false;
+    }
+
+    MeshCacheHeader header;
+    memcpy(header.magic, "BMSH", 4);
+    header.version = MESH_CACHE_VERSION;
+    header.flags = (normals.empty() ? 0 : MESH_CACHE_NORMALS) | (texcoords.empty() ? 0 : MESH_CACHE_TEXCOORDS) |
+                   (usesShortIndices() ? 0 : MESH_CACHE_LONG_INDICES);
+    header.vertexCount = getVertexCount();
+    header.indexCount = indexCount;
+    header.boundR = boundR;
+    out.write((const char*)&header, sizeof(header));
+
+    out.write((const char*)vertices.data(), vertices.size() * sizeof(float));
+    out.write((const char*)normals.data(), normals.size() * sizeof(float));
+    out.write((const char*)texcoords.data(), texcoords.size() * sizeof(float));
+    if (usesShortIndices()) {
+        out.write((const char*)shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+        if (shortIndices.size() % 2) {
+            uint16_t pad = 0;
+            out.write((const char*)&pad, sizeof(pad));
+        }
+    } else {
+        out.write((const char*)longIndices.data(), longIndices.size() * sizeof(uint32_t));
+    }
+    bvh.write(out);
+
+    return out.good();
+}
+
+/**
+ * Maps a binary cache and serves its buffers and BVH from the mapping, which the asset keeps open
+ * Sizes and indices are checked against the file before anything is used, so a damaged cache is rejected
+ * @param path File to load
+ * @return whether the cache was loaded
+ */
+bool MeshAsset::loadCache(const string& path) {
+    parsedVertices.clear();
+    parsedNormals.clear();
+    parsedTexcoords.clear();
+    parsedShortIndices.clear();
+    parsedLongIndices.clear();
+    vertices = ArrayView<float>();
+    normals = ArrayView<float>();
+    texcoords = ArrayView<float>();
+    shortIndices = ArrayView<uint16_t>();
+    longIndices = ArrayView<uint32_t>();
+    indexCount = 0;
+    boundR = 0;
+
+    if (!cache.open(path) || cache.size() < sizeof(MeshCacheHeader)) {
+        cache.close();
+        return false;
+    }
+    MeshCacheHeader header;
+    memcpy(&header, cache.data(), sizeof(header));
+    if (memcmp(header.magic, "BMSH", 4) != 0 || header.version != MESH_CACHE_VERSION || header.indexCount % 3 != 0) {
+        cache.close();
+        return false;
+    }
+
+    bool longIndex = header.flags & MESH_CACHE_LONG_INDICES;
+    size_t vertexBytes = (size_t)header.vertexCount * 3 * sizeof(float);
+    size_t normalBytes = (header.flags & MESH_CACHE_NORMALS) ? vertexBytes : 0;
+    size_t texcoordBytes = (header.flags & MESH_CACHE_TEXCOORDS) ? (size_t)header.vertexCount * 2 * sizeof(float) : 0;
+    size_t indexBytes = longIndex ? (size_t)header.indexCount * sizeof(uint32_t) : ((size_t)header.indexCount * sizeof(uint16_t) + 3) & ~(size_t)3;
+    if (cache.size() - sizeof(header) < vertexBytes + normalBytes + texcoordBytes + indexBytes) {
+        cache.close();
+        return false;
+    }
+
+    const char* cursor = cache.data() + sizeof(header);
+    // every section starts 4 byte aligned (and mappings start on a page)
+    const float* floats = (const float*)cursor;
+    ArrayView<float> mappedVertices(floats, vertexBytes / sizeof(float));
+    floats += vertexBytes / sizeof(float);
+    ArrayView<float> mappedNormals(floats, normalBytes / sizeof(float));
+    floats += normalBytes / sizeof(float);
+    ArrayView<float> mappedTexcoords(floats, texcoordBytes / sizeof(float));
+    cursor += vertexBytes + normalBytes + texcoordBytes;
+
+    bool valid = true;
+    ArrayView<uint16_t> mappedShort;
+    ArrayView<uint32_t> mappedLong;
+    if (longIndex) {
+        mappedLong = ArrayView<uint32_t>((const uint32_t*)cursor, header.indexCount);
+        for (size_t i = 0; i < mappedLong.size(); i ++) {
+            valid &= mappedLong[i] < header.vertexCount;
+        }
+    } else {
+        mappedShort = ArrayView<uint16_t>((const uint16_t*)cursor, header.indexCount);
+        for (size_t i = 0; i < mappedShort.size(); i ++) {
+            valid &= mappedShort[i] < header.vertexCount;
+        }
+    }
+    cursor += indexBytes;
+
+    if (!valid || !bvh.read(cursor, cache.data() + cache.size(), header.indexCount / 3)) {
+        cache.close();
+        return false;
+    }
+
+    vertices = mappedVertices;
+    normals = mappedNormals;
+    texcoords = mappedTexcoords;
+    shortIndices = mappedShort;
+    longIndices = mappedLong;
+    indexCount = header.indexCount;
+    boundR = header.boundR;
+    return true;
+}
+
+bool MeshAsset::isMapped() const {
+    return cache.isOpen();
+}
+
+// cache path of a mesh file (caches are their own cache)
+string MeshAsset::getCachePath(const string& file) {
+    string extension = MESH_CACHE_EXTENSION;
+    if (file.size() >= extension.size() && file.compare(file.size() - extension.size(), extension.size(), extension) == 0) {
+        return file;
+    }
+    return file + extension;
+}
+
+void MeshAsset::setCaching(bool enabled) {
+    caching = enabled;
+}
+
+bool MeshAsset::usesCaching() {
+    return caching;
+}
+
+// unique vertex positions, 3 floats per vertex
+ArrayView<float> MeshAsset::getVertices() const {
+    return vertices;
+}
+
+// vertex normals, 3 floats per vertex (empty if the file has none)
+ArrayView<float> MeshAsset::getNormals() const {
+    return normals;
+}
+
+// vertex texture coordinates, 2 floats per vertex (empty if the file has none)
+ArrayView<float> MeshAsset::getTexcoords() const {
+    return texcoords;
+}
+
+int MeshAsset::getVertexCount() const {
+    return vertices.size() / 3;
+}
+
+int MeshAsset::getIndexCount() const {
+    return indexCount;
+}
+
+bool MeshAsset::usesShortIndices() const {
+    return longIndices.empty();
+}
+
+// index buffers (only the one selected by usesShortIndices holds the indices)
+ArrayView<uint16_t> MeshAsset::getShortIndices() const {
+    return shortIndices;
+}
+
+ArrayView<uint32_t> MeshAsset::getLongIndices() const {
+    return longIndices;
+}
+
+unsigned int MeshAsset::getIndex(int i) const {
+    return usesShortIndices() ? shortIndices[i] : longIndices[i];
+}
+
+/**
+ * Expands the indexed mesh into a triangle soup (9 floats per triangle), for code that wants every corner written out
+ * @return the triangles
+ */
+vector<float> MeshAsset::getTriangles() const {
+    vector<float> returned(indexCount * 3);
+    for (int i = 0; i < indexCount; i ++) {
+        const float* v = &vertices[3 * getIndex(i)];
+        returned[3*i+0] = v[0];
+        returned[3*i+1] = v[1];
+        returned[3*i+2] = v[2];
+    }
+    return returned;
+}
+
+// largest distance from the mesh origin to any vertex
+float MeshAsset::getBoundR() const {
+    return boundR;
+}
+
+// triangle tree in the mesh's frame
+const MeshBVH& MeshAsset::getBVH() const {
+    return bvh;
+}
+
+// FNV-1a over every buffer (the BVH is built from them, so it need not be hashed)
+uint64_t MeshAsset::computeHash() const {
+    uint64_t value = 14695981039346656037ull;
+    auto mix = [&value](const void* data, size_t bytes) {
+        const unsigned char* p = (const unsigned char*)data;
+        for (size_t i = 0; i < bytes; i ++) {
+            value = (value ^ p[i]) * 1099511628211ull;
+        }
+    };
+    uint32_t counts[4] = {(uint32_t)vertices.size(), (uint32_t)normals.size(), (uint32_t)texcoords.size(), (uint32_t)indexCount};
+    mix(counts, sizeof(counts));
+    mix(vertices.data(), vertices.size() * sizeof(float));
+    mix(normals.data(), normals.size() * sizeof(float));
+    mix(texcoords.data(), texcoords.size() * sizeof(float));
+    mix(shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+    mix(longIndices.data(), longIndices.size() * sizeof(uint32_t));
+    return value;
+}
+
+/**
+ * Finds or loads the asset of a file
+ * Files are loaded outside the lock, so threads loading different files do not wait on each other (two threads
+ * loading the same new file both parse it, and the second keeps the first one's asset)
+ */
+shared_ptr<const MeshAsset> MeshRegistry::load(const string& path) {
+    // paths are resolved, so different spellings of one file share an entry
+#ifdef _WIN32
+    char resolved[_MAX_PATH];
+    string key = _fullpath(resolved, path.c_str(), _MAX_PATH) ? string(resolved) : path;
+#else
+    char resolved[PATH_MAX];
+    string key = realpath(path.c_str(), resolved) ? string(resolved) : path;
+#endif
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        unordered_map<string, weak_ptr<const MeshAsset>>::iterator it = paths.find(key);
+        if (it != paths.end()) {
+            shared_ptr<const MeshAsset> asset = it->second.lock();
+            if (asset) {
+                return asset;
+            }
+        }
+    }
+
+    shared_ptr<const MeshAsset> loaded = make_shared<const MeshAsset>(path);
+
+    std::lock_guard<std::mutex> guard(lock);
+    shared_ptr<const MeshAsset> asset = hashes[loaded->getHash()].lock();
+    // a hash match is only trusted once the buffers agree
+    if (!asset || asset->getVertices() != loaded->getVertices() || asset->getNormals() != loaded->getNormals() ||
+        asset->getTexcoords() != loaded->getTexcoords() || asset->getShortIndices() != loaded->getShortIndices() ||
+        asset->getLongIndices() != loaded->getLongIndices()) {
+        asset = loaded;
+        hashes[asset->getHash()] = asset;
+    }
+    paths[key] = asset;
+
+    // forget assets no instance holds any more
+    for (unordered_map<string, weak_ptr<const MeshAsset>>::iterator it = paths.begin(); it != paths.end(); ) {
+        it = it->second.expired() ? paths.erase(it) : ++ it;
+    }
+    for (unordered_map<uint64_t, weak_ptr<const MeshAsset>>::iterator it = hashes.begin(); it != hashes.end(); ) {
+        it = it->second.expired() ? hashes.erase(it) : ++ it;
+    }
+    return asset;
+}
+
+int MeshRegistry::getAssetCount() {
+    std::lock_guard<std::mutex> guard(lock);
+    int count = 0;
+    for (unordered_map<uint64_t, weak_ptr<const MeshAsset>>::iterator it = hashes.begin(); it != hashes.end(); ++ it) {
+        count += !it->second.expired();
+    }
+    return count;
+}
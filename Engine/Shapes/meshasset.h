@@ -0,0 +1,158 @@
+// Mesh geometry shared between every Mesh loaded from the same file
+#ifndef _MESHASSET_H
+#define _MESHASSET_H
+
+#include "../../common.h"
+
+// utility structs for Mesh
+struct Vertex {
+    float Position[3];
+    float Normal[3];
+    float TexCoords[2];
+};
+
+// vertices are welded by value, so they are hashed and compared by their bits
+struct VertexHash {
+    size_t operator() (const Vertex& vertex) const {
+        uint32_t bits[8];
+        memcpy(bits, &vertex, sizeof(bits));
+        size_t hash = 2166136261u;
+        for (int i = 0; i < 8; i ++) {
+            hash = (hash ^ bits[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+struct VertexEqual {
+    bool operator() (const Vertex& a, const Vertex& b) const {
+        return memcmp(&a, &b, sizeof(Vertex)) == 0;
+    }
+};
+
+// meshes with at most this many vertices are indexed with 16 bits
+#define MESH_SHORT_INDEX_LIMIT 65536
+
+// binary mesh cache, written next to an obj file (see MeshAsset::saveCache)
+#define MESH_CACHE_EXTENSION ".bmesh"
+#define MESH_CACHE_VERSION 2
+#define MESH_CACHE_NORMALS 1
+#define MESH_CACHE_TEXCOORDS 2
+#define MESH_CACHE_LONG_INDICES 4
+
+/**
+ * Start of a mesh cache, followed by the vertex positions, normals and texture coordinates (if flagged), the indices
+ * (padded to 4 bytes) and the BVH (see MeshBVH::write), every value in the machine's byte order and 4 byte aligned, so
+ * a mapped cache is used in place
+ */
+struct MeshCacheHeader {
+    // "BMSH"
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    float boundR;
+};
+
+class MeshAsset {
+    public:
+        // loads a mesh file (use MeshRegistry::load, so every instance of a file shares one asset)
+        MeshAsset(const string& path);
+
+        // path the asset was loaded from
+        const string& getPath() const;
+        // hash of the geometry, identifying assets with the same contents under different paths
+        uint64_t getHash() const;
+
+        // writes the parsed mesh and its BVH as a binary cache
+        bool saveCache(const string& path) const;
+        // maps a cache written by saveCache and serves the buffers and BVH from the mapping, without parsing or copying
+        // anything (every process loading the cache shares its pages)
+        // @return false if the file is missing, from another version or damaged (the asset is left empty)
+        bool loadCache(const string& path);
+        // whether the buffers are served from a mapped cache (rather than parsed from an obj file)
+        bool isMapped() const;
+        // cache path of a mesh file (caches are their own cache)
+        static string getCachePath(const string& file);
+        // whether obj files are loaded from their caches (on by default)
+        static void setCaching(bool enabled);
+        static bool usesCaching();
+
+        // unique vertex positions, 3 floats per vertex (triangles index into them, see getIndex)
+        // buffers are views into the asset, valid as long as it is
+        ArrayView<float> getVertices() const;
+        // per vertex normals and texture coordinates (empty if the file has none)
+        ArrayView<float> getNormals() const;
+        ArrayView<float> getTexcoords() const;
+        int getVertexCount() const;
+
+        // 3 indices per triangle, stored in 16 bits when there are at most MESH_SHORT_INDEX_LIMIT vertices
+        int getIndexCount() const;
+        bool usesShortIndices() const;
+        ArrayView<uint16_t> getShortIndices() const;
+        ArrayView<uint32_t> getLongIndices() const;
+        unsigned int getIndex(int i) const;
+
+        // GPU friendly triangle soup, 9 floats per triangle (built on every call)
+        vector<float> getTriangles() const;
+
+        // largest distance from the mesh origin to any vertex
+        float getBoundR() const;
+        // triangle tree in the mesh's frame
+        const MeshBVH& getBVH() const;
+
+    private:
+        // buffers are views into the asset itself, so copying would leave the copy viewing the original's
+        MeshAsset(const MeshAsset&);
+        MeshAsset& operator= (const MeshAsset&);
+
+        void load();
+        void parseObj();
+        uint64_t computeHash() const;
+
+        static std::atomic<bool> caching;
+
+        string source;
+        uint64_t hash;
+        float boundR;
+
+        // views into the parsed buffers below, or into the mapped cache
+        ArrayView<float> vertices;
+        ArrayView<float> normals;
+        ArrayView<float> texcoords;
+        int indexCount;
+        ArrayView<uint16_t> shortIndices;
+        ArrayView<uint32_t> longIndices;
+        MeshBVH bvh;
+
+        // open while the asset is served from a cache
+        MappedFile cache;
+        vector<float> parsedVertices;
+        vector<float> parsedNormals;
+        vector<float> parsedTexcoords;
+        vector<uint16_t> parsedShortIndices;
+        vector<uint32_t> parsedLongIndices;
+};
+
+// reference counted assets, so memory grows with the number of distinct meshes rather than the number of instances
+class MeshRegistry {
+    public:
+        /**
+         * Finds the asset of a file, loading it if no instance holds it
+         * Files are matched by path first and then by the hash of their geometry, so copies of a file share one asset
+         * @param path Path of an obj file or mesh cache
+         * @return the asset (released once the last instance holding it is destroyed)
+         */
+        static shared_ptr<const MeshAsset> load(const string& path);
+        // number of assets held by at least one instance
+        static int getAssetCount();
+
+    private:
+        static std::mutex lock;
+        static unordered_map<string, weak_ptr<const MeshAsset>> paths;
+        static unordered_map<uint64_t, weak_ptr<const MeshAsset>> hashes;
+};
+
+#include "meshasset.cpp"
+
+#endif
\ No newline at end of file
@@ -8,45 +8,66 @@ class Shape {
     public:
         // all shapes have mass, a center of mass (the position!), orientation (the orientation!), a moment of inertia, an elasticity value, and whether or not the object is immobilized
         // graphical properties include color, material, and refraction index
-        Shape(float mass, vec3 &com, vec4 &orientation, float elasticity, bool anchor, vec3 &color, int m, float refidx);
+        Shape(ShapeType type, float mass, vec3 &com, vec4 &orientation, float elasticity, bool anchor, vec3 &color, int m, float refidx);
+        Shape(const Shape& shape);
+        virtual ~Shape();
+        Shape& operator= (const Shape& shape);
 
         void applyForce(vec3 n);
         void applyTorque(vec3 F, vec3 d);
         void updateLoop(float dT);
 
+        // body state lives in a RigidBodyStore, the shape only holds its index
+        vec3& com();
+        const vec3& com() const;
+        vec3& linv();
+        const vec3& linv() const;
+        vec4& rot();
+        const vec4& rot() const;
+        vec3& angv();
+        const vec3& angv() const;
+        float invMass() const;
+        const vec3& invInertia() const;
+
+        // sets the (diagonal, body frame) moment of inertia
+        void setInertia(const vec3& moment);
+
+        // moves the shape's body into another store (the store must outlive the shape)
+        void attach(RigidBodyStore* store);
+        RigidBodyStore* getStore() const;
+        int getBody() const;
+
+        // revision of the shape's body (changes whenever the body moves, see RigidBodyStore::revision)
+        unsigned int getRevision() const;
+        // bumps the revision, so renderers parse the shape again after com(), rot() or graphics properties were edited directly
+        void markMoved();
+
         // needs to be implemented per shape
         // returns an array of width WIDTH
         virtual vector<float> parseData() const;
 
-        // a function just for meshes
-        virtual vector<float> getVertices() const;
+        // shape dimensions (columns 8 to 10 of the parsing table), without building the full table row
+        virtual vec3 getDimensions() const;
+
+        // a function just for meshes (vertex positions, returned by reference so they are not copied every frame)
+        virtual ArrayView<float> getVertices() const;
 
         // functions to help with standard collision detection algorithms
         virtual vector<vec3> getEdges() const;
         virtual vec3 project(vec3 n) const; 
+        // world space axis aligned bounding box (used by the broadphase)
+        virtual AABB getAABB() const;
 
-        // update collisions with a shape (uses parseData to access data it would otherwise not know about)
-        void collideWith(Shape* shape, float dT);
+        // narrowphase routines (called through collisionTable, collisions are resolved by the ContactSolver)
         virtual void collideWith_Sphere(Collision* collision, const Shape& shape, float r);
         virtual void collideWith_Box(Collision* collision, const Shape& shape, vec3 dim);
         virtual void collideWith_Capsule(Collision* collision, const Shape& capsule, float len, float ri, float ro);
 
         // not private so parent classes can interact with them
-        // physics properties
-        vec3 sumF;
-        vec3 sumT;
-
-        vec3 com;
-        vec3 linv;
-
-        vec4 rot;
-        vec3 angv;
-
-        mtrx3 moment;
-        mtrx3 invMoment;
+        ShapeType type;
 
+        // physics properties
         float mass;
-        float invMass;
         float e;
 
         bool anchor;
@@ -57,6 +78,10 @@ class Shape {
         int m;
 
         float refidx;
+
+    private:
+        RigidBodyStore* store;
+        int body;
 };
 
 
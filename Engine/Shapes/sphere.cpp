@@ -6,14 +6,9 @@
  * @param et_al see Shape constructor
  */
 Sphere::Sphere(float r, float mass, vec3 com, vec4 orientation, float elasticity, bool anchor, vec3 color, int m, float refidx) : 
-Shape(mass, com, orientation, elasticity, anchor, color, m, refidx), r(r) {
+Shape(SHAPE_SPHERE, mass, com, orientation, elasticity, anchor, color, m, refidx), r(r) {
     float tempMomentI = 2*mass*r*r/5;
-    moment = mtrx3(
-        vec3(tempMomentI, 0, 0),
-        vec3(0, tempMomentI, 0),
-        vec3(0, 0, tempMomentI)
-    );
-    invMoment = moment.inverse();
+    setInertia(vec3(tempMomentI, tempMomentI, tempMomentI));
 }
 
 /**
@@ -28,10 +23,17 @@ vector<vec3> Sphere::getEdges() const {
  * @param n Normalized direction of axis
  */
 vec3 Sphere::project(vec3 n) const {
-    float tm = vec3::dot(com, n);
+    float tm = vec3::dot(com(), n);
     return vec3(tm-r, tm+r, 0);
 }
 
+/**
+ * Returns the world space axis aligned bounding box of the sphere
+ */
+AABB Sphere::getAABB() const {
+    return AABB(com() - r, com() + r);
+}
+
 /**
  * Calculate collision object between sphere (this) on sphere (shape)
  * @param shape Sphere to collide with
@@ -44,7 +46,7 @@ void Sphere::collideWith_Sphere(Collision* collision, const Shape& shape, float
     vector<vec3> manifold;
 
     // collision if distance between centers <= sum of radii
-    vec3 dir = shape.com - com;
+    vec3 dir = shape.com() - com();
     vec3 dirn = vec3::norm(dir);
     float dist = vec3::mag(dir);
     col = (dist <= r + radius);
@@ -53,15 +55,15 @@ void Sphere::collideWith_Sphere(Collision* collision, const Shape& shape, float
         collision->col = false;
     } else {
         // contact point is middle of surface points
-        vec3 s1 = com + dirn * r;
-        vec3 s2 = shape.com - dirn * radius;
+        vec3 s1 = com() + dirn * r;
+        vec3 s2 = shape.com() - dirn * radius;
         manifold.push_back((s1 + s2) / 2);
 
-        // collision normal is direction between centers
-        normal = dirn;
+        // collision normal is direction between centers (pointing towards this sphere)
+        normal = dirn * -1;
 
-        // penetration distance is distance between centers minus sum of radii
-        penetration_depth = dist - r - radius;
+        // penetration distance is sum of radii minus distance between centers
+        penetration_depth = r + radius - dist;
 
         // concentric degenerate normal case
         if (vec3::mag(normal) == 0) {
@@ -72,6 +74,7 @@ void Sphere::collideWith_Sphere(Collision* collision, const Shape& shape, float
         collision->n = normal;
         collision->pen = penetration_depth;
         collision->man = manifold;
+        collision->ids = vector<int>(1, 0);
     }
 }
 /**
@@ -85,22 +88,20 @@ void Sphere::collideWith_Box(Collision* collision, const Shape& shape, vec3 dim)
     double penetration_depth; 
     vector<vec3> manifold;
 
-    vector<float> sp = shape.parseData();
-    
     // current SAT algorithm does a lot of arbitrary checks, whearas we can just check the axis of the shortest distance from the sphere to the box
-    vec3 dist = pointToBox(com, shape.com, dim, shape.rot);
+    vec3 dist = pointToBox(com(), shape.com(), dim, shape.rot());
     
     if (vec3::dot(dist, dist) > r * r) {
         collision->col = false;
     } else {
         normal = vec3::norm(dist);
-        vec3 p = com + dist;
+        vec3 p = com() + dist;
         manifold.push_back(p);
         
         // deep penetration
-        if (pointInBox(com, shape.com, dim, shape.rot)) {
+        if (pointInBox(com(), shape.com(), dim, shape.rot())) {
             penetration_depth = vec3::mag(dist) + r;
-            cout << "\ndeep\n";
+            TRACE_DEBUG("Sphere " << com() << " is inside box " << shape.com());
         }
         else {
             penetration_depth = r - vec3::mag(dist);
@@ -111,6 +112,7 @@ void Sphere::collideWith_Box(Collision* collision, const Shape& shape, vec3 dim)
         collision->n = normal;
         collision->pen = penetration_depth;
         collision->man = manifold;
+        collision->ids = vector<int>(1, 0);
     }
 }
 /**
@@ -127,16 +129,16 @@ void Sphere::collideWith_Capsule(Collision* collision, const Shape& shape, float
     vector<vec3> manifold;
 
     // capsule endpoints
-    vec3 r1 = shape.com + vec3::rotate(vec3(0,  len, 0), shape.rot);
-    vec3 r2 = shape.com + vec3::rotate(vec3(0, -len, 0), shape.rot);
+    vec3 r1 = shape.com() + vec3::rotate(vec3(0,  len, 0), shape.rot());
+    vec3 r2 = shape.com() + vec3::rotate(vec3(0, -len, 0), shape.rot());
 
     // closest point on defining ray
-    vec3 dirn = vec3::shortestDistanceToLineSegment(com, r1, r2) * -1;
-    vec3 L = com - dirn;
+    vec3 dirn = vec3::shortestDistanceToLineSegment(com(), r1, r2) * -1;
+    vec3 L = com() - dirn;
 
     // normal direction
     dirn = vec3::norm(dirn);
-    float dist = vec3::mag(com - L);
+    float dist = vec3::mag(com() - L);
 
     // collision if distance between relative segment center and sphere center less than the sum of the radii
     col = (dist <= ri + r);
@@ -144,16 +146,16 @@ void Sphere::collideWith_Capsule(Collision* collision, const Shape& shape, float
     if (!col) {
         collision->col = false;
     } else {
-        // contact point is middle of surface points
-        vec3 s1 = com + dirn * r;
-        vec3 s2 = L - dirn * ri;
+        // contact point is middle of surface points (dirn points from the capsule towards this sphere)
+        vec3 s1 = com() - dirn * r;
+        vec3 s2 = L + dirn * ri;
         manifold.push_back((s1 + s2) / 2);
 
         // collision normal is direction between centers
         normal = dirn;
 
-        // penetration distance is distance between centers minus sum of radii
-        penetration_depth = dist - r - ri;
+        // penetration distance is sum of radii minus distance between centers
+        penetration_depth = r + ri - dist;
 
         // concentric degenerate normal case
         if (vec3::mag(normal) == 0) {
@@ -164,6 +166,7 @@ void Sphere::collideWith_Capsule(Collision* collision, const Shape& shape, float
         collision->n = normal;
         collision->pen = penetration_depth;
         collision->man = manifold;
+        collision->ids = vector<int>(1, 0);
     }
 }
 
@@ -182,13 +185,13 @@ void Sphere::collideWith_Capsule(Collision* collision, const Shape& shape, float
 vector<float> Sphere::parseData() const {
     vector<float> returned{
         0,
-        com.X(),
-        com.Y(),
-        com.Z(),
-        rot.X(),
-        rot.Y(),
-        rot.Z(),
-        rot.W(),
+        com().X(),
+        com().Y(),
+        com().Z(),
+        rot().X(),
+        rot().Y(),
+        rot().Z(),
+        rot().W(),
         r,
         0,
         0,
@@ -202,7 +205,13 @@ vector<float> Sphere::parseData() const {
     return returned;
 }
 
-vector<float> Sphere::getVertices() const {
-    vector<float> returned;
-    return returned;
+/**
+ * Returns the dimensions of the shape as found in the table above
+ */
+vec3 Sphere::getDimensions() const {
+    return vec3(r, 0, 0);
+}
+
+ArrayView<float> Sphere::getVertices() const {
+    return Shape::getVertices();
 }
\ No newline at end of file
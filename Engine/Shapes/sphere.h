@@ -13,13 +13,15 @@ class Sphere: public Shape {
 
         // returns an array of width WIDTH
         vector<float> parseData() const override;
+        vec3 getDimensions() const override;
 
         // For meshes, can be ignored
-        vector<float> getVertices() const override;
+        ArrayView<float> getVertices() const override;
 
         // functions to help with standard collision detection algorithms
         vector<vec3> getEdges() const override;
         vec3 project(vec3 n) const override;
+        AABB getAABB() const override;
 
         // Collision functions
         void collideWith_Sphere(Collision* collision, const Shape& shape, float r) override;
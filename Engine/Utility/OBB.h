@@ -0,0 +1,263 @@
+#ifndef _OBB_H
+#define _OBB_H
+
+#include "../../common.h"
+
+/**
+ * Computes the columns of the rotation matrix of a unit quaternion (the world space directions of the local axes)
+ * @param q Orientation quaternion
+ * @param axes Output array of the 3 rotated axes
+ */
+void OBB_axes(const vec4& q, vec3 axes[3]) {
+    float w = q.X(); float x = q.Y(); float y = q.Z(); float z = q.W();
+    axes[0] = vec3(1 - 2*(y*y + z*z), 2*(x*y + w*z), 2*(x*z - w*y));
+    axes[1] = vec3(2*(x*y - w*z), 1 - 2*(x*x + z*z), 2*(y*z + w*x));
+    axes[2] = vec3(2*(x*z + w*y), 2*(y*z - w*x), 1 - 2*(x*x + y*y));
+}
+
+/**
+ * Clips a convex polygon to the half space dot(n, p) <= offset, keeping track of the features each vertex comes from
+ * (as Box2D's ContactFeature does), so the same contact keeps the same id while other vertices are culled around it
+ * @param in Vertices of the polygon
+ * @param features Feature of each vertex: an incident face vertex (0 to 3), or where an edge crossed a clip plane
+ * @param edges Label of the edge from each vertex to the next: an incident face edge (0 to 3) or a clip plane (4 to 7)
+ * @param count Number of vertices
+ * @param n Normal of the clipping plane
+ * @param offset Offset of the clipping plane
+ * @param plane Label of the clipping plane (4 to 7)
+ * @param out Clipped vertices, with their features and edges in outFeatures and outEdges (room for count + 1 vertices)
+ * @return number of clipped vertices
+ */
+int OBB_clip(const vec3* in, const int* features, const int* edges, int count, const vec3& n, float offset, int plane,
+             vec3* out, int* outFeatures, int* outEdges) {
+    int result = 0;
+    for (int i = 0; i < count; i ++) {
+        const vec3& p = in[i];
+        const vec3& q = in[(i + 1) % count];
+        float dp = vec3::dot(n, p) - offset;
+        float dq = vec3::dot(n, q) - offset;
+
+        if (dp <= 0) {
+            out[result] = p;
+            outFeatures[result] = features[i];
+            outEdges[result ++] = edges[i];
+        }
+        // the edge crosses the plane, at a point named by the plane and the edge (leaving the half space, the polygon
+        // carries on along the plane until it comes back in)
+        if ((dp < 0 && dq > 0) || (dp > 0 && dq < 0)) {
+            out[result] = p + (q - p) * (dp / (dp - dq));
+            outFeatures[result] = 4 + (plane - 4) * 8 + edges[i];
+            outEdges[result ++] = dp < 0 ? plane : edges[i];
+        }
+    }
+    return result;
+}
+
+/**
+ * Checks for a collision between two boxes, and builds the contact manifold if they collide
+ * Separating axes are tested relative to the first box with an early out, and the manifold is built by clipping the
+ * incident face against the sides of the reference face, without any heap allocation besides the result
+ * @param collision Result (normal from the second box towards the first, per point depths and feature ids)
+ * @param s1 First box corresponding with dim1
+ * @param s2 Second box corresponding with dim2
+ * @param dim1 Dimensions (half extents) of the first box
+ * @param dim2 Dimensions (half extents) of the second box
+ */
+void OBB_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2, vec3 dim1, vec3 dim2) {
+    vec3 A[3];
+    vec3 B[3];
+    OBB_axes(s1.rot(), A);
+    OBB_axes(s2.rot(), B);
+    float a[3] = {dim1.X(), dim1.Y(), dim1.Z()};
+    float b[3] = {dim2.X(), dim2.Y(), dim2.Z()};
+
+    // rotation of the second box in the first box's frame (absR is padded so near parallel edges do not produce false separations)
+    vec3 d = s2.com() - s1.com();
+    float R[3][3];
+    float absR[3][3];
+    float t[3];
+    for (int i = 0; i < 3; i ++) {
+        for (int j = 0; j < 3; j ++) {
+            R[i][j] = vec3::dot(A[i], B[j]);
+            absR[i][j] = abs(R[i][j]) + 1e-6f;
+        }
+        t[i] = vec3::dot(d, A[i]);
+    }
+
+    // find the axis of least penetration (the largest separation, which is negative for overlapping boxes)
+    float best = -numeric_limits<float>::max();
+    int axis = -1;
+    vec3 n;
+
+    // faces of the first box
+    for (int i = 0; i < 3; i ++) {
+        float s = abs(t[i]) - (a[i] + b[0]*absR[i][0] + b[1]*absR[i][1] + b[2]*absR[i][2]);
+        if (s > 0) {
+            collision->col = false;
+            return;
+        }
+        if (s > best) {
+            best = s;
+            axis = i;
+            n = t[i] > 0 ? A[i] * -1 : A[i];
+        }
+    }
+
+    // faces of the second box
+    for (int j = 0; j < 3; j ++) {
+        float tj = t[0]*R[0][j] + t[1]*R[1][j] + t[2]*R[2][j];
+        float s = abs(tj) - (b[j] + a[0]*absR[0][j] + a[1]*absR[1][j] + a[2]*absR[2][j]);
+        if (s > 0) {
+            collision->col = false;
+            return;
+        }
+        if (s > best) {
+            best = s;
+            axis = 3 + j;
+            n = tj > 0 ? B[j] * -1 : B[j];
+        }
+    }
+
+    // edge pairs (only chosen over a face when clearly better, since face contacts are far more stable)
+    for (int i = 0; i < 3; i ++) {
+        int i1 = (i + 1) % 3;
+        int i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j ++) {
+            int j1 = (j + 1) % 3;
+            int j2 = (j + 2) % 3;
+
+            float tl = t[i2]*R[i1][j] - t[i1]*R[i2][j];
+            float ra = a[i1]*absR[i2][j] + a[i2]*absR[i1][j];
+            float rb = b[j1]*absR[i][j2] + b[j2]*absR[i][j1];
+            float s = abs(tl) - (ra + rb);
+            if (s > 0) {
+                collision->col = false;
+                return;
+            }
+
+            // parallel edges do not define an axis
+            vec3 L = vec3::cross(A[i], B[j]);
+            float len = vec3::mag(L);
+            if (len < 1e-5f) {
+                continue;
+            }
+            s /= len;
+            if (s * 1.05f > best) {
+                best = s;
+                axis = 6 + 3*i + j;
+                n = tl > 0 ? L / -len : L / len;
+            }
+        }
+    }
+
+    collision->col = true;
+    collision->n = n;
+    collision->pen = -best;
+    collision->man.clear();
+    collision->ids.clear();
+    collision->depths.clear();
+
+    if (axis >= 6) {
+        // edge on edge, the contact is the midpoint of the closest points between the two edges
+        int i = (axis - 6) / 3;
+        int j = (axis - 6) % 3;
+
+        // the edges are the ones closest to the other box
+        vec3 pa = s1.com();
+        vec3 pb = s2.com();
+        for (int k = 0; k < 3; k ++) {
+            if (k != i) {
+                pa += A[k] * (vec3::dot(A[k], n) > 0 ? -a[k] : a[k]);
+            }
+            if (k != j) {
+                pb += B[k] * (vec3::dot(B[k], n) > 0 ? b[k] : -b[k]);
+            }
+        }
+
+        vec3 r = pa - pb;
+        float ab = vec3::dot(A[i], B[j]);
+        float ar = vec3::dot(A[i], r);
+        float br = vec3::dot(B[j], r);
+        float den = 1 - ab*ab;
+        float sa = 0;
+        float sb = 0;
+        if (den > 1e-6f) {
+            sa = max(-a[i], min((ab*br - ar) / den, a[i]));
+            sb = max(-b[j], min(ab*sa + br, b[j]));
+        }
+
+        collision->man.push_back((pa + A[i]*sa + pb + B[j]*sb) / 2);
+        collision->ids.push_back(1 << 13 | i << 14 | j << 16);
+        collision->depths.push_back(-best);
+        return;
+    }
+
+    // face contact, the reference face belongs to the box whose axis was chosen
+    bool or12 = axis < 3;
+    const vec3* ref = or12 ? A : B;
+    const vec3* inc = or12 ? B : A;
+    const float* rh = or12 ? a : b;
+    const float* ih = or12 ? b : a;
+    vec3 rc = or12 ? s1.com() : s2.com();
+    vec3 ic = or12 ? s2.com() : s1.com();
+    int f = axis % 3;
+
+    // reference normal, pointing from the reference box towards the incident box
+    vec3 nr = or12 ? n * -1 : n;
+    int refFace = vec3::dot(nr, ref[f]) > 0 ? f : f + 3;
+
+    // incident face is the face of the incident box most anti parallel to the reference normal
+    int k = 0;
+    float kmax = abs(vec3::dot(inc[0], nr));
+    for (int m = 1; m < 3; m ++) {
+        float km = abs(vec3::dot(inc[m], nr));
+        if (km > kmax) {
+            kmax = km;
+            k = m;
+        }
+    }
+    float sign = vec3::dot(inc[k], nr) > 0 ? -1 : 1;
+    int incFace = sign > 0 ? k : k + 3;
+
+    vec3 fc = ic + inc[k] * (ih[k] * sign);
+    vec3 u = inc[(k + 1) % 3] * ih[(k + 1) % 3];
+    vec3 v = inc[(k + 2) % 3] * ih[(k + 2) % 3];
+
+    // clip the incident face by the 4 side planes of the reference face (each clip adds at most one vertex)
+    vec3 poly[8];
+    vec3 clipped[8];
+    int features[8] = {0, 1, 2, 3};
+    int clippedFeatures[8];
+    int edges[8] = {0, 1, 2, 3};
+    int clippedEdges[8];
+    poly[0] = fc + u + v;
+    poly[1] = fc - u + v;
+    poly[2] = fc - u - v;
+    poly[3] = fc + u - v;
+    int count = 4;
+    for (int m = 1; m < 3 && count > 0; m ++) {
+        const vec3& side = ref[(f + m) % 3];
+        float offset = vec3::dot(side, rc);
+        float h = rh[(f + m) % 3];
+
+        count = OBB_clip(poly, features, edges, count, side, offset + h, 2 + 2*m, clipped, clippedFeatures, clippedEdges);
+        count = OBB_clip(clipped, clippedFeatures, clippedEdges, count, side * -1, h - offset, 3 + 2*m, poly, features, edges);
+    }
+
+    // keep the points below the reference face, placed midway between the two faces
+    float faceOffset = vec3::dot(nr, rc) + rh[f];
+    for (int m = 0; m < count; m ++) {
+        float sep = vec3::dot(nr, poly[m]) - faceOffset;
+        if (sep <= 0) {
+            collision->man.push_back(poly[m] - nr * (sep / 2));
+            collision->ids.push_back((or12 ? 1 : 0) | refFace << 1 | incFace << 4 | features[m] << 7);
+            collision->depths.push_back(-sep);
+        }
+    }
+
+    if (collision->man.empty()) {
+        collision->col = false;
+    }
+}
+
+#endif
\ No newline at end of file
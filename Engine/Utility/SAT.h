@@ -132,41 +132,39 @@ bool SAT_checkCollision(const Shape& s1, const Shape& s2) {
     vector<vec3> e1 = s1.getEdges();
     vector<vec3> e2 = s2.getEdges();
 
-    vector<float> s1p = s1.parseData();
-    vector<float> s2p = s2.parseData();
-
-    float s1t = s1p.at(0);
-    float s2t = s2p.at(0);
+    ShapeType s1t = s1.type;
+    ShapeType s2t = s2.type;
+    vec3 s2d = s2.getDimensions();
 
     // if first shape is a sphere, its "edges" are defined by vector representing the shortest distance between the two objects
-    if (s1t == 0) {
+    if (s1t == SHAPE_SPHERE) {
         // if second shape is also a sphere, subtract centers
-        if (s2t == 0) {
-            vec3 n = s1.com - s2.com;
+        if (s2t == SHAPE_SPHERE) {
+            vec3 n = s1.com() - s2.com();
             n = vec3::norm(n);
 
             e1.push_back(n);
             // don't need to push to second, as it will be a duplicate axis to check
         } 
         // if second shape is a box, do some math
-        else if (s2t == 1) {
-            vec3 n = pointToBox(s1.com, s2.com, vec3(s2p.at(8), s2p.at(9), s2p.at(10)), s2.rot);
+        else if (s2t == SHAPE_BOX) {
+            vec3 n = pointToBox(s1.com(), s2.com(), s2d, s2.rot());
             n = vec3::norm(n);
 
             e1.push_back(n);
         }
         // if second shape is a capsule, do some math
-        else if (s2t == 2) {
-            vec3 a = s2.com + vec3::rotate(vec3(0, s2p.at(8), 0), s2.rot);
-            vec3 b = s2.com + vec3::rotate(vec3(0, -s2p.at(8), 0), s2.rot);
-            vec3 n = vec3::shortestDistanceToLineSegment(s1.com, a, b);
+        else if (s2t == SHAPE_CAPSULE) {
+            vec3 a = s2.com() + vec3::rotate(vec3(0, s2d.X(), 0), s2.rot());
+            vec3 b = s2.com() + vec3::rotate(vec3(0, -s2d.X(), 0), s2.rot());
+            vec3 n = vec3::shortestDistanceToLineSegment(s1.com(), a, b);
             n = vec3::norm(n);
 
             e1.push_back(n);
         }
     }
     // if first shape is a capsule, ...
-    else if (s1t == 1) {
+    else if (s1t == SHAPE_BOX) {
         
     }
 }
@@ -180,12 +178,12 @@ bool SAT_checkCollision(const Shape& s1, const Shape& s2) {
  * @return vec3 representing the normal of a collision between the two boxes (0, 0, 0) if no collision detected
  */
 vec3 SAT_boxBox(const Shape& s1, const Shape& s2, vec3 dim1, vec3 dim2) {
-    vec3 w1 = vec3::rotate(vec3(dim1.X(), 0, 0), s1.rot);
-    vec3 l1 = vec3::rotate(vec3(0, dim1.Y(), 0), s1.rot);
-    vec3 h1 = vec3::rotate(vec3(0, 0, dim1.Z()), s1.rot);
-    vec3 w2 = vec3::rotate(vec3(dim2.X(), 0, 0), s2.rot);
-    vec3 l2 = vec3::rotate(vec3(0, dim2.Y(), 0), s2.rot);
-    vec3 h2 = vec3::rotate(vec3(0, 0, dim2.Z()), s2.rot);
+    vec3 w1 = vec3::rotate(vec3(dim1.X(), 0, 0), s1.rot());
+    vec3 l1 = vec3::rotate(vec3(0, dim1.Y(), 0), s1.rot());
+    vec3 h1 = vec3::rotate(vec3(0, 0, dim1.Z()), s1.rot());
+    vec3 w2 = vec3::rotate(vec3(dim2.X(), 0, 0), s2.rot());
+    vec3 l2 = vec3::rotate(vec3(0, dim2.Y(), 0), s2.rot());
+    vec3 h2 = vec3::rotate(vec3(0, 0, dim2.Z()), s2.rot());
     vector<vec3> normals = {
         w1, l1, h1, 
         w2, l2, h2, 
@@ -194,24 +192,24 @@ vec3 SAT_boxBox(const Shape& s1, const Shape& s2, vec3 dim1, vec3 dim2) {
         vec3::cross(h1, w2), vec3::cross(h1, l2), vec3::cross(h1, h2), 
     };
     vector<vec3> points1 = {
-        s1.com + w1 + l1 + h1,
-        s1.com + w1 + l1 - h1,
-        s1.com + w1 - l1 + h1,
-        s1.com + w1 - l1 - h1,
-        s1.com + w1*-1 + l1 + h1,
-        s1.com + w1*-1 + l1 - h1,
-        s1.com + w1*-1 - l1 + h1,
-        s1.com + w1*-1 - l1 - h1
+        s1.com() + w1 + l1 + h1,
+        s1.com() + w1 + l1 - h1,
+        s1.com() + w1 - l1 + h1,
+        s1.com() + w1 - l1 - h1,
+        s1.com() + w1*-1 + l1 + h1,
+        s1.com() + w1*-1 + l1 - h1,
+        s1.com() + w1*-1 - l1 + h1,
+        s1.com() + w1*-1 - l1 - h1
     };
     vector<vec3> points2 = {
-        s2.com + w2 + l2 + h2,
-        s2.com + w2 + l2 - h2,
-        s2.com + w2 - l2 + h2,
-        s2.com + w2 - l2 - h2,
-        s2.com + w2*-1 + l2 + h2,
-        s2.com + w2*-1 + l2 - h2,
-        s2.com + w2*-1 - l2 + h2,
-        s2.com + w2*-1 - l2 - h2
+        s2.com() + w2 + l2 + h2,
+        s2.com() + w2 + l2 - h2,
+        s2.com() + w2 - l2 + h2,
+        s2.com() + w2 - l2 - h2,
+        s2.com() + w2*-1 + l2 + h2,
+        s2.com() + w2*-1 + l2 - h2,
+        s2.com() + w2*-1 - l2 + h2,
+        s2.com() + w2*-1 - l2 - h2
     };
     vec3 minn = vec3(0);
     float mind = vec3::mag(dim1) + vec3::mag(dim2);
@@ -273,12 +271,12 @@ vec3 clipPoly(vec3 ro, vec3 rd, vec3 p, vec3 n) {
  * Using relevant information only available within the SAT_boxBox collision detection function, update collision manifold
  */
 void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2, vec3 dim1, vec3 dim2) {
-    vec3 w1 = vec3::rotate(vec3(dim1.X(), 0, 0), s1.rot);
-    vec3 l1 = vec3::rotate(vec3(0, dim1.Y(), 0), s1.rot);
-    vec3 h1 = vec3::rotate(vec3(0, 0, dim1.Z()), s1.rot);
-    vec3 w2 = vec3::rotate(vec3(dim2.X(), 0, 0), s2.rot);
-    vec3 l2 = vec3::rotate(vec3(0, dim2.Y(), 0), s2.rot);
-    vec3 h2 = vec3::rotate(vec3(0, 0, dim2.Z()), s2.rot);
+    vec3 w1 = vec3::rotate(vec3(dim1.X(), 0, 0), s1.rot());
+    vec3 l1 = vec3::rotate(vec3(0, dim1.Y(), 0), s1.rot());
+    vec3 h1 = vec3::rotate(vec3(0, 0, dim1.Z()), s1.rot());
+    vec3 w2 = vec3::rotate(vec3(dim2.X(), 0, 0), s2.rot());
+    vec3 l2 = vec3::rotate(vec3(0, dim2.Y(), 0), s2.rot());
+    vec3 h2 = vec3::rotate(vec3(0, 0, dim2.Z()), s2.rot());
     vector<vec3> normals = {
         w1, l1, h1, 
         w2, l2, h2, 
@@ -287,24 +285,24 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
         vec3::cross(h1, w2), vec3::cross(h1, l2), vec3::cross(h1, h2), 
     };
     vector<vec3> points1 = {
-        s1.com + w1 + l1 + h1,
-        s1.com + w1 + l1 - h1,
-        s1.com + w1 - l1 + h1,
-        s1.com + w1 - l1 - h1,
-        s1.com + w1*-1 + l1 + h1,
-        s1.com + w1*-1 + l1 - h1,
-        s1.com + w1*-1 - l1 + h1,
-        s1.com + w1*-1 - l1 - h1
+        s1.com() + w1 + l1 + h1,
+        s1.com() + w1 + l1 - h1,
+        s1.com() + w1 - l1 + h1,
+        s1.com() + w1 - l1 - h1,
+        s1.com() + w1*-1 + l1 + h1,
+        s1.com() + w1*-1 + l1 - h1,
+        s1.com() + w1*-1 - l1 + h1,
+        s1.com() + w1*-1 - l1 - h1
     };
     vector<vec3> points2 = {
-        s2.com + w2 + l2 + h2,
-        s2.com + w2 + l2 - h2,
-        s2.com + w2 - l2 + h2,
-        s2.com + w2 - l2 - h2,
-        s2.com + w2*-1 + l2 + h2,
-        s2.com + w2*-1 + l2 - h2,
-        s2.com + w2*-1 - l2 + h2,
-        s2.com + w2*-1 - l2 - h2
+        s2.com() + w2 + l2 + h2,
+        s2.com() + w2 + l2 - h2,
+        s2.com() + w2 - l2 + h2,
+        s2.com() + w2 - l2 - h2,
+        s2.com() + w2*-1 + l2 + h2,
+        s2.com() + w2*-1 + l2 - h2,
+        s2.com() + w2*-1 - l2 + h2,
+        s2.com() + w2*-1 - l2 - h2
     };
     vec3 minn = vec3(0);
     float mind = vec3::mag(dim1) + vec3::mag(dim2);
@@ -349,8 +347,11 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
 
         }
     }
-    // we have found a collision!
+    // we have found a collision! (orient the normal from the second box towards the first)
     vec3 n = vec3::norm(minn);
+    if (vec3::dot(n, s1.com() - s2.com()) < 0) {
+        n *= -1;
+    }
     float pen = mind;
     //cout << "\nCollision using normal: "; vec3::printv3(n);
 
@@ -399,9 +400,9 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
         inc = s1normals.at(cl1);
     }
 
-    cout << "\nOr12: " << or12;
-    cout << "\nUsing reference normal: "; vec3::printv3(ref); 
-    cout << "\nUsing incident normal: "; vec3::printv3(inc);
+    TRACE_DEBUG("Or12: " << or12);
+    TRACE_DEBUG("Using reference normal: " << ref);
+    TRACE_DEBUG("Using incident normal: " << inc);
 
     // clip by all adjacent planes
     // identify adjacent plane normal indicies
@@ -420,24 +421,21 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
     }
     vec3 tcom = vec3(0);
     if (!or12) {
-        tcom = s1.com;
+        tcom = s1.com();
         points.push_back(tcom + s1normals.at(adjp.at(0)) + s1normals.at(adjp.at(1)));
         points.push_back(tcom + s1normals.at(adjp.at(0)) + s1normals.at(adjp.at(3)));
         points.push_back(tcom + s1normals.at(adjp.at(2)) + s1normals.at(adjp.at(3)));
         points.push_back(tcom + s1normals.at(adjp.at(2)) + s1normals.at(adjp.at(1)));
     } else {
-        tcom = s2.com;
+        tcom = s2.com();
         points.push_back(tcom + s2normals.at(adjp.at(0)) + s2normals.at(adjp.at(1)));
         points.push_back(tcom + s2normals.at(adjp.at(0)) + s2normals.at(adjp.at(3)));
         points.push_back(tcom + s2normals.at(adjp.at(2)) + s2normals.at(adjp.at(3)));
         points.push_back(tcom + s2normals.at(adjp.at(2)) + s2normals.at(adjp.at(1)));
     }
     
-    cout << "\nUsing points: ";
-    for (vec3 pointssss : points) {
-        vec3::printv3(pointssss); cout << "; ";
-    }
-    cout << "\nTCOM: "; vec3::printv3(tcom);
+    TRACE_DEBUG("Using points: " << points.at(0) << "; " << points.at(1) << "; " << points.at(2) << "; " << points.at(3));
+    TRACE_DEBUG("TCOM: " << tcom);
 
     // now that we've determined the points on the incident plane, we must clip them
     // vec3 clipPoly(vec3 ro, vec3 rd, vec3 p, vec3 n)
@@ -445,13 +443,12 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
     for (int i = 0; i < 4; i ++) {
         // iterate through points and update
         for (int j = 0; j < 4; j ++) {
-            cout << "\nClipping " << i << " " << j << " "; vec3::printv3(points.at(j)); cout << " -> ";
             if (or12) {
-                vec3::printv3(clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s1normals.at(adjp.at(i)), s1normals.at(adjp.at(i))));
+                TRACE_DEBUG("Clipping " << i << " " << j << " " << points.at(j) << " -> " << clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s1normals.at(adjp.at(i)), s1normals.at(adjp.at(i))));
                 points.at(j) = clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s1normals.at(adjp.at(i)), s1normals.at(adjp.at(i)));
                 points.at(j) = clipPoly(points.at(j), points.at((j+4-1)%4) - points.at(j), tcom + s1normals.at(adjp.at(i)), s1normals.at(adjp.at(i)));
             } else {
-                vec3::printv3(clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s2normals.at(adjp.at(i)), s2normals.at(adjp.at(i))));
+                TRACE_DEBUG("Clipping " << i << " " << j << " " << points.at(j) << " -> " << clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s2normals.at(adjp.at(i)), s2normals.at(adjp.at(i))));
                 points.at(j) = clipPoly(points.at(j), points.at((j+4+1)%4) - points.at(j), tcom + s2normals.at(adjp.at(i)), s2normals.at(adjp.at(i)));
                 points.at(j) = clipPoly(points.at(j), points.at((j+4-1)%4) - points.at(j), tcom + s2normals.at(adjp.at(i)), s2normals.at(adjp.at(i)));
             }
@@ -459,17 +456,21 @@ void SAT_boxBoxCollision(Collision* collision, const Shape& s1, const Shape& s2,
     }
     
     // now we remove points still above the normal
+    // each point's feature id packs the reference box, reference face, incident face and incident vertex
     vector<vec3> final;
+    vector<int> ids;
     for (int i = 0; i < 4; i ++) {
         vec3 tempv = points.at(i);
         if (vec3::dot(tempv - (tcom + ref), ref) < 0) {
             final.push_back(tempv);
+            ids.push_back((or12 ? 1 : 0) | (or12 ? cl1 : cl2) << 1 | (or12 ? cl2 : cl1) << 4 | i << 7);
         }
     }
 
     // finalize
     collision->col = true;
     collision->man = final;
+    collision->ids = ids;
     collision->pen = pen;
     collision->n = n;
     return;
@@ -0,0 +1,35 @@
+#include "aabb.h"
+
+AABB::AABB(vec3 lower, vec3 upper) {
+    this->lower = lower;
+    this->upper = upper;
+}
+AABB::AABB() {
+    lower = vec3(0);
+    upper = vec3(0);
+}
+
+bool AABB::overlaps(const AABB& a, const AABB& b) {
+    return a.lower.X() <= b.upper.X() && a.upper.X() >= b.lower.X() &&
+           a.lower.Y() <= b.upper.Y() && a.upper.Y() >= b.lower.Y() &&
+           a.lower.Z() <= b.upper.Z() && a.upper.Z() >= b.lower.Z();
+}
+
+bool AABB::contains(const AABB& a, const AABB& b) {
+    return a.lower.X() <= b.lower.X() && a.upper.X() >= b.upper.X() &&
+           a.lower.Y() <= b.lower.Y() && a.upper.Y() >= b.upper.Y() &&
+           a.lower.Z() <= b.lower.Z() && a.upper.Z() >= b.upper.Z();
+}
+
+AABB AABB::merge(const AABB& a, const AABB& b) {
+    return AABB(vec3::vmin(a.lower, b.lower), vec3::vmax(a.upper, b.upper));
+}
+
+AABB AABB::fatten(const AABB& a, float margin) {
+    return AABB(a.lower - margin, a.upper + margin);
+}
+
+float AABB::area(const AABB& a) {
+    vec3 d = a.upper - a.lower;
+    return 2 * (d.X()*d.Y() + d.Y()*d.Z() + d.Z()*d.X());
+}
\ No newline at end of file
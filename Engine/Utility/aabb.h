@@ -0,0 +1,29 @@
+// Axis aligned bounding box class
+#ifndef _AABB_H
+#define _AABB_H
+
+#include "../../common.h"
+
+class AABB {
+    public:
+        AABB(vec3 lower, vec3 upper);
+        AABB();
+
+        // whether or not two boxes overlap (touching boxes are considered overlapping)
+        static bool overlaps(const AABB& a, const AABB& b);
+        // whether or not box a fully contains box b
+        static bool contains(const AABB& a, const AABB& b);
+        // smallest box containing both boxes
+        static AABB merge(const AABB& a, const AABB& b);
+        // box grown by a margin in every direction
+        static AABB fatten(const AABB& a, float margin);
+        // surface area of the box
+        static float area(const AABB& a);
+
+        vec3 lower;
+        vec3 upper;
+};
+
+#include "aabb.cpp"
+
+#endif
\ No newline at end of file
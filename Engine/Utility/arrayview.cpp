@@ -0,0 +1,53 @@
+#include "arrayview.h"
+
+template <typename T>
+ArrayView<T>::ArrayView() : values(NULL), count(0) {
+}
+
+template <typename T>
+ArrayView<T>::ArrayView(const T* values, size_t count) : values(values), count(count) {
+}
+
+template <typename T>
+ArrayView<T>::ArrayView(const vector<T>& values) : values(values.data()), count(values.size()) {
+}
+
+template <typename T>
+const T* ArrayView<T>::data() const {
+    return values;
+}
+
+template <typename T>
+size_t ArrayView<T>::size() const {
+    return count;
+}
+
+template <typename T>
+bool ArrayView<T>::empty() const {
+    return count == 0;
+}
+
+template <typename T>
+const T& ArrayView<T>::operator[] (size_t i) const {
+    return values[i];
+}
+
+template <typename T>
+const T* ArrayView<T>::begin() const {
+    return values;
+}
+
+template <typename T>
+const T* ArrayView<T>::end() const {
+    return values + count;
+}
+
+template <typename T>
+bool ArrayView<T>::operator== (const ArrayView& view) const {
+    return count == view.count && equal(begin(), end(), view.begin());
+}
+
+template <typename T>
+bool ArrayView<T>::operator!= (const ArrayView& view) const {
+    return !(*this == view);
+}
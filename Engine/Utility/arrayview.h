@@ -0,0 +1,38 @@
+// Read only run of values held elsewhere (a vector or a memory mapped file)
+#ifndef _ARRAYVIEW_H
+#define _ARRAYVIEW_H
+
+#include "../../common.h"
+
+/**
+ * Pointer and count of values the view does not own, so whoever holds the values must outlive it
+ * Buffers served straight from a MappedFile are handed out as views, so callers never copy them
+ */
+template <typename T>
+class ArrayView {
+    public:
+        ArrayView();
+        ArrayView(const T* values, size_t count);
+        // views a vector's values (until the vector is changed)
+        ArrayView(const vector<T>& values);
+
+        const T* data() const;
+        size_t size() const;
+        bool empty() const;
+
+        const T& operator[] (size_t i) const;
+        const T* begin() const;
+        const T* end() const;
+
+        // views are equal when they hold equal values, wherever the values are
+        bool operator== (const ArrayView& view) const;
+        bool operator!= (const ArrayView& view) const;
+
+    private:
+        const T* values;
+        size_t count;
+};
+
+#include "arrayview.cpp"
+
+#endif
@@ -0,0 +1,562 @@
+#include "bvh.h"
+
+// number of centroid bins tried per axis when splitting
+#define BVH_BINS 12
+// nodes with this many triangles or fewer are always leaves
+#define BVH_LEAF 2
+// nodes with more triangles than this are always split
+#define BVH_MAX_LEAF 8
+// cost of visiting a node, relative to testing one triangle
+#define BVH_TRAVERSAL 1.0f
+// deepest tree the traversal stacks can hold
+#define BVH_STACK 64
+
+MeshBVH::MeshBVH() {
+}
+
+/**
+ * Builds the tree over a triangle soup
+ * @param vertices Triangles as 9 floats each
+ */
+void MeshBVH::build(const vector<float>& vertices) {
+    build<unsigned int>(vertices, NULL, vertices.size() / 9);
+}
+
+/**
+ * Builds the tree over indexed triangles, splitting nodes where the surface area heuristic is cheapest
+ * Centroids are sorted into BVH_BINS bins per axis, so building takes O(n log n) whatever the mesh looks like
+ * @param positions Vertex positions, 3 floats each
+ * @param indices 3 vertex indices per triangle (NULL if the positions are already a triangle soup)
+ * @param count Number of triangles
+ */
+template <typename Index>
+void MeshBVH::build(const ArrayView<float>& positions, const Index* indices, int count) {
+    builtNodes.clear();
+    builtTriangles.clear();
+    builtOrder.assign(count, 0);
+    nodes = ArrayView<Node>();
+    triangles = ArrayView<Triangle>();
+    order = ArrayView<int>(builtOrder);
+    bounds = AABB();
+    if (count == 0) {
+        return;
+    }
+
+    // corner k of triangle i
+    auto corner = [&positions, indices](int i, int k) {
+        const float* v = &positions[3 * (indices ? (size_t)indices[3*i+k] : (size_t)(3*i+k))];
+        return vec3(v[0], v[1], v[2]);
+    };
+
+    vector<Reference> refs(count);
+    for (int i = 0; i < count; i ++) {
+        vec3 v0 = corner(i, 0);
+        vec3 v1 = corner(i, 1);
+        vec3 v2 = corner(i, 2);
+        refs[i].box = AABB(vec3::vmin(v0, vec3::vmin(v1, v2)), vec3::vmax(v0, vec3::vmax(v1, v2)));
+        refs[i].centroid = (refs[i].box.lower + refs[i].box.upper) * 0.5f;
+        refs[i].triangle = i;
+    }
+
+    // a binary tree has fewer than twice as many nodes as leaves
+    builtNodes.reserve(2 * count / BVH_LEAF + 1);
+    builtTriangles.reserve(count);
+    buildNode(refs, 0, count, 0);
+
+    // leaves only recorded which triangles they hold, copy the vertices over in tree order
+    bounds = AABB(builtNodes[0].lower, builtNodes[0].upper);
+    for (int i = 0; i < count; i ++) {
+        Triangle& tri = builtTriangles[i];
+        tri.v0 = corner(tri.index, 0);
+        tri.v1 = corner(tri.index, 1);
+        tri.v2 = corner(tri.index, 2);
+        builtOrder[tri.index] = i;
+    }
+    nodes = ArrayView<Node>(builtNodes);
+    triangles = ArrayView<Triangle>(builtTriangles);
+}
+
+// node and triangle fields as they are written, 4 bytes each
+#define BVH_NODE_FIELDS 8
+#define BVH_TRIANGLE_FIELDS 10
+
+/**
+ * Writes the tree as the node count, then each node's bounds, offset and count, then each triangle's corners and
+ * source index in tree order, then the tree position of every source triangle (4 bytes per value, in the machine's
+ * byte order, which is how the tree is laid out in memory so read can serve it in place)
+ */
+void MeshBVH::write(ostream& out) const {
+    static_assert(sizeof(Node) == BVH_NODE_FIELDS * 4 && sizeof(Triangle) == BVH_TRIANGLE_FIELDS * 4, "BVH nodes and triangles must be packed 4 byte fields");
+    uint32_t count = nodes.size();
+    out.write((const char*)&count, 4);
+    for (int i = 0; i < (int)nodes.size(); i ++) {
+        const Node& node = nodes[i];
+        float lower[3] = {node.lower.X(), node.lower.Y(), node.lower.Z()};
+        float upper[3] = {node.upper.X(), node.upper.Y(), node.upper.Z()};
+        int32_t offset = node.offset;
+        int32_t leaf = node.count;
+        out.write((const char*)lower, 12);
+        out.write((const char*)&offset, 4);
+        out.write((const char*)upper, 12);
+        out.write((const char*)&leaf, 4);
+    }
+    for (int i = 0; i < (int)triangles.size(); i ++) {
+        const Triangle& tri = triangles[i];
+        float corners[9] = {tri.v0.X(), tri.v0.Y(), tri.v0.Z(), tri.v1.X(), tri.v1.Y(), tri.v1.Z(), tri.v2.X(), tri.v2.Y(), tri.v2.Z()};
+        int32_t index = tri.index;
+        out.write((const char*)corners, 36);
+        out.write((const char*)&index, 4);
+    }
+    for (int i = 0; i < (int)order.size(); i ++) {
+        int32_t position = order[i];
+        out.write((const char*)&position, 4);
+    }
+}
+
+/**
+ * Serves a tree written by write from the buffer it is in
+ * Every node and triangle is checked against the size of the tree, so a damaged file cannot send a traversal out of bounds
+ */
+bool MeshBVH::read(const char*& data, const char* end, int count) {
+    builtNodes.clear();
+    builtTriangles.clear();
+    builtOrder.clear();
+    nodes = ArrayView<Node>();
+    triangles = ArrayView<Triangle>();
+    order = ArrayView<int>();
+    bounds = AABB();
+
+    uint32_t nodeCount;
+    if (end - data < 4 || (uintptr_t)data % 4 != 0) {
+        return false;
+    }
+    memcpy(&nodeCount, data, 4);
+    size_t bytes = 4 + (size_t)nodeCount * BVH_NODE_FIELDS * 4 + (size_t)count * (BVH_TRIANGLE_FIELDS + 1) * 4;
+    if ((size_t)(end - data) < bytes || (nodeCount == 0) != (count == 0)) {
+        return false;
+    }
+    const Node* nodeData = (const Node*)(data + 4);
+    const Triangle* triangleData = (const Triangle*)(nodeData + nodeCount);
+    const int* orderData = (const int*)(triangleData + count);
+
+    // depth of each node, which must stay within the traversal stacks
+    vector<int> depth(nodeCount, 0);
+    for (int i = 0; i < (int)nodeCount; i ++) {
+        const Node& node = nodeData[i];
+        // interior nodes point forwards at their right child, leaves at a run of triangles
+        bool valid = node.count == 0 ? (i + 1 < (int)nodeCount && node.offset > i + 1 && node.offset < (int)nodeCount)
+                                     : (node.count > 0 && node.offset >= 0 && node.offset <= count - node.count);
+        if (valid && node.count == 0) {
+            depth[i + 1] = max(depth[i + 1], depth[i] + 1);
+            depth[node.offset] = max(depth[node.offset], depth[i] + 1);
+            valid = depth[i] + 1 < BVH_STACK - 1;
+        }
+        if (!valid) {
+            return false;
+        }
+    }
+
+    // the source indices of the triangles and the tree positions must be each other's inverse
+    for (int i = 0; i < count; i ++) {
+        int index = triangleData[i].index;
+        if (index < 0 || index >= count || orderData[index] != i) {
+            return false;
+        }
+    }
+
+    nodes = ArrayView<Node>(nodeData, nodeCount);
+    triangles = ArrayView<Triangle>(triangleData, count);
+    order = ArrayView<int>(orderData, count);
+    if (!nodes.empty()) {
+        bounds = AABB(nodes[0].lower, nodes[0].upper);
+    }
+    data += bytes;
+    return true;
+}
+
+/**
+ * Builds the node over refs[begin, end) and its children
+ * @return index of the node
+ */
+int MeshBVH::buildNode(vector<Reference>& refs, int begin, int end, int depth) {
+    int index = builtNodes.size();
+    builtNodes.push_back(Node());
+
+    AABB box = refs[begin].box;
+    AABB centroids(refs[begin].centroid, refs[begin].centroid);
+    for (int i = begin + 1; i < end; i ++) {
+        box = AABB::merge(box, refs[i].box);
+        centroids.lower = vec3::vmin(centroids.lower, refs[i].centroid);
+        centroids.upper = vec3::vmax(centroids.upper, refs[i].centroid);
+    }
+    builtNodes[index].lower = box.lower;
+    builtNodes[index].upper = box.upper;
+
+    int count = end - begin;
+    int mid = begin;
+    if (count > BVH_LEAF && depth < BVH_STACK - 2) {
+        vec3 extent = centroids.upper - centroids.lower;
+        float lower[3] = {centroids.lower.X(), centroids.lower.Y(), centroids.lower.Z()};
+        float size[3] = {extent.X(), extent.Y(), extent.Z()};
+
+        // cheapest split over every bin boundary of every axis
+        float bestCost = numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestBin = 0;
+        for (int axis = 0; axis < 3; axis ++) {
+            if (size[axis] <= 0) {
+                continue;
+            }
+
+            AABB bins[BVH_BINS];
+            int binCount[BVH_BINS] = {0};
+            float scale = BVH_BINS / size[axis];
+            for (int i = begin; i < end; i ++) {
+                float c = axis == 0 ? refs[i].centroid.X() : axis == 1 ? refs[i].centroid.Y() : refs[i].centroid.Z();
+                int b = min(BVH_BINS - 1, (int)((c - lower[axis]) * scale));
+                bins[b] = binCount[b] == 0 ? refs[i].box : AABB::merge(bins[b], refs[i].box);
+                binCount[b] ++;
+            }
+
+            // sweep from the right to get the area of everything above each boundary, then from the left to price each split
+            float rightArea[BVH_BINS];
+            int rightCount[BVH_BINS];
+            AABB sweep;
+            int sweepCount = 0;
+            for (int b = BVH_BINS - 1; b > 0; b --) {
+                if (binCount[b] > 0) {
+                    sweep = sweepCount == 0 ? bins[b] : AABB::merge(sweep, bins[b]);
+                    sweepCount += binCount[b];
+                }
+                rightArea[b] = sweepCount > 0 ? AABB::area(sweep) : 0;
+                rightCount[b] = sweepCount;
+            }
+            sweepCount = 0;
+            for (int b = 0; b < BVH_BINS - 1; b ++) {
+                if (binCount[b] > 0) {
+                    sweep = sweepCount == 0 ? bins[b] : AABB::merge(sweep, bins[b]);
+                    sweepCount += binCount[b];
+                }
+                if (sweepCount == 0 || rightCount[b+1] == 0) {
+                    continue;
+                }
+                float cost = sweepCount * AABB::area(sweep) + rightCount[b+1] * rightArea[b+1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+
+        // compare against testing every triangle of a leaf, both relative to the area of this node
+        float area = AABB::area(box);
+        float leafCost = count;
+        float splitCost = area > 0 ? BVH_TRAVERSAL + bestCost / area : BVH_TRAVERSAL + count / 2.0f;
+        if (bestAxis >= 0 && (splitCost < leafCost || count > BVH_MAX_LEAF)) {
+            float scale = BVH_BINS / size[bestAxis];
+            float origin = lower[bestAxis];
+            int axis = bestAxis;
+            int bin = bestBin;
+            mid = partition(refs.begin() + begin, refs.begin() + end, [axis, bin, scale, origin](const Reference& ref) {
+                float c = axis == 0 ? ref.centroid.X() : axis == 1 ? ref.centroid.Y() : ref.centroid.Z();
+                return min(BVH_BINS - 1, (int)((c - origin) * scale)) <= bin;
+            }) - refs.begin();
+        } else if (count > BVH_MAX_LEAF) {
+            // every centroid is in the same place, so any split is as good as any other
+            mid = begin + count / 2;
+        }
+    }
+
+    if (mid == begin || mid == end) {
+        builtNodes[index].offset = builtTriangles.size();
+        builtNodes[index].count = count;
+        for (int i = begin; i < end; i ++) {
+            builtTriangles.push_back(Triangle());
+            builtTriangles.back().index = refs[i].triangle;
+        }
+        return index;
+    }
+
+    // left child directly follows its parent
+    buildNode(refs, begin, mid, depth + 1);
+    int right = buildNode(refs, mid, end, depth + 1);
+    builtNodes[index].offset = right;
+    builtNodes[index].count = 0;
+    return index;
+}
+
+// entry distance of a ray into a node's box (or maxT if it misses)
+static inline float MeshBVH_slab(const vec3& lower, const vec3& upper, const vec3& ro, const vec3& inv, float minT, float maxT) {
+    float tx1 = (lower.X() - ro.X()) * inv.X(), tx2 = (upper.X() - ro.X()) * inv.X();
+    float ty1 = (lower.Y() - ro.Y()) * inv.Y(), ty2 = (upper.Y() - ro.Y()) * inv.Y();
+    float tz1 = (lower.Z() - ro.Z()) * inv.Z(), tz2 = (upper.Z() - ro.Z()) * inv.Z();
+    float tnear = max(max(min(tx1, tx2), min(ty1, ty2)), max(min(tz1, tz2), minT));
+    float tfar = min(min(max(tx1, tx2), max(ty1, ty2)), min(max(tz1, tz2), maxT));
+    return tnear <= tfar ? tnear : maxT;
+}
+
+// squared distance from a point to a node's box
+static inline float MeshBVH_boxDistance(const vec3& lower, const vec3& upper, const vec3& p) {
+    vec3 d = vec3::vmax(vec3::vmax(lower - p, p - upper), vec3(0));
+    return vec3::dot(d, d);
+}
+
+/**
+ * Finds the closest triangle hit by a ray, visiting the nearer child of each node first so farther subtrees are
+ * usually culled by the hit already found
+ * @param ro Ray origin
+ * @param rd Ray direction
+ * @param minT Hits closer than this are ignored
+ * @param maxT Hits farther than this are ignored
+ * @param t Distance along the ray of the hit
+ * @param triangle Index of the triangle hit (in the source vertices)
+ * @return whether or not a triangle was hit
+ */
+bool MeshBVH::raycast(const vec3& ro, const vec3& rd, float minT, float maxT, float& t, int& triangle) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    vec3 inv(1.0f / rd.X(), 1.0f / rd.Y(), 1.0f / rd.Z());
+    float closest = maxT;
+    int hit = -1;
+
+    int stack[BVH_STACK];
+    int top = 0;
+    if (MeshBVH_slab(nodes[0].lower, nodes[0].upper, ro, inv, minT, closest) >= closest) {
+        return false;
+    }
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; i ++) {
+                float d;
+                if (rayTriangle(ro, rd, triangles[i].v0, triangles[i].v1, triangles[i].v2, d) && d > minT && d < closest) {
+                    closest = d;
+                    hit = i;
+                }
+            }
+            continue;
+        }
+
+        int left = &node - &nodes[0] + 1;
+        int right = node.offset;
+        float tl = MeshBVH_slab(nodes[left].lower, nodes[left].upper, ro, inv, minT, closest);
+        float tr = MeshBVH_slab(nodes[right].lower, nodes[right].upper, ro, inv, minT, closest);
+        // push the farther child first so the nearer one is popped next
+        if (tl > tr) {
+            swap(tl, tr);
+            swap(left, right);
+        }
+        if (tr < closest) {
+            stack[top++] = right;
+        }
+        if (tl < closest) {
+            stack[top++] = left;
+        }
+    }
+
+    if (hit < 0) {
+        return false;
+    }
+    t = closest;
+    triangle = triangles[hit].index;
+    return true;
+}
+
+/**
+ * Finds every triangle whose bounding box overlaps a box
+ * @param box Box to test (in the mesh's frame)
+ * @param result Indices of the triangles (in the source vertices), appended to
+ */
+void MeshBVH::overlap(const AABB& box, vector<int>& result) const {
+    if (nodes.empty()) {
+        return;
+    }
+
+    int stack[BVH_STACK];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        int index = stack[--top];
+        const Node& node = nodes[index];
+        if (!AABB::overlaps(box, AABB(node.lower, node.upper))) {
+            continue;
+        }
+        if (node.count == 0) {
+            stack[top++] = node.offset;
+            stack[top++] = index + 1;
+            continue;
+        }
+        for (int i = node.offset; i < node.offset + node.count; i ++) {
+            const Triangle& tri = triangles[i];
+            AABB triBox(vec3::vmin(tri.v0, vec3::vmin(tri.v1, tri.v2)), vec3::vmax(tri.v0, vec3::vmax(tri.v1, tri.v2)));
+            if (AABB::overlaps(box, triBox)) {
+                result.push_back(tri.index);
+            }
+        }
+    }
+}
+
+/**
+ * Finds the closest point on the mesh to a point, visiting the nearer child of each node first
+ * @param p Point to search from (in the mesh's frame)
+ * @param maxDist Points farther than this are ignored
+ * @param point Closest point found
+ * @param triangle Index of the triangle the point lies on (in the source vertices)
+ * @return whether or not a point was found
+ */
+bool MeshBVH::closestPoint(const vec3& p, float maxDist, vec3& point, int& triangle) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    float closest = maxDist * maxDist;
+    int hit = -1;
+
+    int stack[BVH_STACK];
+    int top = 0;
+    if (MeshBVH_boxDistance(nodes[0].lower, nodes[0].upper, p) > closest) {
+        return false;
+    }
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (node.count > 0) {
+            for (int i = node.offset; i < node.offset + node.count; i ++) {
+                vec3 c = closestOnTriangle(p, triangles[i].v0, triangles[i].v1, triangles[i].v2);
+                vec3 d = c - p;
+                float dist = vec3::dot(d, d);
+                if (dist <= closest) {
+                    closest = dist;
+                    point = c;
+                    hit = i;
+                }
+            }
+            continue;
+        }
+
+        int left = &node - &nodes[0] + 1;
+        int right = node.offset;
+        float dl = MeshBVH_boxDistance(nodes[left].lower, nodes[left].upper, p);
+        float dr = MeshBVH_boxDistance(nodes[right].lower, nodes[right].upper, p);
+        if (dl > dr) {
+            swap(dl, dr);
+            swap(left, right);
+        }
+        if (dr <= closest) {
+            stack[top++] = right;
+        }
+        if (dl <= closest) {
+            stack[top++] = left;
+        }
+    }
+
+    if (hit < 0) {
+        return false;
+    }
+    triangle = triangles[hit].index;
+    return true;
+}
+
+// unit normal of a triangle (by winding order)
+vec3 MeshBVH::getNormal(int triangle) const {
+    const Triangle& tri = triangles[order[triangle]];
+    return vec3::norm(vec3::cross(tri.v1 - tri.v0, tri.v2 - tri.v0));
+}
+
+// bounds of every triangle (in the mesh's frame)
+const AABB& MeshBVH::getBounds() const {
+    return bounds;
+}
+
+int MeshBVH::getTriangles() const {
+    return triangles.size();
+}
+
+int MeshBVH::getNodes() const {
+    return nodes.size();
+}
+
+/**
+ * Intersects a ray with a triangle from either side (Moller-Trumbore)
+ * @param t Distance along the ray of the hit
+ * @return whether or not the ray hits the triangle in front of its origin
+ */
+bool MeshBVH::rayTriangle(const vec3& ro, const vec3& rd, const vec3& v0, const vec3& v1, const vec3& v2, float& t) {
+    vec3 e1 = v1 - v0;
+    vec3 e2 = v2 - v0;
+    vec3 pv = vec3::cross(rd, e2);
+    float det = vec3::dot(e1, pv);
+    if (fabs(det) < 1e-12f) {
+        return false;
+    }
+
+    float invDet = 1.0f / det;
+    vec3 tv = ro - v0;
+    float u = vec3::dot(tv, pv) * invDet;
+    if (u < 0 || u > 1) {
+        return false;
+    }
+    vec3 qv = vec3::cross(tv, e1);
+    float v = vec3::dot(rd, qv) * invDet;
+    if (v < 0 || u + v > 1) {
+        return false;
+    }
+
+    t = vec3::dot(e2, qv) * invDet;
+    return t > 0;
+}
+
+/**
+ * Closest point on a triangle to a point, found by the Voronoi region of the triangle the point lies in
+ * (Ericson, Real-Time Collision Detection 5.1.5)
+ */
+vec3 MeshBVH::closestOnTriangle(const vec3& p, const vec3& a, const vec3& b, const vec3& c) {
+    vec3 ab = b - a;
+    vec3 ac = c - a;
+    vec3 ap = p - a;
+    float d1 = vec3::dot(ab, ap);
+    float d2 = vec3::dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) {
+        return a;
+    }
+
+    vec3 bp = p - b;
+    float d3 = vec3::dot(ab, bp);
+    float d4 = vec3::dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        return b;
+    }
+
+    float vc = d1*d4 - d3*d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+
+    vec3 cp = p - c;
+    float d5 = vec3::dot(ab, cp);
+    float d6 = vec3::dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        return c;
+    }
+
+    float vb = d5*d2 - d1*d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+
+    float va = d3*d6 - d5*d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+
+    // inside the face
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
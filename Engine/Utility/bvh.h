@@ -0,0 +1,97 @@
+// Bounding volume hierarchy over the triangles of a mesh
+#ifndef _BVH_H
+#define _BVH_H
+
+#include "../../common.h"
+
+class MeshBVH {
+    public:
+        MeshBVH();
+
+        // builds the tree with the surface area heuristic over triangles given as 9 floats each (the layout of Mesh::getTriangles)
+        void build(const vector<float>& vertices);
+        // builds the tree over indexed triangles (3 floats per vertex, 3 indices per triangle, as Mesh stores them)
+        template <typename Index>
+        void build(const ArrayView<float>& positions, const Index* indices, int count);
+
+        // writes the nodes, the triangles in tree order and where each source triangle went, as they are laid out in memory
+        void write(ostream& out) const;
+        /**
+         * Serves a tree written by write from the buffer holding it, which must outlive the tree (nothing is copied)
+         * @param data Start of the tree (4 byte aligned), moved past it
+         * @param end End of the buffer holding the tree
+         * @param count Number of triangles the tree was built over
+         * @return false if the tree does not fit the buffer or the triangles (the tree is left empty)
+         */
+        bool read(const char*& data, const char* end, int count);
+
+        /**
+         * Finds the closest triangle hit by the ray ro + t*rd for minT < t < maxT (triangles are double sided)
+         * @return whether or not a triangle was hit, setting t and the index of the triangle if so
+         */
+        bool raycast(const vec3& ro, const vec3& rd, float minT, float maxT, float& t, int& triangle) const;
+        // finds every triangle whose bounding box overlaps a box
+        void overlap(const AABB& box, vector<int>& result) const;
+        /**
+         * Finds the closest point on the mesh to p, looking no further than maxDist
+         * @return whether or not a point was found, setting it and the index of its triangle if so
+         */
+        bool closestPoint(const vec3& p, float maxDist, vec3& point, int& triangle) const;
+
+        // unit normal of a triangle (by winding order)
+        vec3 getNormal(int triangle) const;
+        const AABB& getBounds() const;
+        int getTriangles() const;
+        int getNodes() const;
+
+        static bool rayTriangle(const vec3& ro, const vec3& rd, const vec3& v0, const vec3& v1, const vec3& v2, float& t);
+        static vec3 closestOnTriangle(const vec3& p, const vec3& a, const vec3& b, const vec3& c);
+
+    private:
+        // the tree views its own buffers, so copying would leave the copy viewing the original's
+        MeshBVH(const MeshBVH&);
+        MeshBVH& operator= (const MeshBVH&);
+
+        // nodes are stored depth first, so the left child of an interior node directly follows it
+        struct Node {
+            vec3 lower;
+            // first triangle of a leaf, or the right child of an interior node
+            int offset;
+            vec3 upper;
+            // number of triangles in a leaf (0 for interior nodes)
+            int count;
+        };
+
+        struct Triangle {
+            vec3 v0;
+            vec3 v1;
+            vec3 v2;
+            // index of the triangle in the source vertices
+            int index;
+        };
+
+        // triangle bounds and centroids used while building
+        struct Reference {
+            AABB box;
+            vec3 centroid;
+            int triangle;
+        };
+
+        int buildNode(vector<Reference>& refs, int begin, int end, int depth);
+
+        // views into the buffers below once built, or into the caller's buffer once read
+        ArrayView<Node> nodes;
+        AABB bounds;
+        // triangles in tree order
+        ArrayView<Triangle> triangles;
+        // tree position of each source triangle
+        ArrayView<int> order;
+
+        vector<Node> builtNodes;
+        vector<Triangle> builtTriangles;
+        vector<int> builtOrder;
+};
+
+#include "bvh.cpp"
+
+#endif
\ No newline at end of file
@@ -17,4 +17,6 @@ Collision::Collision(const Collision& collision) {
     n = collision.n;
     pen = collision.pen;
     man = collision.man;
+    depths = collision.depths;
+    ids = collision.ids;
 }
\ No newline at end of file
@@ -11,9 +11,15 @@ class Collision {
         Collision(const Collision& collision);
         
         bool col;
+        // collision normal, pointing from the second shape towards the first (the direction the first shape must move to separate)
         vec3 n;
+        // penetration depth (positive when overlapping)
         double pen;
         vector<vec3> man;
+        // penetration depth of each manifold point (pen is used for points without one)
+        vector<double> depths;
+        // feature id of each manifold point, identifying the same contact across frames (for warm starting)
+        vector<int> ids;
 };
 
 #include "collision.cpp"
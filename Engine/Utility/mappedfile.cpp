@@ -0,0 +1,86 @@
+#include "mappedfile.h"
+
+MappedFile::MappedFile() : mapped(NULL), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER bytes;
+    if (!GetFileSizeEx(file, &bytes) || bytes.QuadPart <= 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mapping) {
+        return false;
+    }
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // the view keeps the mapping open once its handle is closed
+    CloseHandle(mapping);
+    if (!address) {
+        return false;
+    }
+
+    mapped = (const char*)address;
+    length = bytes.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* address = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid once the descriptor is closed
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    mapped = (const char*)address;
+    length = info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (mapped) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapped);
+#else
+        munmap((void*)mapped, length);
+#endif
+    }
+    mapped = NULL;
+    length = 0;
+}
+
+const char* MappedFile::data() const {
+    return mapped;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+bool MappedFile::isOpen() const {
+    return mapped != NULL;
+}
@@ -0,0 +1,34 @@
+// Read only memory mapped file
+#ifndef _MAPPEDFILE_H
+#define _MAPPEDFILE_H
+
+#include "../../common.h"
+
+class MappedFile {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        /**
+         * Maps a whole file into memory (pages are read in by the os as they are touched, nothing is parsed or copied)
+         * @return whether or not the file could be mapped
+         */
+        bool open(const string& path);
+        void close();
+
+        const char* data() const;
+        size_t size() const;
+        bool isOpen() const;
+
+    private:
+        // mappings are owned, so copying would unmap twice
+        MappedFile(const MappedFile&);
+        MappedFile& operator= (const MappedFile&);
+
+        const char* mapped;
+        size_t length;
+};
+
+#include "mappedfile.cpp"
+
+#endif
@@ -0,0 +1,329 @@
+#include "objparser.h"
+
+ObjParser::ObjParser(int threads) : threads(1), chunkSize(OBJ_CHUNK_SIZE) {
+    setThreads(threads);
+}
+
+void ObjParser::setThreads(int threads) {
+    this->threads = threads > 0 ? threads : max((int)std::thread::hardware_concurrency(), 1);
+}
+
+int ObjParser::getThreads() const {
+    return threads;
+}
+
+void ObjParser::setChunkSize(size_t bytes) {
+    chunkSize = max(bytes, (size_t)1);
+}
+
+// Makes a face index 0 based like tinyobj's fixIndex, flagging negative (relative) indices instead of resolving them
+static bool ObjParser_index(const char* token, int count, int& index, unsigned char& relative, unsigned char bit) {
+    int raw = atoi(token);
+    if (raw > 0) {
+        index = raw - 1;
+        return true;
+    }
+    if (raw == 0) {
+        return false;
+    }
+    index = count + raw;
+    relative |= bit;
+    return true;
+}
+
+/**
+ * Parses a face corner (i, i/j/k, i//k or i/j) the way tinyobj's parseTriple does
+ * @param index Vertex, normal and texcoord index of the corner (-1 if not given)
+ * @return false for an index of 0
+ */
+static bool ObjParser_corner(const char** token, int vertices, int normals, int texcoords, int* index, unsigned char& relative) {
+    index[0] = index[1] = index[2] = -1;
+    relative = 0;
+
+    if (!ObjParser_index(*token, vertices, index[0], relative, 1)) {
+        return false;
+    }
+    (*token) += strcspn(*token, "/ \t\r");
+    if ((*token)[0] != '/') {
+        return true;
+    }
+    (*token)++;
+
+    // i//k
+    if ((*token)[0] == '/') {
+        (*token)++;
+        if (!ObjParser_index(*token, normals, index[1], relative, 2)) {
+            return false;
+        }
+        (*token) += strcspn(*token, "/ \t\r");
+        return true;
+    }
+
+    // i/j/k or i/j
+    if (!ObjParser_index(*token, texcoords, index[2], relative, 4)) {
+        return false;
+    }
+    (*token) += strcspn(*token, "/ \t\r");
+    if ((*token)[0] != '/') {
+        return true;
+    }
+    (*token)++;
+    if (!ObjParser_index(*token, normals, index[1], relative, 2)) {
+        return false;
+    }
+    (*token) += strcspn(*token, "/ \t\r");
+    return true;
+}
+
+// Parses the records of one chunk, with the same line splitting and number parsing as tinyobj
+void ObjParser::parseChunk(Chunk& chunk) const {
+    chunk.valid = true;
+    chunk.cornerCount = 0;
+
+    // tinyobj's parsers stop at the end of a c string, so each line is copied out of the mapping
+    string line;
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        // lines end at \n, \r\n or a lone \r (like safeGetline)
+        const char* lineEnd = p;
+        while (lineEnd < chunk.end && *lineEnd != '\n' && *lineEnd != '\r') {
+            lineEnd++;
+        }
+        line.assign(p, lineEnd);
+        p = lineEnd;
+        if (p < chunk.end && *p == '\r') {
+            p++;
+            if (p < chunk.end && *p == '\n') {
+                p++;
+            }
+        } else if (p < chunk.end) {
+            p++;
+        }
+
+        const char* token = line.c_str();
+        token += strspn(token, " \t");
+
+        if (token[0] == 'v' && IS_SPACE(token[1])) {
+            token += 2;
+            float x, y, z, r, g, b;
+            tinyobj::parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+            chunk.vertices.push_back(x);
+            chunk.vertices.push_back(y);
+            chunk.vertices.push_back(z);
+        } else if (token[0] == 'v' && token[1] == 'n' && IS_SPACE(token[2])) {
+            token += 3;
+            float x, y, z;
+            tinyobj::parseReal3(&x, &y, &z, &token);
+            chunk.normals.push_back(x);
+            chunk.normals.push_back(y);
+            chunk.normals.push_back(z);
+        } else if (token[0] == 'v' && token[1] == 't' && IS_SPACE(token[2])) {
+            token += 3;
+            float x, y;
+            tinyobj::parseReal2(&x, &y, &token);
+            chunk.texcoords.push_back(x);
+            chunk.texcoords.push_back(y);
+        } else if (token[0] == 'f' && IS_SPACE(token[1])) {
+            token += 2;
+            token += strspn(token, " \t");
+
+            int count = 0;
+            while (!IS_NEW_LINE(token[0])) {
+                int index[3];
+                unsigned char relative;
+                // n-gons are ear clipped by tinyobj, which is left to parseSerial
+                if (count == 4 || !ObjParser_corner(&token, chunk.vertices.size() / 3, chunk.normals.size() / 3,
+                                                    chunk.texcoords.size() / 2, index, relative)) {
+                    chunk.valid = false;
+                    return;
+                }
+                chunk.corners.insert(chunk.corners.end(), index, index + 3);
+                chunk.relative.push_back(relative);
+                count++;
+                token += strspn(token, " \t\r");
+            }
+
+            chunk.faces.push_back(count);
+            chunk.defined.push_back(chunk.vertices.size() / 3);
+            // faces with fewer than 3 corners are dropped, quads are split in two
+            chunk.cornerCount += count == 3 ? 3 : count == 4 ? 6 : 0;
+        }
+    }
+}
+
+/**
+ * Resolves the corners of a chunk's faces and splits its quads along their shorter diagonal (as tinyobj does)
+ * @return false if a face uses a vertex that is not defined above it
+ */
+bool ObjParser::triangulateChunk(const Chunk& chunk, ObjData& data) const {
+    tinyobj::index_t* out = data.corners.data() + chunk.cornerBase;
+    const float* v = data.vertices.data();
+    size_t corner = 0;
+
+    for (size_t f = 0; f < chunk.faces.size(); f++) {
+        int count = chunk.faces[f];
+        tinyobj::index_t face[4];
+        for (int k = 0; k < count; k++, corner++) {
+            const int* index = &chunk.corners[3 * corner];
+            unsigned char relative = chunk.relative[corner];
+            face[k].vertex_index = index[0] + (relative & 1 ? (int)chunk.vertexBase : 0);
+            face[k].normal_index = index[1] + (relative & 2 ? (int)chunk.normalBase : 0);
+            face[k].texcoord_index = index[2] + (relative & 4 ? (int)chunk.texcoordBase : 0);
+
+            if (face[k].vertex_index < 0 || (size_t)face[k].vertex_index >= chunk.vertexBase + chunk.defined[f]) {
+                return false;
+            }
+        }
+
+        if (count == 3) {
+            out[0] = face[0];
+            out[1] = face[1];
+            out[2] = face[2];
+            out += 3;
+        } else if (count == 4) {
+            const float* v0 = v + 3 * (size_t)face[0].vertex_index;
+            const float* v1 = v + 3 * (size_t)face[1].vertex_index;
+            const float* v2 = v + 3 * (size_t)face[2].vertex_index;
+            const float* v3 = v + 3 * (size_t)face[3].vertex_index;
+            float e02x = v2[0] - v0[0];
+            float e02y = v2[1] - v0[1];
+            float e02z = v2[2] - v0[2];
+            float e13x = v3[0] - v1[0];
+            float e13y = v3[1] - v1[1];
+            float e13z = v3[2] - v1[2];
+            float sqr02 = e02x * e02x + e02y * e02y + e02z * e02z;
+            float sqr13 = e13x * e13x + e13y * e13y + e13z * e13z;
+
+            if (sqr02 < sqr13) {
+                // [0, 1, 2], [0, 2, 3]
+                out[0] = face[0];
+                out[1] = face[1];
+                out[2] = face[2];
+                out[3] = face[0];
+                out[4] = face[2];
+                out[5] = face[3];
+            } else {
+                // [0, 1, 3], [1, 2, 3]
+                out[0] = face[0];
+                out[1] = face[1];
+                out[2] = face[3];
+                out[3] = face[1];
+                out[4] = face[2];
+                out[5] = face[3];
+            }
+            out += 6;
+        }
+    }
+    return true;
+}
+
+bool ObjParser::parse(const string& path, ObjData& data) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+
+    // split the file into chunks ending just after a line break, so no line is cut in two
+    vector<Chunk> chunks;
+    const char* begin = file.data();
+    const char* fileEnd = file.data() + file.size();
+    while (begin < fileEnd) {
+        const char* end = begin + min(chunkSize, (size_t)(fileEnd - begin));
+        if (end < fileEnd) {
+            const char* newline = (const char*)memchr(end, '\n', fileEnd - end);
+            end = newline ? newline + 1 : fileEnd;
+        }
+        chunks.push_back(Chunk());
+        chunks.back().begin = begin;
+        chunks.back().end = end;
+        begin = end;
+    }
+
+    JobSystem jobs(min(threads, (int)chunks.size()));
+    jobs.parallelFor(chunks.size(), [&](int i) {
+        parseChunk(chunks[i]);
+    });
+
+    // each chunk's records and triangles follow those of the chunks before it
+    size_t vertexCount = 0;
+    size_t normalCount = 0;
+    size_t texcoordCount = 0;
+    size_t cornerCount = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        Chunk& chunk = chunks[i];
+        if (!chunk.valid) {
+            return false;
+        }
+        chunk.vertexBase = vertexCount / 3;
+        chunk.normalBase = normalCount / 3;
+        chunk.texcoordBase = texcoordCount / 2;
+        chunk.cornerBase = cornerCount;
+        vertexCount += chunk.vertices.size();
+        normalCount += chunk.normals.size();
+        texcoordCount += chunk.texcoords.size();
+        cornerCount += chunk.cornerCount;
+    }
+    // indices are ints in tinyobj
+    if (vertexCount / 3 > INT_MAX || normalCount / 3 > INT_MAX || texcoordCount / 2 > INT_MAX) {
+        return false;
+    }
+
+    data.vertices.resize(vertexCount);
+    data.normals.resize(normalCount);
+    data.texcoords.resize(texcoordCount);
+    data.corners.resize(cornerCount);
+
+    jobs.parallelFor(chunks.size(), [&](int i) {
+        Chunk& chunk = chunks[i];
+        copy(chunk.vertices.begin(), chunk.vertices.end(), data.vertices.begin() + 3 * chunk.vertexBase);
+        copy(chunk.normals.begin(), chunk.normals.end(), data.normals.begin() + 3 * chunk.normalBase);
+        copy(chunk.texcoords.begin(), chunk.texcoords.end(), data.texcoords.begin() + 2 * chunk.texcoordBase);
+        vector<float>().swap(chunk.vertices);
+        vector<float>().swap(chunk.normals);
+        vector<float>().swap(chunk.texcoords);
+    });
+
+    // quads are split using vertices from any chunk, so every record is placed before triangulating
+    vector<char> triangulated(chunks.size());
+    jobs.parallelFor(chunks.size(), [&](int i) {
+        triangulated[i] = triangulateChunk(chunks[i], data);
+    });
+    for (size_t i = 0; i < chunks.size(); i++) {
+        if (!triangulated[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ObjParser::parseSerial(const string& path, ObjData& data) {
+    // taken directly from https://github.com/tinyobjloader/tinyobjloader
+    tinyobj::ObjReaderConfig reader_config;
+    reader_config.mtl_search_path = "./"; // Path to material files
+
+    tinyobj::ObjReader reader;
+
+    if (!reader.ParseFromFile(path, reader_config)) {
+        if (!reader.Error().empty()) {
+            std::cerr << "TinyObjReader: " << reader.Error();
+        }
+        return false;
+    }
+
+    if (!reader.Warning().empty()) {
+        std::cout << "TinyObjReader: " << reader.Warning();
+    }
+
+    auto &attrib = reader.GetAttrib();
+    auto &shapes = reader.GetShapes();
+
+    data.vertices = attrib.vertices;
+    data.normals = attrib.normals;
+    data.texcoords = attrib.texcoords;
+    // faces are triangulated by the reader, so every 3 indices make a triangle
+    data.corners.clear();
+    for (size_t s = 0; s < shapes.size(); s++) {
+        data.corners.insert(data.corners.end(), shapes[s].mesh.indices.begin(), shapes[s].mesh.indices.end());
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+// Multithreaded parser for the geometry of obj files
+#ifndef _OBJPARSER_H
+#define _OBJPARSER_H
+
+#include "../../common.h"
+
+// bytes of the file parsed by one job (chunks end on line breaks, so they are slightly longer)
+#define OBJ_CHUNK_SIZE (1 << 22)
+
+// geometry of an obj file, with faces triangulated the way tinyobj triangulates them
+struct ObjData {
+    vector<float> vertices;
+    vector<float> normals;
+    vector<float> texcoords;
+    // 3 corners per triangle, in file order
+    vector<tinyobj::index_t> corners;
+};
+
+class ObjParser {
+    public:
+        // @param threads Threads to parse with (0 for every hardware thread)
+        ObjParser(int threads = 0);
+
+        /**
+         * Parses the v, vn, vt and f records of an obj file in line aligned chunks across threads,
+         * giving the same data as parseSerial (groups, materials and smoothing are ignored)
+         * @return false if the file could not be mapped or holds faces only tinyobj handles
+         *         (more than 4 corners, index 0 or vertices referenced before they are defined)
+         */
+        bool parse(const string& path, ObjData& data);
+
+        // parses the file with tinyobj on the calling thread, printing its warnings and errors
+        static bool parseSerial(const string& path, ObjData& data);
+
+        void setThreads(int threads);
+        int getThreads() const;
+        void setChunkSize(size_t bytes);
+
+    private:
+        struct Chunk {
+            const char* begin;
+            const char* end;
+
+            vector<float> vertices;
+            vector<float> normals;
+            vector<float> texcoords;
+
+            // vertex, normal and texcoord index of every face corner, made 0 based
+            // (relative indices are left relative to the chunk's first record, see relative)
+            vector<int> corners;
+            // bits 1, 2 and 4 flag the corner's vertex, normal and texcoord index as relative
+            vector<unsigned char> relative;
+            // number of corners of each face
+            vector<unsigned char> faces;
+            // vertices read in the chunk before each face (a face may only use vertices defined above it)
+            vector<int> defined;
+
+            // records and triangle corners of the chunks before this one
+            size_t vertexBase;
+            size_t normalBase;
+            size_t texcoordBase;
+            size_t cornerBase;
+            size_t cornerCount;
+
+            bool valid;
+        };
+
+        void parseChunk(Chunk& chunk) const;
+        bool triangulateChunk(const Chunk& chunk, ObjData& data) const;
+
+        int threads;
+        size_t chunkSize;
+};
+
+#include "objparser.cpp"
+
+#endif
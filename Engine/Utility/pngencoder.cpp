@@ -0,0 +1,267 @@
+#include "pngencoder.h"
+
+// Packs codes into bytes least significant bit first, as deflate reads them
+struct PngEncoder_Bits {
+    vector<uint8_t>& out;
+    uint64_t bits;
+    int count;
+
+    PngEncoder_Bits(vector<uint8_t>& out) : out(out), bits(0), count(0) {}
+
+    void put(uint32_t value, int length) {
+        bits |= (uint64_t)value << count;
+        count += length;
+        while (count >= 8) {
+            out.push_back(bits & 0xFF);
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    // Huffman codes are defined most significant bit first, so they go in reversed
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i ++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        put(reversed, length);
+    }
+
+    void flush() {
+        if (count > 0) {
+            out.push_back(bits & 0xFF);
+        }
+        bits = 0;
+        count = 0;
+    }
+};
+
+// Fixed Huffman code of a literal/length symbol
+void PngEncoder_symbol(PngEncoder_Bits& bits, int symbol) {
+    if (symbol < 144) {
+        bits.putCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        bits.putCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        bits.putCode(symbol - 256, 7);
+    } else {
+        bits.putCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+const int PngEncoder_lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const int PngEncoder_lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const int PngEncoder_distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const int PngEncoder_distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+// Codes a match as its length symbol and distance code, each followed by their extra bits
+void PngEncoder_match(PngEncoder_Bits& bits, int length, int distance) {
+    int l = 28;
+    while (PngEncoder_lengthBase[l] > length) {
+        l --;
+    }
+    PngEncoder_symbol(bits, 257 + l);
+    bits.put(length - PngEncoder_lengthBase[l], PngEncoder_lengthExtra[l]);
+
+    int d = 29;
+    while (PngEncoder_distanceBase[d] > distance) {
+        d --;
+    }
+    bits.putCode(d, 5);
+    bits.put(distance - PngEncoder_distanceBase[d], PngEncoder_distanceExtra[d]);
+}
+
+void PngEncoder::deflate(const uint8_t* data, size_t size, vector<uint8_t>& out) {
+    // zlib header: deflate with a 32k window, no preset dictionary (the check bits make it a multiple of 31)
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    PngEncoder_Bits bits = PngEncoder_Bits(out);
+    // final block, fixed codes
+    bits.put(1, 1);
+    bits.put(1, 2);
+
+    // hash chains of 3 byte sequences: the latest position with each hash, and the position before it with the same hash
+    vector<int> head(1 << PNG_HASH_BITS, -1);
+    vector<int> prev(PNG_WINDOW, -1);
+    int end = size;
+    int i = 0;
+    while (i < end) {
+        int best = 0;
+        int distance = 0;
+        if (i + 3 <= end) {
+            uint32_t hash = ((data[i] << 16 | data[i+1] << 8 | data[i+2]) * 2654435761u) >> (32 - PNG_HASH_BITS);
+            int longest = min(PNG_MAX_MATCH, end - i);
+            int candidate = head[hash];
+            for (int chain = 0; candidate >= 0 && i - candidate <= PNG_WINDOW && chain < PNG_MAX_CHAIN; chain ++) {
+                int length = 0;
+                while (length < longest && data[candidate + length] == data[i + length]) {
+                    length ++;
+                }
+                if (length > best) {
+                    best = length;
+                    distance = i - candidate;
+                    if (length == longest) {
+                        break;
+                    }
+                }
+                candidate = prev[candidate & (PNG_WINDOW - 1)];
+            }
+        }
+
+        int advance = 1;
+        if (best >= 3) {
+            PngEncoder_match(bits, best, distance);
+            advance = best;
+        } else {
+            PngEncoder_symbol(bits, data[i]);
+        }
+        // every position passed over goes into the chains, so later matches can start inside this one
+        for (int stop = i + advance; i < stop; i ++) {
+            if (i + 3 <= end) {
+                uint32_t hash = ((data[i] << 16 | data[i+1] << 8 | data[i+2]) * 2654435761u) >> (32 - PNG_HASH_BITS);
+                prev[i & (PNG_WINDOW - 1)] = head[hash];
+                head[hash] = i;
+            }
+        }
+    }
+    PngEncoder_symbol(bits, 256);
+    bits.flush();
+
+    uint32_t adler = adler32(data, size);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((adler >> shift) & 0xFF);
+    }
+}
+
+uint32_t PngEncoder::crc32(const uint8_t* data, size_t size, uint32_t crc) {
+    static uint32_t table[256];
+    static bool filled = [] {
+        for (uint32_t n = 0; n < 256; n ++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k ++) {
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        return true;
+    }();
+    (void)filled;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i ++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t PngEncoder::adler32(const uint8_t* data, size_t size) {
+    uint32_t a = 1;
+    uint32_t b = 0;
+    while (size > 0) {
+        // the largest run the sums can take before they have to be reduced
+        size_t run = min(size, (size_t)5552);
+        for (size_t i = 0; i < run; i ++) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += run;
+        size -= run;
+    }
+    return b << 16 | a;
+}
+
+// Paeth predictor: whichever of left, up and up left is closest to left + up - up left
+uint8_t PngEncoder_paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Appends a chunk with its length and checksum
+void PngEncoder_chunk(vector<uint8_t>& out, const char* type, const uint8_t* data, size_t size) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((size >> shift) & 0xFF);
+    }
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data, data + size);
+    uint32_t crc = PngEncoder::crc32(&out[start], size + 4);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        out.push_back((crc >> shift) & 0xFF);
+    }
+}
+
+void PngEncoder::encode(const uint8_t* rgba, int width, int height, bool bottomUp, vector<uint8_t>& out) {
+    size_t stride = (size_t)width * 3;
+    vector<uint8_t> raw((stride + 1) * height);
+    vector<uint8_t> row(stride);
+    vector<uint8_t> above(stride, 0);
+    vector<uint8_t> filtered[5];
+    for (int f = 0; f < 5; f ++) {
+        filtered[f].resize(stride);
+    }
+
+    for (int y = 0; y < height; y ++) {
+        const uint8_t* source = rgba + (size_t)(bottomUp ? height - 1 - y : y) * width * 4;
+        for (int x = 0; x < width; x ++) {
+            row[3*x+0] = source[4*x+0];
+            row[3*x+1] = source[4*x+1];
+            row[3*x+2] = source[4*x+2];
+        }
+
+        // each row takes whichever filter leaves the smallest sum of signed residuals (the heuristic libpng uses)
+        int chosen = 0;
+        long bestSum = -1;
+        for (int f = 0; f < 5; f ++) {
+            long sum = 0;
+            for (size_t i = 0; i < stride; i ++) {
+                int left = i >= 3 ? row[i-3] : 0;
+                int upLeft = i >= 3 ? above[i-3] : 0;
+                int predicted = 0;
+                switch (f) {
+                    case 1: predicted = left; break;
+                    case 2: predicted = above[i]; break;
+                    case 3: predicted = (left + above[i]) / 2; break;
+                    case 4: predicted = PngEncoder_paeth(left, above[i], upLeft); break;
+                }
+                uint8_t residual = row[i] - predicted;
+                filtered[f][i] = residual;
+                sum += abs((int)(int8_t)residual);
+            }
+            if (bestSum < 0 || sum < bestSum) {
+                bestSum = sum;
+                chosen = f;
+            }
+        }
+        uint8_t* line = &raw[(stride + 1) * y];
+        line[0] = chosen;
+        memcpy(line + 1, filtered[chosen].data(), stride);
+        above.swap(row);
+    }
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.assign(signature, signature + 8);
+
+    uint8_t header[13] = {0};
+    for (int shift = 24, i = 0; shift >= 0; shift -= 8, i ++) {
+        header[i] = (width >> shift) & 0xFF;
+        header[4 + i] = (height >> shift) & 0xFF;
+    }
+    // 8 bits per channel, truecolor, deflate, adaptive filtering, no interlacing
+    header[8] = 8;
+    header[9] = 2;
+    PngEncoder_chunk(out, "IHDR", header, sizeof(header));
+
+    vector<uint8_t> compressed;
+    deflate(raw.data(), raw.size(), compressed);
+    PngEncoder_chunk(out, "IDAT", compressed.data(), compressed.size());
+    PngEncoder_chunk(out, "IEND", NULL, 0);
+}
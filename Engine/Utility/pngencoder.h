@@ -0,0 +1,32 @@
+// Self contained PNG encoder (filtered rows, deflated with fixed Huffman codes)
+#ifndef _PNGENCODER_H
+#define _PNGENCODER_H
+
+#include "../../common.h"
+
+// bytes back a match can reach, and the longest match deflate can code
+#define PNG_WINDOW 32768
+#define PNG_MAX_MATCH 258
+// candidates tried per position (longer chains compress a little better and run a lot slower)
+#define PNG_MAX_CHAIN 16
+#define PNG_HASH_BITS 15
+
+class PngEncoder {
+    public:
+        /**
+         * Encodes an 8 bit RGB PNG (alpha is dropped, as gif.h drops it)
+         * @param rgba width * height RGBA pixels
+         * @param bottomUp Whether rows are stored bottom first, as glReadPixels writes them
+         * @param out Receives the file
+         */
+        static void encode(const uint8_t* rgba, int width, int height, bool bottomUp, vector<uint8_t>& out);
+
+        // zlib stream of a single deflate block coded with the fixed Huffman codes
+        static void deflate(const uint8_t* data, size_t size, vector<uint8_t>& out);
+        static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+        static uint32_t adler32(const uint8_t* data, size_t size);
+};
+
+#include "pngencoder.cpp"
+
+#endif
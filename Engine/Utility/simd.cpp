@@ -0,0 +1,25 @@
+#include "simd.h"
+
+SimdPath Simd_detectPath() {
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SIMD_SSE;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+const char* Simd_pathName(SimdPath path) {
+    switch (path) {
+        case SIMD_SSE:
+            return "SSE";
+        case SIMD_AVX2:
+            return "AVX2";
+        default:
+            return "Scalar";
+    }
+}
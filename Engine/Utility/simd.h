@@ -0,0 +1,31 @@
+// Cpu feature detection and target attributes shared by the SIMD kernels
+#ifndef _SIMD_H
+#define _SIMD_H
+
+#include "../../common.h"
+
+// SIMD kernels are only built for x86 GCC-compatible compilers, everything else uses the scalar kernels
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
+#define SIMD_X86
+#include <immintrin.h>
+// kernels are compiled for their instruction set whatever the build targets, and only called once Simd_detectPath allows
+#define SSE_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+enum SimdPath {
+    // one element at a time
+    SIMD_SCALAR,
+    // 4 lanes per instruction
+    SIMD_SSE,
+    // 8 lanes per instruction
+    SIMD_AVX2
+};
+
+// widest path supported by the running cpu
+SimdPath Simd_detectPath();
+const char* Simd_pathName(SimdPath path);
+
+#include "simd.cpp"
+
+#endif
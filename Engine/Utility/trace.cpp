@@ -0,0 +1,104 @@
+#include "trace.h"
+
+std::mutex Trace::lock;
+vector<TraceEntry> Trace::ring(1024);
+int Trace::next = 0;
+int Trace::count = 0;
+std::atomic<int> Trace::level(TRACE_LEVEL_DEBUG);
+bool Trace::console = false;
+chrono::steady_clock::time_point Trace::start = chrono::steady_clock::now();
+
+/**
+ * Records a message in the ring buffer
+ * @param level Level of the message
+ * @param file Source file the message was written from
+ * @param line Source line the message was written from
+ * @param message The message
+ */
+void Trace::write(int level, const char* file, int line, const string& message) {
+    std::chrono::duration<double> diff = chrono::steady_clock::now() - start;
+
+    std::lock_guard<std::mutex> guard(lock);
+    TraceEntry& entry = ring[next];
+    entry.level = level;
+    entry.file = file;
+    entry.line = line;
+    entry.time = diff.count();
+    entry.message = message;
+
+    next = (next + 1) % ring.size();
+    count = min(count + 1, (int)ring.size());
+
+    if (console) {
+        cerr << "[" << levelName(level) << "] " << message << "\n";
+    }
+}
+
+bool Trace::enabled(int level) {
+    return level >= Trace::level;
+}
+
+void Trace::setLevel(int level) {
+    Trace::level = level;
+}
+
+int Trace::getLevel() {
+    return level;
+}
+
+void Trace::setConsole(bool console) {
+    std::lock_guard<std::mutex> guard(lock);
+    Trace::console = console;
+}
+
+/**
+ * Resizes the ring buffer (buffered messages are discarded)
+ * @param capacity Number of messages to keep
+ */
+void Trace::setCapacity(int capacity) {
+    std::lock_guard<std::mutex> guard(lock);
+    ring.assign(max(capacity, 1), TraceEntry());
+    next = 0;
+    count = 0;
+}
+
+vector<TraceEntry> Trace::getEntries() {
+    std::lock_guard<std::mutex> guard(lock);
+    vector<TraceEntry> entries;
+    int size = ring.size();
+    for (int i = 0; i < count; i ++) {
+        entries.push_back(ring[(next - count + i + size) % size]);
+    }
+    return entries;
+}
+
+/**
+ * Writes every buffered message, oldest first
+ * @param out Stream to write to
+ */
+void Trace::dump(ostream& out) {
+    for (const TraceEntry& entry : getEntries()) {
+        out << entry.time << "\t[" << levelName(entry.level) << "] " << entry.file << ":" << entry.line << "\t" << entry.message << "\n";
+    }
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> guard(lock);
+    next = 0;
+    count = 0;
+}
+
+const char* Trace::levelName(int level) {
+    switch (level) {
+        case TRACE_LEVEL_DEBUG:
+            return "DEBUG";
+        case TRACE_LEVEL_INFO:
+            return "INFO";
+        case TRACE_LEVEL_WARN:
+            return "WARN";
+        case TRACE_LEVEL_ERROR:
+            return "ERROR";
+        default:
+            return "NONE";
+    }
+}
\ No newline at end of file
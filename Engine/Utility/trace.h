@@ -0,0 +1,97 @@
+// Compile time gated tracing, recorded into a ring buffer
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include "../../common.h"
+
+#define TRACE_LEVEL_DEBUG 0
+#define TRACE_LEVEL_INFO 1
+#define TRACE_LEVEL_WARN 2
+#define TRACE_LEVEL_ERROR 3
+#define TRACE_LEVEL_NONE 4
+
+// messages below TRACE_LEVEL are compiled out, arguments and all (release builds define NDEBUG, which strips every message)
+#ifndef TRACE_LEVEL
+#ifdef NDEBUG
+#define TRACE_LEVEL TRACE_LEVEL_NONE
+#else
+#define TRACE_LEVEL TRACE_LEVEL_INFO
+#endif
+#endif
+
+struct TraceEntry {
+    int level;
+    const char* file;
+    int line;
+    // seconds since the first message
+    double time;
+    string message;
+};
+
+class Trace {
+    public:
+        // records a message (use the TRACE_* macros rather than calling this directly)
+        static void write(int level, const char* file, int line, const string& message);
+        // whether messages of a level pass the runtime filter
+        static bool enabled(int level);
+
+        // runtime filter, on top of the compile time TRACE_LEVEL
+        static void setLevel(int level);
+        static int getLevel();
+        // also echo every message to stderr as it is written
+        static void setConsole(bool console);
+        // number of messages kept (the oldest are overwritten first)
+        static void setCapacity(int capacity);
+
+        // buffered messages, oldest first
+        static vector<TraceEntry> getEntries();
+        static void dump(ostream& out);
+        static void clear();
+
+        static const char* levelName(int level);
+
+    private:
+        static std::mutex lock;
+        static vector<TraceEntry> ring;
+        static int next;
+        static int count;
+        static std::atomic<int> level;
+        static bool console;
+        static chrono::steady_clock::time_point start;
+};
+
+#define TRACE_WRITE(level, message) do { \
+    if (Trace::enabled(level)) { \
+        ostringstream traceMessage; \
+        traceMessage << message; \
+        Trace::write(level, __FILE__, __LINE__, traceMessage.str()); \
+    } \
+} while (0)
+
+#if TRACE_LEVEL <= TRACE_LEVEL_DEBUG
+#define TRACE_DEBUG(message) TRACE_WRITE(TRACE_LEVEL_DEBUG, message)
+#else
+#define TRACE_DEBUG(message) do {} while (0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_INFO
+#define TRACE_INFO(message) TRACE_WRITE(TRACE_LEVEL_INFO, message)
+#else
+#define TRACE_INFO(message) do {} while (0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_WARN
+#define TRACE_WARN(message) TRACE_WRITE(TRACE_LEVEL_WARN, message)
+#else
+#define TRACE_WARN(message) do {} while (0)
+#endif
+
+#if TRACE_LEVEL <= TRACE_LEVEL_ERROR
+#define TRACE_ERROR(message) TRACE_WRITE(TRACE_LEVEL_ERROR, message)
+#else
+#define TRACE_ERROR(message) do {} while (0)
+#endif
+
+#include "trace.cpp"
+
+#endif
\ No newline at end of file
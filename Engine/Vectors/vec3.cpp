@@ -2,7 +2,11 @@
 
 // prints vec3's
 void vec3::printv3(const vec3& v) {
-    cout << v.X() << " " << v.Y() << " " << v.Z();
+    cout << v;
+}
+
+ostream& operator<< (ostream& out, const vec3& v) {
+    return out << v.X() << " " << v.Y() << " " << v.Z();
 }
 
 // Represents a 3 dimensional vector <x, y, z>
@@ -119,6 +123,22 @@ vec3 vec3::invert(const vec3& v) {
 vec3 vec3::abs(const vec3& v) {
     return callFunc_f1(v, std::abs);
 }
+// Component-wise minimum of two vectors
+vec3 vec3::vmin(const vec3& v1, const vec3& v2) {
+    vec3 r;
+    r.x = v1.x < v2.x ? v1.x : v2.x;
+    r.y = v1.y < v2.y ? v1.y : v2.y;
+    r.z = v1.z < v2.z ? v1.z : v2.z;
+    return r;
+}
+// Component-wise maximum of two vectors
+vec3 vec3::vmax(const vec3& v1, const vec3& v2) {
+    vec3 r;
+    r.x = v1.x > v2.x ? v1.x : v2.x;
+    r.y = v1.y > v2.y ? v1.y : v2.y;
+    r.z = v1.z > v2.z ? v1.z : v2.z;
+    return r;
+}
 // Fractional part of each component
 vec3 vec3::fract(const vec3& v) {
     vec3 r;
@@ -29,6 +29,8 @@ class vec3 {
 
         static vec3 invert(const vec3& v);
         static vec3 abs(const vec3& v);
+        static vec3 vmin(const vec3& v1, const vec3& v2);
+        static vec3 vmax(const vec3& v1, const vec3& v2);
         static vec3 fract(const vec3& v);
         static vec3 mod(const vec3& v, float f);
         static vec3 round(const vec3& v);
@@ -69,6 +71,9 @@ class vec3 {
         
 };
 
+// streams a vec3 as "x y z" (the same format as printv3)
+ostream& operator<< (ostream& out, const vec3& v);
+
 //#include "vec3.cpp"
 
 #endif
\ No newline at end of file
@@ -15,4 +15,9 @@ class Capsule;
 class BBox;
 class Mesh;
 
+class AABB;
+class RigidBodyStore;
+
+class World;
+
 #endif
\ No newline at end of file
@@ -7,10 +7,12 @@
 #define DAMPEN 0.995
 #define BAUMGARTE 0.1
 #define SLOP 0.001
+#define FRICTION 0.5
+#define RESTITUTION_THRESHOLD 1.0
 
 
 /*=======DATA CONSTANTS=======*/
-// number of shapes
+// number of shapes the scene buffer makes room for up front (it grows with the scene)
 const int DSIZE = 10;
 // width of data
 const int WIDTH = 16;
@@ -34,9 +36,29 @@ const int WIDTH = 16;
 #include <tuple>
 #include <limits>
 #include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 extern "C" {
     #include <unistd.h>
+    #include <limits.h>
+    #include <sys/stat.h>
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+#endif
 }
+// files are memory mapped through the Win32 api on Windows (see MappedFile), which must not define min and max
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 using namespace std;
 namespace patch {
@@ -52,6 +74,10 @@ template<typename Base, typename T> inline bool instanceof(const T*) {
 }
 
 
+/*=======GRAPHICS LIBRARIES=======*/
+// define HEADLESS to build the physics engine without SDL or OpenGL (see World)
+#ifndef HEADLESS
+
 /*=======GLU/GLEW=======*/
 #include <GL/glew.h>
 #include <GL/glu.h>
@@ -65,6 +91,8 @@ template<typename Base, typename T> inline bool instanceof(const T*) {
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_image.h>
 
+#endif
+
 
 /*=======EXTERNAL CLASS DEFINITIONS=======*/
 #define TINYOBJLOADER_IMPLEMENTATION
@@ -73,22 +101,58 @@ template<typename Base, typename T> inline bool instanceof(const T*) {
 
 
 /*=======CLASS DEFINITIONS=======*/
+#include "Engine/Utility/trace.h"
 #include "classes.h"
 
+#ifndef HEADLESS
 #include "Engine/Graphics/graphics.h"
+#include "Engine/Graphics/shader.h"
+#endif
 #include "Engine/Vectors/vec3.h"
 #include "Engine/Vectors/vec4.h"
 #include "Engine/Vectors/mtrx3.h"
 
 #include "Engine/Utility/collision.h"
+#include "Engine/Utility/aabb.h"
+#include "Engine/Utility/arrayview.h"
+#include "Engine/Utility/simd.h"
+
+#include "Engine/Physics/bodystore.h"
+#include "Engine/Physics/integrator.h"
+#include "Engine/Physics/jobs.h"
 
+#include "Engine/Shapes/dispatch.h"
 #include "Engine/Shapes/shapes.h"
 
 #include "Engine/Utility/SAT.h"
+#include "Engine/Utility/OBB.h"
+#include "Engine/Utility/bvh.h"
+#include "Engine/Utility/mappedfile.h"
+#include "Engine/Utility/objparser.h"
+#include "Engine/Utility/pngencoder.h"
 
 #include "Engine/Shapes/sphere.h"
 #include "Engine/Shapes/box.h"
 #include "Engine/Shapes/capsule.h"
+#include "Engine/Shapes/meshasset.h"
 #include "Engine/Shapes/mesh.h"
+#include "Engine/Shapes/dispatch.cpp"
+
+#include "Engine/Physics/aabbtree.h"
+#include "Engine/Physics/broadphase.h"
+#include "Engine/Physics/islands.h"
+#include "Engine/Physics/contacts.h"
+#include "Engine/Physics/world.h"
+
+#include "Engine/Graphics/scenebuffer.h"
+#include "Engine/Graphics/framesink.h"
+#include "Engine/Graphics/gifencoder.h"
+#include "Engine/Graphics/gifrecorder.h"
+#include "Engine/Graphics/imagesequence.h"
+#include "Engine/Graphics/y4mstream.h"
+#include "Engine/Graphics/framesink.cpp"
+#include "Engine/Graphics/framereader.h"
+#include "Engine/Graphics/packet.h"
+#include "Engine/Graphics/tracer.h"
 
 #endif
\ No newline at end of file
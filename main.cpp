@@ -1,9 +1,22 @@
+#ifdef HEADLESS
+#include "Benchmarks/benchmarks.h"
+#else
 #include "Engine/Kernel/kernel.h"
+#endif
 
 int main(int argc, char* argv[])
 {
-    Kernel* kernel;
-    kernel->start("3D Rendering", 700, 700);//argc, argv); 
+#ifdef HEADLESS
+    return runBenchmark(argc, argv);
+#else
+    // the first two arguments pick where recorded frames go (gif, png, ppm, y4m or none, then a path)
+    Kernel kernel;
+    if (argc > 2 && !kernel.setOutput(argv[1], argv[2])) {
+        cerr << "Unknown output " << argv[1] << "\n";
+        return 1;
+    }
+    kernel.start("3D Rendering", 700, 700);
     
     return 0;
-}
\ No newline at end of file
+#endif
+}